@@ -116,6 +116,7 @@ HEADERS += \
     $$PWD/backend/protection.h \
     $$PWD/backend/radio-controller.h \
     $$PWD/backend/radio-receiver.h \
+    $$PWD/backend/signal-detector.h \
     $$PWD/backend/tools.h \
     $$PWD/backend/uep-protection.h \
     $$PWD/backend/viterbi.h \\
@@ -133,6 +134,14 @@ HEADERS += \
     $$PWD/various/wavfile.h \
     $$PWD/various/Socket.h \
     $$PWD/various/MathHelper.h \
+    $$PWD/various/iq_convert.h \
+    $$PWD/various/iq_container.h \
+    $$PWD/various/resampler.h \
+    $$PWD/various/channel_impairments.h \
+    $$PWD/various/histogram_agc.h \
+    $$PWD/various/iq_corrector.h \
+    $$PWD/various/iq_multicast.h \
+    $$PWD/various/nco.h \
     $$PWD/libs/fec/char.h \
     $$PWD/libs/fec/decode_rs.h \
     $$PWD/libs/fec/encode_rs.h \
@@ -140,7 +149,12 @@ HEADERS += \
     $$PWD/libs/fec/init_rs.h \
     $$PWD/libs/fec/rs-common.h \
     $$PWD/backend/decoder_adapter.h \
+    $$PWD/input/channelizer.h \
+    $$PWD/input/dab_generator.h \
+    $$PWD/input/impaired_input.h \
     $$PWD/input/input_factory.h \
+    $$PWD/input/multicast_input.h \
+    $$PWD/input/multicast_publisher.h \
     $$PWD/input/null_device.h \
     $$PWD/input/raw_file.h \
     $$PWD/input/virtual_input.h \
@@ -166,19 +180,33 @@ SOURCES += \
     $$PWD/backend/tii-decoder.cpp \
     $$PWD/backend/protTables.cpp \
     $$PWD/backend/radio-receiver.cpp \
+    $$PWD/backend/signal-detector.cpp \
     $$PWD/backend/tools.cpp \
     $$PWD/backend/uep-protection.cpp \
     $$PWD/backend/viterbi.cpp \
     $$PWD/various/Xtan2.cpp \
     $$PWD/various/channels.cpp \
     $$PWD/various/fft.cpp \
+    $$PWD/various/iq_convert.cpp \
+    $$PWD/various/iq_container.cpp \
+    $$PWD/various/resampler.cpp \
+    $$PWD/various/channel_impairments.cpp \
+    $$PWD/various/histogram_agc.cpp \
+    $$PWD/various/iq_corrector.cpp \
+    $$PWD/various/iq_multicast.cpp \
+    $$PWD/various/nco.cpp \
     $$PWD/various/wavfile.c \
     $$PWD/various/Socket.cpp \
     $$PWD/libs/fec/encode_rs_char.c \
     $$PWD/libs/fec/decode_rs_char.c \
     $$PWD/libs/fec/init_rs_char.c \
     $$PWD/backend/decoder_adapter.cpp \
+    $$PWD/input/channelizer.cpp \
+    $$PWD/input/dab_generator.cpp \
+    $$PWD/input/impaired_input.cpp \
     $$PWD/input/input_factory.cpp \
+    $$PWD/input/multicast_input.cpp \
+    $$PWD/input/multicast_publisher.cpp \
     $$PWD/input/null_device.cpp \
     $$PWD/input/raw_file.cpp \
     $$PWD/input/rtl_tcp.cpp
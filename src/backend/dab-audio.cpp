@@ -84,10 +84,15 @@ DabAudio::DabAudio(
 
 DabAudio::~DabAudio()
 {
-    running = false;
+    {
+        std::lock_guard<std::mutex> lock(ourMutex);
+        running = false;
+    }
+
+    mscDataAvailable.notify_all();
+    mscSpaceAvailable.notify_all();
 
     if (ourThread.joinable()) {
-        mscDataAvailable.notify_all();
         ourThread.join();
     }
 }
@@ -96,52 +101,86 @@ int32_t DabAudio::process(const softbit_t *v, int16_t cnt)
 {
     int32_t fr;
 
-    if (mscBuffer.GetRingBufferWriteAvailable () < cnt)
-        fprintf (stderr, "dab-concurrent: buffer full\n");
-
+    // Block until the decoder thread has made room. Dropping soft
+    // bits here would break the time deinterleaver, so the producer
+    // has to be slowed down instead.
+    std::unique_lock<std::mutex> lock(ourMutex);
     while ((fr = mscBuffer.GetRingBufferWriteAvailable ()) <= cnt) {
         if (!running)
             return 0;
-        std::this_thread::sleep_for(std::chrono::microseconds(1));
+        mscSpaceAvailable.wait(lock);
     }
 
     mscBuffer.putDataIntoBuffer(v, cnt);
+    lock.unlock();
+
     mscDataAvailable.notify_all();
     return fr;
 }
 
+void DabAudio::drain()
+{
+    {
+        std::lock_guard<std::mutex> lock(ourMutex);
+        draining = true;
+    }
+    mscDataAvailable.notify_all();
+
+    if (ourThread.joinable()) {
+        ourThread.join();
+    }
+
+    // Nobody takes the soft bits any more
+    {
+        std::lock_guard<std::mutex> lock(ourMutex);
+        running = false;
+    }
+    mscSpaceAvailable.notify_all();
+}
+
 const int16_t interleaveMap[] = {0,8,4,12,2,10,6,14,1,9,5,13,3,11,7,15};
 
 void DabAudio::run()
 {
-    int16_t i;
     int16_t countforInterleaver = 0;
     int16_t interleaverIndex    = 0;
-    std::vector<softbit_t> data(fragmentSize);
     std::vector<softbit_t> tempX(fragmentSize);
 
     while (running) {
         std::unique_lock<std::mutex> lock(ourMutex);
-        while (running && mscBuffer.GetRingBufferReadAvailable() <= fragmentSize) {
+        while (running && !draining &&
+                mscBuffer.GetRingBufferReadAvailable() <= fragmentSize) {
             mscDataAvailable.wait(lock);
         }
         if (!running)
             break;
+        //  When draining, the last complete fragment is decoded too
+        if (mscBuffer.GetRingBufferReadAvailable() < fragmentSize)
+            break;
 
-        // mscBuffer is threadsafe to access, no need to keep the lock
         lock.unlock();
 
+        // Deinterleave straight out of the ring buffer, the soft bits
+        // stay in place until they are released.
         PROFILE(DAGetMSCData);
-        mscBuffer.getDataFromBuffer(data.data(), fragmentSize);
+        const auto regions = mscBuffer.acquireRead(fragmentSize);
 
         PROFILE(DADeinterleave);
-        for (i = 0; i < fragmentSize; i ++) {
-            tempX[i] = interleaveData[(interleaverIndex +
-                    interleaveMap[i & 017]) & 017][i];
-            interleaveData[interleaverIndex][i] = data[i];
+        int16_t i = 0;
+        for (const auto& span : {regions.first, regions.second}) {
+            for (int32_t j = 0; j < span.size; j++, i++) {
+                tempX[i] = interleaveData[(interleaverIndex +
+                        interleaveMap[i & 017]) & 017][i];
+                interleaveData[interleaverIndex][i] = span.data[j];
+            }
         }
         interleaverIndex = (interleaverIndex + 1) & 0x0F;
 
+        lock.lock();
+        mscBuffer.release(regions.size());
+        lock.unlock();
+        mscSpaceAvailable.notify_all();
+
         //  only continue when de-interleaver is filled
         if (countforInterleaver <= 15) {
             countforInterleaver ++;
@@ -54,6 +54,7 @@ class DabAudio : public DabVirtual
         DabAudio& operator=(const DabAudio&) = delete;
 
         int32_t process(const softbit_t *v, int16_t cnt);
+        void drain(void);
 
     protected:
         ProgrammeHandlerInterface& myProgrammeHandler;
@@ -61,6 +62,7 @@ class DabAudio : public DabVirtual
     private:
         void    run(void);
         std::atomic<bool> running;
+        bool draining = false;  // Guarded by ourMutex
         AudioServiceComponentType dabModus;
         int16_t fragmentSize;
         int16_t bitRate;
@@ -69,6 +71,7 @@ class DabAudio : public DabVirtual
         EnergyDispersal energyDispersal;
 
         std::condition_variable  mscDataAvailable;
+        std::condition_variable  mscSpaceAvailable;
         std::mutex               ourMutex;
         std::thread              ourThread;
 
@@ -31,6 +31,9 @@ class DabVirtual {
     public:
         virtual ~DabVirtual() {}
         virtual int32_t process(const softbit_t *v, int16_t cnt) = 0;
+
+        /* Decode everything process() was given and stop */
+        virtual void drain(void) {}
 };
 #endif
 
@@ -31,9 +31,18 @@
  */
 EEPProtection::EEPProtection(int16_t bitRate, bool profile_is_eep_a, int level) :
     Viterbi(24 * bitRate),
+    stages(schedule(bitRate, profile_is_eep_a, level)),
     outSize(24 * bitRate),
     viterbiBlock(outSize * 4 + 24)
 {
+}
+
+PuncturingSchedule EEPProtection::schedule(int16_t bitRate,
+                                           bool profile_is_eep_a, int level)
+{
+    int16_t L1, L2;
+    const int8_t *PI1, *PI2;
+
     if (profile_is_eep_a) {
         switch (level) {
             case 1:
@@ -110,6 +119,8 @@ EEPProtection::EEPProtection(int16_t bitRate, bool profile_is_eep_a, int level)
                 throw std::logic_error("Invalid EEP_A level");
         }
     }
+
+    return { {L1, PI1}, {L2, PI2} };
 }
 
 bool EEPProtection::deconvolve(const softbit_t *v, int32_t size, uint8_t *outBuffer)
@@ -124,19 +135,13 @@ bool EEPProtection::deconvolve(const softbit_t *v, int32_t size, uint8_t *outBuf
     //  with a pair of tuples
     //  (L1, PI1), (L2, PI2)
     //
-    for (i = 0; i < L1; i ++) {
-        for (j = 0; j < 128; j ++) {
-            if (PI1 [j % 32] != 0)
-                viterbiBlock[viterbiCounter] = v [inputCounter ++];
-            viterbiCounter++;
-        }
-    }
-
-    for (i = 0; i < L2; i ++) {
-        for (j = 0; j < 128; j ++) {
-            if (PI2 [j % 32] != 0)
-                viterbiBlock[viterbiCounter] = v [inputCounter ++];
-            viterbiCounter++;
+    for (const auto& stage : stages) {
+        for (i = 0; i < stage.blocks; i ++) {
+            for (j = 0; j < 128; j ++) {
+                if (stage.pi [j % 32] != 0)
+                    viterbiBlock[viterbiCounter] = v [inputCounter ++];
+                viterbiCounter++;
+            }
         }
     }
     //  we had a final block of 24 bits  with puncturing according to PI_X
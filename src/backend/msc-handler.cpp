@@ -157,6 +157,15 @@ void MscHandler::processMscBlock(const softbit_t *fbits, int16_t blkno)
     }
 }
 
+void MscHandler::drain()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    work_to_be_done = false;
+    for (auto& stream : streams) {
+        stream.dabHandler->drain();
+    }
+}
+
 void MscHandler::stopProcessing()
 {
     std::lock_guard<std::mutex> lock(mutex);
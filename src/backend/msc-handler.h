@@ -51,6 +51,9 @@ class MscHandler
         // Stop processing and remove all subchannels
         void stopProcessing(void);
 
+        // Decode everything the subchannels were given, and stop them
+        void drain(void);
+
         bool addSubchannel(
                 ProgrammeHandlerInterface& handler,
                 AudioServiceComponentType ascty,
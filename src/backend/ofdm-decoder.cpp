@@ -27,6 +27,7 @@
  *  its invocation results in 2 * Tu bits
  */
 
+#include <algorithm>
 #include <cstddef>
 #include "ofdm-decoder.h"
 #include "various/profiling.h"
@@ -43,170 +44,328 @@ OfdmDecoder::OfdmDecoder(
         const DABParams& p,
         RadioControllerInterface& mr,
         FicHandler& ficHandler,
-        MscHandler& mscHandler) :
+        MscHandler& mscHandler,
+        int numThreads) :
     params(p),
     radioInterface(mr),
     ficHandler(ficHandler),
     mscHandler(mscHandler),
-    pending_symbols(params.L),
-    phaseReference(params.T_u),
-    fft_handler(p.T_u),
+    frames(numFrameBuffers, std::vector<DSPCOMPLEX>(p.L * p.T_s)),
+    spareFrame(p.L * p.T_s),
     interleaver(p),
+    carrierBins(p.K),
+    carriers(p.L * p.K),
     ibits(2 * params.K)
 {
     T_g = params.T_s - params.T_u;
-    fft_buffer = fft_handler.getVector();
+
+    /**
+     * a little optimization: we do not interchange the
+     * positive/negative frequencies to their right positions.
+     * The de-interleaving understands this
+     */
+    for (int16_t i = 0; i < params.K; i ++) {
+        int16_t index = interleaver.mapIn(i);
+        if (index < 0)
+            index += params.T_u;
+        carrierBins[i] = index;
+    }
+
+    /**
+     * The FFTs of one frame are independent of each other, so that
+     * they can be spread over several threads. Only the differential
+     * demodulation chains the symbols.
+     */
+    numThreads = std::max(numThreads, 1);
+    for (int i = 0; i < numThreads; i++) {
+        ffts.emplace_back(new fft::Forward(params.T_u));
+    }
+    for (int i = 1; i < numThreads; i++) {
+        helpers.emplace_back(&OfdmDecoder::helperthread, this, i);
+    }
 
     /**
      * When implemented in a thread, the thread controls the
      * reading in of the data and processing the data through
      * functions for handling symbol 0, FIC symbols and MSC symbols.
      */
+    running = true;
     thread = std::thread(&OfdmDecoder::workerthread, this);
 }
 
 OfdmDecoder::~OfdmDecoder()
 {
-    running = false;
-    pending_symbols_cv.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    frame_pushed_cv.notify_all();
+    frame_decoded_cv.notify_all();
     if (thread.joinable()) {
         thread.join();
     }
+
+    {
+        std::lock_guard<std::mutex> lock(transform_mutex);
+        helpersRunning = false;
+    }
+    transform_cv.notify_all();
+    for (auto& helper : helpers) {
+        helper.join();
+    }
 }
 
 void OfdmDecoder::reset()
 {
-    running = false;
-    pending_symbols_cv.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    frame_pushed_cv.notify_all();
+    frame_decoded_cv.notify_all();
     if (thread.joinable()) {
         thread.join();
     }
 
+    running = true;
     thread = std::thread(&OfdmDecoder::workerthread, this);
 }
 
 /**
  * The code in the thread executes a simple loop,
- * waiting for the next symbols and executing the interpretation
- * operation for that symbols.
+ * waiting for the next frame and executing the interpretation
+ * operation for its symbols.
  */
 void OfdmDecoder::workerthread()
 {
-    int currentSym = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running) {
+        frame_pushed_cv.wait(lock,
+                [this]() { return framesDecoded != framesPushed or not running; });
+        if (not running)
+            break;
+
+        //  The OFDMProcessor does not touch the frame until it is
+        //  counted as decoded
+        const DSPCOMPLEX *frame = frames[framesDecoded % numFrameBuffers].data();
+        decoding = true;
+        lock.unlock();
+
+        constellationPoints.clear();
+        constellationPoints.reserve(
+                (params.L-1) * params.K / constellationDecimation);
+
+        transformSymbols(frame);
+
+        //  The symbols are handed to the FIC and MSC handlers in order
+        processPRS();
+        for (int32_t sym = 1; sym < params.L and running; sym++) {
+            decodeDataSymbol(sym);
+        }
 
-    running = true;
+        radioInterface.onConstellationPoints(std::move(constellationPoints));
 
-    while (running) {
-        std::unique_lock<std::mutex> lock(mutex);
-        pending_symbols_cv.wait_for(lock, std::chrono::milliseconds(100));
+        lock.lock();
+        framesDecoded++;
+        decoding = false;
+        frame_decoded_cv.notify_all();
+    }
 
-        if (currentSym == 0) {
-            constellationPoints.clear();
-            constellationPoints.reserve(
-                    (params.L-1) * params.K / constellationDecimation);
-        }
+    std::clog << "OFDM-decoder:" <<  "closing down now" << std::endl;
+}
 
-        while (num_pending_symbols > 0 && running) {
+DSPCOMPLEX *OfdmDecoder::getFrameBuffer()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    writingSpareFrame = framesPushed - framesDecoded >= numFrameBuffers;
+    if (writingSpareFrame)
+        return spareFrame.data();
+    return frames[framesPushed % numFrameBuffers].data();
+}
 
-            if (currentSym == 0)
-                processPRS();
-            else
-                decodeDataSymbol(currentSym);
+void OfdmDecoder::pushFrame(FrameDropPolicy policy)
+{
+    std::unique_lock<std::mutex> lock(mutex);
 
-            currentSym = (currentSym + 1) % (params.L);
-            num_pending_symbols -= 1;
+    if (writingSpareFrame) {
+        //  The decoder may have caught up in the meantime
+        if (policy == FrameDropPolicy::Wait) {
+            frame_decoded_cv.wait(lock, [this]() {
+                    return framesPushed - framesDecoded < numFrameBuffers or
+                        not running; });
+        }
 
-            if (currentSym == 0) {
-                radioInterface.onConstellationPoints(
-                        std::move(constellationPoints));
-                constellationPoints.clear();
-                constellationPoints.reserve(
-                        (params.L-1) * params.K / constellationDecimation);
+        if (framesPushed - framesDecoded >= numFrameBuffers) {
+            lock.unlock();
+            if (running) {
+                std::clog << "OFDM-decoder: decoder too slow, dropped frame " <<
+                    ++framesDropped << std::endl;
             }
+            return;
         }
+
+        std::copy(spareFrame.begin(), spareFrame.end(),
+                frames[framesPushed % numFrameBuffers].begin());
+        writingSpareFrame = false;
     }
 
-    std::clog << "OFDM-decoder:" <<  "closing down now" << std::endl;
+    framesPushed++;
+    frame_pushed_cv.notify_one();
+}
+
+void OfdmDecoder::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    //  Take the waiting frames back, the one in the decoder stays
+    framesPushed = framesDecoded + (decoding ? 1 : 0);
+    writingSpareFrame = false;
+    frame_decoded_cv.wait(lock, [this]() { return not decoding or not running; });
 }
 
-void OfdmDecoder::pushAllSymbols(std::vector<std::vector<DSPCOMPLEX> >&& syms)
+void OfdmDecoder::drain()
 {
     std::unique_lock<std::mutex> lock(mutex);
+    frame_decoded_cv.wait(lock, [this]() {
+            return framesDecoded == framesPushed or not running; });
+}
+
+uint64_t OfdmDecoder::getNumFramesDropped() const
+{
+    return framesDropped;
+}
 
-    pending_symbols = std::move(syms);
-    num_pending_symbols = pending_symbols.size();
-    pending_symbols_cv.notify_one();
+/**
+ * Helper threads wait for the frames and take part in their FFTs
+ */
+void OfdmDecoder::helperthread(size_t fftIndex)
+{
+    uint64_t lastTransform = 0;
+
+    std::unique_lock<std::mutex> lock(transform_mutex);
+    while (true) {
+        transform_cv.wait(lock, [&]() {
+                return (transformFrame and transformNumber != lastTransform) or
+                    not helpersRunning; });
+        if (not helpersRunning)
+            break;
+
+        lastTransform = transformNumber;
+        const DSPCOMPLEX *frame = transformFrame;
+        activeHelpers++;
+        lock.unlock();
+
+        const int32_t transformed = transformWork(frame, *ffts[fftIndex]);
+
+        lock.lock();
+        symbolsTransformed += transformed;
+        activeHelpers--;
+        transform_done_cv.notify_all();
+    }
 }
 
 /**
- * handle symbol 0 as collected from the buffer
+ * Computes the carriers of all symbols of the frame, together with the
+ * helper threads if there are any
+ */
+void OfdmDecoder::transformSymbols(const DSPCOMPLEX *frame)
+{
+    nextSymbol = 0;
+    if (helpers.empty()) {
+        transformWork(frame, *ffts[0]);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(transform_mutex);
+    symbolsTransformed = 0;
+    transformFrame = frame;
+    transformNumber++;
+    transform_cv.notify_all();
+    lock.unlock();
+
+    const int32_t transformed = transformWork(frame, *ffts[0]);
+
+    lock.lock();
+    symbolsTransformed += transformed;
+    transform_done_cv.wait(lock, [this]() {
+            return symbolsTransformed == params.L and activeHelpers == 0; });
+    transformFrame = nullptr;
+}
+
+/**
+ * Takes the next symbol of the frame that no other thread took, until
+ * there are none left. For the phase reference symbol, the SNR is
+ * determined as well.
+ * Returns the number of symbols transformed.
+ */
+int32_t OfdmDecoder::transformWork(const DSPCOMPLEX *frame, fft::Forward& fft)
+{
+    DSPCOMPLEX *fft_buffer = fft.getVector();
+    int32_t transformed = 0;
+
+    for (int32_t sym = nextSymbol++; sym < params.L; sym = nextSymbol++) {
+        PROFILE(ProcessSymbol);
+        //  The phase reference symbol is stored without cyclic prefix
+        const DSPCOMPLEX *symbol = sym == 0 ? frame : frame + sym * params.T_s + T_g;
+        memcpy(fft_buffer, symbol, params.T_u * sizeof(DSPCOMPLEX));
+        fft.do_FFT();
+
+        /**
+         * The SNR is determined by looking at a segment of bins
+         * within the signal region and bits outside.
+         * It is just an indication
+         */
+        if (sym == 0)
+            prsSnr = get_snr(fft_buffer, 1);
+
+        /**
+         * Note that from here on, we are only interested in the
+         * K useful carriers of the FFT output
+         */
+        DSPCOMPLEX *symbolCarriers = &carriers[sym * params.K];
+        for (int16_t i = 0; i < params.K; i ++) {
+            symbolCarriers[i] = fft_buffer[carrierBins[i]];
+        }
+        transformed++;
+    }
+
+    return transformed;
+}
+
+/**
+ * handle symbol 0, whose carriers are the phase reference of symbol 1
  */
 void OfdmDecoder::processPRS()
 {
     PROFILE(ProcessPRS);
-    memcpy (fft_buffer,
-            pending_symbols[0].data(),
-            params.T_u * sizeof(DSPCOMPLEX));
-    fft_handler.do_FFT ();
-    /**
-     * The SNR is determined by looking at a segment of bins
-     * within the signal region and bits outside.
-     * It is just an indication
-     */
-    snr = 0.7 * snr + 0.3 * get_snr(fft_buffer, 1);
+    snr = 0.7 * snr + 0.3 * prsSnr;
     if (++snrCount > 10) {
         radioInterface.onSNR(snr);
         snrCount = 0;
     }
-    /**
-     * we are now in the frequency domain, and we keep the carriers
-     * as coming from the FFT as phase reference.
-     */
-    memcpy(phaseReference.data(), fft_buffer, params.T_u * sizeof (DSPCOMPLEX));
 }
 
 /**
- * For the other symbols, the first step is to go from
- * time to frequency domain, to get the carriers.
+ * The carriers of the symbol are demodulated against those of the
+ * previous symbol.
  *
  * \brief decodeDataSymbol
- * do the transforms and hand over the result to the fichandler or mschandler
+ * hand over the result to the fichandler or mschandler
  */
 void OfdmDecoder::decodeDataSymbol(int32_t sym_ix)
 {
-    PROFILE(ProcessSymbol);
-    memcpy (fft_buffer,
-            pending_symbols[sym_ix].data() + T_g,
-            params.T_u * sizeof (DSPCOMPLEX));
-    //fftlabel:
-    /**
-     * first step: do the FFT
-     */
-    fft_handler.do_FFT();
-
-    /**
-     * a little optimization: we do not interchange the
-     * positive/negative frequencies to their right positions.
-     * The de-interleaving understands this
-     */
-
     PROFILE(Deinterleaver);
-    /**
-     * Note that from here on, we are only interested in the
-     * K useful carriers of the FFT output
-     */
+    const DSPCOMPLEX *symbolCarriers = &carriers[sym_ix * params.K];
+    const DSPCOMPLEX *phaseReference = &carriers[(sym_ix - 1) * params.K];
+
     for (int16_t i = 0; i < params.K; i ++) {
-        int16_t index = interleaver.mapIn(i);
-        if (index < 0)
-            index += params.T_u;
         /**
          * decoding is computing the phase difference between
          * carriers with the same index in subsequent symbols.
          * The carrier of a symbols is the reference for the carrier
          * on the same position in the next symbols
          */
-        const DSPCOMPLEX r1 = fft_buffer[index] * conj (phaseReference[index]);
-        phaseReference[index] = fft_buffer[index];
+        const DSPCOMPLEX r1 = symbolCarriers[i] * conj (phaseReference[i]);
         const DSPFLOAT ab1 = 127.0f / l1_norm(r1);
         /// split the real and the imaginary part and scale it
 
@@ -31,12 +31,14 @@
 #include <mutex>
 #include <atomic>
 #include <cstdint>
+#include <memory>
 #include "fft.h"
 #include "dab-constants.h"
 #include "freq-interleaver.h"
 #include "radio-controller.h"
 #include "fic-handler.h"
 #include "msc-handler.h"
+#include "radio-receiver-options.h"
 
 class OfdmDecoder
 {
@@ -45,10 +47,33 @@ class OfdmDecoder
                 const DABParams& p,
                 RadioControllerInterface& mr,
                 FicHandler& ficHandler,
-                MscHandler& mscHandler);
+                MscHandler& mscHandler,
+                int numThreads = 1);
         ~OfdmDecoder();
-        void    pushAllSymbols(std::vector<std::vector<DSPCOMPLEX> >&& sym);
+        /* Buffer for the next frame, of L * T_s samples. Symbol n starts
+         * at n * T_s, except for the phase reference symbol, which has no
+         * cyclic prefix. Never blocks: if the decoder is behind, the
+         * buffer is a spare one that pushFrame() handles per policy. */
+        DSPCOMPLEX *getFrameBuffer(void);
+
+        /* Hand the frame written into the buffer of getFrameBuffer()
+         * to the decoder */
+        void    pushFrame(FrameDropPolicy policy);
+
+        /* Number of frames pushFrame() dropped since construction */
+        uint64_t getNumFramesDropped(void) const;
+
         void    reset();
+
+        /* Discard the frames that wait for the decoder, and wait for the
+         * one being decoded. Call it while no frame is being pushed. */
+        void    flush();
+
+        /* Wait until every frame pushed so far is decoded */
+        void    drain();
+
+        // Number of frames that can wait for the decoder
+        static const size_t numFrameBuffers = 4;
     private:
         int16_t get_snr(DSPCOMPLEX *, uint8_t method);
 
@@ -58,21 +83,55 @@ class OfdmDecoder
         MscHandler& mscHandler;
         std::atomic<bool> running = ATOMIC_VAR_INIT(false);
 
-        std::condition_variable pending_symbols_cv;
+        // Frames written by the OFDMProcessor and read by the decoder
+        // thread. frames[i % numFrameBuffers] is frame i. framesPushed
+        // and framesDecoded only increase, except in flush(), and are
+        // guarded by mutex, as is decoding, set while a frame is decoded.
+        std::condition_variable frame_pushed_cv;
+        std::condition_variable frame_decoded_cv;
         std::mutex mutex;
-        int num_pending_symbols = 0;
-        std::vector<std::vector<DSPCOMPLEX> > pending_symbols;
+        std::vector<std::vector<DSPCOMPLEX> > frames;
+        uint64_t framesPushed = 0;
+        uint64_t framesDecoded = 0;
+        bool decoding = false;
+
+        // Written instead of frames if all are taken
+        std::vector<DSPCOMPLEX> spareFrame;
+        bool writingSpareFrame = false;
+        std::atomic<uint64_t> framesDropped = ATOMIC_VAR_INIT(0);
 
         std::thread thread;
         void workerthread(void);
-        void processPRS();
+
+        // The FFTs of the symbols of a frame run on the decoder thread
+        // and on the helper threads, each with an FFT of its own. A
+        // helper only takes symbols while transformFrame is set, and
+        // the frame is not done before all helpers that took part are.
+        std::vector<std::unique_ptr<fft::Forward> > ffts;
+        std::vector<std::thread> helpers;
+        std::mutex transform_mutex;
+        std::condition_variable transform_cv;
+        std::condition_variable transform_done_cv;
+        const DSPCOMPLEX *transformFrame = nullptr;
+        uint64_t transformNumber = 0;
+        int32_t symbolsTransformed = 0;
+        int activeHelpers = 0;
+        bool helpersRunning = true;
+        std::atomic<int32_t> nextSymbol = ATOMIC_VAR_INIT(0);
+        int16_t prsSnr = 0;
+
+        void helperthread(size_t fftIndex);
+        void transformSymbols(const DSPCOMPLEX *frame);
+        int32_t transformWork(const DSPCOMPLEX *frame, fft::Forward& fft);
+        void processPRS(void);
         void decodeDataSymbol(int32_t n);
 
         int32_t T_g;
-        std::vector<DSPCOMPLEX> phaseReference;
-        fft::Forward fft_handler;
-        DSPCOMPLEX   *fft_buffer;
         FrequencyInterleaver interleaver;
+        // FFT bin of every carrier, in the order of the interleaver
+        std::vector<int16_t> carrierBins;
+        // The K carriers of every symbol of the frame
+        std::vector<DSPCOMPLEX> carriers;
 
         std::vector<softbit_t> ibits;
         int16_t snrCount = 0;
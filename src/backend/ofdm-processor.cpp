@@ -30,7 +30,10 @@
  *
  */
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <numeric>
 #include "ofdm-processor.h"
 #include "various/profiling.h"
 #include <iostream>
@@ -38,6 +41,9 @@
 #define SEARCH_RANGE        (2 * 36)
 #define CORRELATION_LENGTH  24
 
+// Number of samples over which the level is averaged to find the NULL
+static const int32_t nullSearchWindow = 50;
+
 /**
   * \brief OFDMProcessor
   * The OFDMProcessor class is the driver of the processing
@@ -64,13 +70,13 @@ OFDMProcessor::OFDMProcessor(
     params(params),
     ficHandler(fic),
     tiiDecoder(params, ri),
+    signalDetector(params),
     T_null(params.T_null),
     T_u(params.T_u),
     T_s(params.T_s),
     T_F(params.T_F),
-    oscillatorTable(INPUT_RATE),
     phaseRef(params, rro.fftPlacementMethod),
-    ofdmDecoder(params, ri, fic, msc),
+    ofdmDecoder(params, ri, fic, msc, rro.decoderThreads),
     fft_handler(params.T_u),
     fft_buffer(fft_handler.getVector())
 {
@@ -89,10 +95,6 @@ OFDMProcessor::OFDMProcessor(
      * the decoded symbols
      */
 
-    for (int i = 0; i < INPUT_RATE; i ++)
-        oscillatorTable[i] = DSPCOMPLEX(cos(2.0 * M_PI * i / INPUT_RATE),
-                sin(2.0 * M_PI * i / INPUT_RATE));
-
     //  and for the correlation
     refArg.resize(CORRELATION_LENGTH);
     for (int i = 0; i < CORRELATION_LENGTH; i ++)  {
@@ -101,6 +103,12 @@ OFDMProcessor::OFDMProcessor(
     }
 
     correlationVector.resize(SEARCH_RANGE + CORRELATION_LENGTH);
+
+    //  for the search of the NULL symbol
+    searchBuffer.resize(T_u);
+    envelope.resize(nullSearchWindow + T_u);
+    prefixSum.resize(nullSearchWindow + T_u + 1);
+    strength.resize(T_u);
 }
 
 OFDMProcessor::~OFDMProcessor()
@@ -121,82 +129,68 @@ void OFDMProcessor::restart()
         threadHandle.join();
     }
 
+    //  Frames of the old signal must not reach the decoder
+    ofdmDecoder.flush();
+
     coarseCorrector    = 0;
     fineCorrector      = 0;
-    syncBufferIndex    = 0;
     sLevel             = 0;
-    localPhase         = 0;
+    pendingBegin       = 0;
+    pendingEnd         = 0;
+    nco.reset();
     input.restart();
     running            = true;
     threadHandle       = std::thread(&OFDMProcessor::run, this);
 }
 
 class InputFailure { };
+class EndOfInput { };
 class NotRunningAnymore { };
 
+// Upper bound for the time it takes to notice stop() or an input
+// failure while waiting for samples.
+static const auto sampleWaitTimeout = std::chrono::milliseconds(50);
+
+// Weight of every sample in the long term average of the signal level
+static const double levelWeight = 0.00001;
+
 /**
- * \brief getSample
- * Profiling shows that getting a sample, together
- * with the frequency shift, is a real performance killer.
- * we therefore distinguish between getting a single sample
- * and getting a vector full of samples
+ * \brief getSamples
+ * With prefixCorrelation, the correlation between the samples and the
+ * samples T_u earlier is added to it, i.e. over the cyclic prefix if v
+ * is an OFDM symbol.
  */
-
-DSPCOMPLEX OFDMProcessor::getSample(int32_t phase)
+void OFDMProcessor::getSamples(DSPCOMPLEX *v, int16_t n, int32_t phase,
+        DSPCOMPLEX *prefixCorrelation)
 {
-    DSPCOMPLEX temp;
-    if (!running)
-        throw NotRunningAnymore();
-    /// bufferContent is an indicator for the value of ...->Samples ()
-    if (bufferContent == 0) {
-        bufferContent = input.getSamplesToRead ();
-        while ((bufferContent == 0) && running) {
-            if (not input.is_ok()) {
-                throw InputFailure();
-            }
-            std::this_thread::sleep_for(std::chrono::microseconds(10));
-            bufferContent = input.getSamplesToRead ();
-        }
-    }
-
     if (!running)
         throw NotRunningAnymore();
-    //
-    //  so here, bufferContent > 0
-    input.getSamples (&temp, 1);
-    bufferContent --;
 
-    //
-    //  OK, we have a sample!!
-    //  first: adjust frequency. We need Hz accuracy
-    localPhase  -= phase;
-    localPhase  = (localPhase + INPUT_RATE) % INPUT_RATE;
-    temp        *= oscillatorTable[localPhase];
-    sLevel      = 0.00001 * l1_norm(temp) + (1 - 0.00001) * sLevel;
-#define N   5
-    sampleCnt   ++;
-    if (++ sampleCnt > INPUT_RATE / N) {
-        radioInterface.onFrequencyCorrectorChange(
-                fineCorrector, coarseCorrector);
-        sampleCnt = 0;
+    // The samples syncOnNull() read past the end of the NULL come first.
+    // They are already corrected, and the read that follows the search
+    // takes T_u samples without prefixCorrelation, i.e. all of them.
+    if (pendingBegin < pendingEnd) {
+        const int16_t pending = std::min<int32_t>(n, pendingEnd - pendingBegin);
+        std::copy(&searchBuffer[pendingBegin],
+                &searchBuffer[pendingBegin + pending], v);
+        pendingBegin += pending;
+        v += pending;
+        n -= pending;
+        if (n == 0)
+            return;
     }
-    return temp;
-}
-
-void OFDMProcessor::getSamples(DSPCOMPLEX *v, int16_t n, int32_t phase)
-{
-    int32_t     i;
 
-    if (!running)
-        throw NotRunningAnymore();
     if (n > bufferContent) {
         bufferContent = input.getSamplesToRead ();
         while ((bufferContent < n) && running) {
             if (not input.is_ok()) {
+                // Not a failure if the input has simply delivered all it had
+                if (input.endOfInput()) {
+                    throw EndOfInput();
+                }
                 throw InputFailure();
             }
-            std::this_thread::sleep_for(std::chrono::microseconds(10));
-            bufferContent = input.getSamplesToRead();
+            bufferContent = input.waitForSamples(n, sampleWaitTimeout);
         }
     }
     if (!running)
@@ -208,13 +202,9 @@ void OFDMProcessor::getSamples(DSPCOMPLEX *v, int16_t n, int32_t phase)
 
     //  OK, we have samples!!
     //  first: adjust frequency. We need Hz accuracy
-    for (i = 0; i < n; i ++) {
-        localPhase  -= phase;
-        localPhase   = (localPhase + INPUT_RATE) % INPUT_RATE;
-        v[i]    *= oscillatorTable[localPhase];
-        sLevel   = 0.00001 * l1_norm(v[i]) + (1 - 0.00001) * sLevel;
-    }
+    correctFrequency(v, n, phase, prefixCorrelation);
 
+#define N   5
     sampleCnt += n;
     if (sampleCnt > INPUT_RATE / N) {
         radioInterface.onFrequencyCorrectorChange(
@@ -223,6 +213,120 @@ void OFDMProcessor::getSamples(DSPCOMPLEX *v, int16_t n, int32_t phase)
     }
 }
 
+/**
+ * \brief correctFrequency
+ * Shifts the samples by -phase Hz, and updates sLevel with their level.
+ * sLevel is an exponential average over the samples; within a block,
+ * their mean level stands in for every one of them.
+ */
+void OFDMProcessor::correctFrequency(DSPCOMPLEX *v, int32_t n, int32_t phase,
+        DSPCOMPLEX *prefixCorrelation)
+{
+    if (n <= 0)
+        return;
+
+    nco.setFrequency(-phase);
+    const float level = prefixCorrelation ?
+        nco.process(v, n, T_u, *prefixCorrelation) :
+        nco.process(v, n);
+
+    const double decay = n == 1 ? 1 - levelWeight : std::pow(1 - levelWeight, n);
+    sLevel = decay * sLevel + (1 - decay) * level / n;
+}
+
+/**
+ * \brief syncOnNull
+ * Looks for the NULL symbol, i.e. for a dip in the level averaged over
+ * nullSearchWindow samples, and then for its end. The samples are read
+ * and searched in blocks of T_u. The samples after the end of the NULL
+ * are kept for the next getSamples().
+ * Returns false if there is no NULL within a frame, or if it does not end.
+ */
+bool OFDMProcessor::syncOnNull()
+{
+    const int32_t phase = coarseCorrector + fineCorrector;
+    const float dipLevel = 0.50 * nullSearchWindow;
+    const float endLevel = 0.75 * nullSearchWindow;
+
+    pendingBegin = 0;
+    pendingEnd = 0;
+
+    //  The first nullSearchWindow values of envelope are the last ones
+    //  of the previous block
+    getSamples(searchBuffer.data(), nullSearchWindow, phase);
+    for (int32_t i = 0; i < nullSearchWindow; i ++) {
+        envelope[i] = l1_norm(searchBuffer[i]);
+    }
+
+    radioInterface.onSyncChange(false);
+
+    bool inNull = std::accumulate(envelope.begin(),
+            envelope.begin() + nullSearchWindow, 0.0f) <= dipLevel * sLevel;
+    int32_t counter = 0;
+
+    while (true) {
+        getSamples(searchBuffer.data(), T_u, phase);
+        for (int32_t i = 0; i < T_u; i ++) {
+            envelope[nullSearchWindow + i] = l1_norm(searchBuffer[i]);
+        }
+
+        //  strength[i] is the sum over the nullSearchWindow samples
+        //  up to and including sample i of the block
+        prefixSum[0] = 0;
+        std::partial_sum(envelope.begin(), envelope.end(), prefixSum.begin() + 1);
+        for (int32_t i = 0; i < T_u; i ++) {
+            strength[i] = prefixSum[nullSearchWindow + i + 1] - prefixSum[i + 1];
+        }
+
+        auto begin = strength.begin();
+        if (not inNull) {
+            const float level = dipLevel * sLevel;
+            begin = std::find_if(begin, strength.end(),
+                    [level](float s) { return s <= level; });
+            if (begin == strength.end()) {
+                counter += T_u;
+                if (counter > T_F) { // hopeless
+                    return false;
+                }
+            }
+            else {
+                /**
+                 * It seemed we found a dip that started app 65/100 * 50
+                 * samples earlier. We now start looking for the end of
+                 * the null period.
+                 */
+                PROFILE(SyncOnEndNull);
+                inNull = true;
+                counter = 0;
+                ++begin;
+            }
+        }
+
+        if (inNull) {
+            const float level = endLevel * sLevel;
+            const auto end = std::find_if(begin, strength.end(),
+                    [level](float s) { return s >= level; });
+            if (end != strength.end()) {
+                /**
+                 * The end of the null period is identified, probably
+                 * about 40 samples earlier.
+                 */
+                pendingBegin = end - strength.begin() + 1;
+                pendingEnd = T_u;
+                return true;
+            }
+
+            counter += strength.end() - begin;
+            if (counter > T_null + nullSearchWindow) { // hopeless
+                std::clog << "ofdm-processor: " << "SyncOnEndNull failed" << std::endl;
+                return false;
+            }
+        }
+
+        std::copy(envelope.end() - nullSearchWindow, envelope.end(),
+                envelope.begin());
+    }
+}
 
 /***
  *    \brief run
@@ -236,22 +340,39 @@ void OFDMProcessor::run()
 {
     int32_t startIndex;
     int32_t i;
-    int32_t counter;
-    float currentStrength;
-    constexpr int32_t syncBufferSize  = 32768;
-    constexpr int32_t syncBufferMask  = syncBufferSize - 1;
-    float envBuffer[syncBufferSize];
-
-    std::vector<DSPCOMPLEX> ofdmBuffer(params.L * params.T_s);
-    std::vector<std::vector<DSPCOMPLEX> > allSymbols;
+    std::vector<DSPCOMPLEX> ofdmBuffer(T_u);
+    std::vector<complexf> prs;
 
     try {
 
         //Initing:
         /// first, we need samples to get a reasonable sLevel
         sLevel   = 0;
-        for (i = 0; i < T_F / 2; i ++) {
-            l1_norm(getSample (0));
+        if (scanMode) {
+            /// When scanning, the samples first tell if there is a signal
+            /// at all, which is much faster than failing to sync on it
+            float falseAlarmRate;
+            {
+                std::lock_guard<std::mutex> lock(receiver_options_mutex);
+                falseAlarmRate = receiver_options.scanFalseAlarmRate;
+            }
+
+            std::vector<DSPCOMPLEX> detectorBuffer(signalDetector.getNumSamples());
+            const int32_t size = detectorBuffer.size();
+            for (i = 0; i < size; i += T_u) {
+                getSamples(&detectorBuffer[i], std::min(T_u, size - i), 0);
+            }
+
+            if (not signalDetector.detect(detectorBuffer.data(), falseAlarmRate)) {
+                radioInterface.onSignalPresence(false);
+                scanMode  = false;
+                attempts  = 0;
+            }
+        }
+        else {
+            for (i = 0; i < T_F / 2; i += T_u) {
+                getSamples(searchBuffer.data(), std::min(T_u, T_F / 2 - i), 0);
+            }
         }
 notSynced:
         PROFILE(NotSynced);
@@ -260,67 +381,14 @@ notSynced:
             scanMode  = false;
             attempts  = 0;
         }
-        syncBufferIndex  = 0;
-        currentStrength  = 0;
-
-        //  read in T_s samples for a next attempt;
-        syncBufferIndex = 0;
-        currentStrength  = 0;
-        for (i = 0; i < 50; i ++) {
-            DSPCOMPLEX sample         = getSample (0);
-            envBuffer [syncBufferIndex]   = l1_norm(sample);
-            currentStrength           += envBuffer [syncBufferIndex];
-            syncBufferIndex ++;
-        }
-        /**
-         * We now have initial values for currentStrength (i.e. the sum
-         * over the last 50 samples) and sLevel, the long term average.
-         */
+
         //SyncOnNull:
         /**
          * here we start looking for the null level, i.e. a dip
          */
-        counter  = 0;
-        radioInterface.onSyncChange(false);
-        while (currentStrength / 50  > 0.50 * sLevel) {
-            DSPCOMPLEX sample =
-                getSample (coarseCorrector + fineCorrector);
-            envBuffer [syncBufferIndex] = l1_norm(sample);
-            //  update the levels
-            currentStrength += envBuffer [syncBufferIndex] -
-                envBuffer [(syncBufferIndex - 50) & syncBufferMask];
-            syncBufferIndex = (syncBufferIndex + 1) & syncBufferMask;
-            counter ++;
-            if (counter > T_F) { // hopeless
-                //           fprintf (stderr, "%f %f\n", currentStrength / 50, sLevel);
-                goto notSynced;
-            }
-        }
-        /**
-         * It seemed we found a dip that started app 65/100 * 50 samples earlier.
-         * We now start looking for the end of the null period.
-         */
-        counter  = 0;
-        //SyncOnEndNull:
-        PROFILE(SyncOnEndNull);
-        while (currentStrength / 50 < 0.75 * sLevel) {
-            DSPCOMPLEX sample = getSample (coarseCorrector + fineCorrector);
-            envBuffer [syncBufferIndex] = l1_norm(sample);
-            //  update the levels
-            currentStrength += envBuffer [syncBufferIndex] -
-                envBuffer [(syncBufferIndex - 50) & syncBufferMask];
-            syncBufferIndex = (syncBufferIndex + 1) & syncBufferMask;
-            counter   ++;
-            //
-            if (counter > T_null + 50) { // hopeless
-                std::clog << "ofdm-processor: " << "SyncOnEndNull failed" << std::endl;
-                goto notSynced;
-            }
+        if (not syncOnNull()) {
+            goto notSynced;
         }
-        /**
-         * The end of the null period is identified, probably about 40
-         * samples earlier.
-         */
 SyncOnPhase:
         PROFILE(SyncOnPhase);
         /**
@@ -356,9 +424,10 @@ SyncOnPhase:
 
         /**
          * Once here, we are synchronized, we need to copy the data we
-         * used for synchronization for the PRS */
-        memmove(ofdmBuffer.data(), &ofdmBuffer[startIndex],
-                (params.T_u - startIndex) * sizeof (DSPCOMPLEX));
+         * used for synchronization for the PRS into the buffer the
+         * decoder gets the frame in */
+        DSPCOMPLEX *frame = ofdmDecoder.getFrameBuffer();
+        std::copy(ofdmBuffer.begin() + startIndex, ofdmBuffer.end(), frame);
         ofdmBufferIndex  = params.T_u - startIndex;
 
         //Symbol 0: Phase reference symbol symbol
@@ -369,7 +438,7 @@ SyncOnPhase:
          * We read the missing samples in the ofdm buffer
          */
         radioInterface.onSyncChange(true);
-        getSamples(&ofdmBuffer[ofdmBufferIndex],
+        getSamples(&frame[ofdmBufferIndex],
                 T_u - ofdmBufferIndex,
                 coarseCorrector + fineCorrector);
 
@@ -379,10 +448,8 @@ SyncOnPhase:
             rro = receiver_options;
         }
 
-        std::vector<complexf> prs;
         if (rro.decodeTII) {
-            prs.resize(T_u);
-            std::copy(ofdmBuffer.begin(), ofdmBuffer.begin() + T_u, prs.begin());
+            prs.assign(frame, frame + T_u);
         }
 
         //  Here we look only at the PRS when we need a coarse
@@ -400,7 +467,7 @@ SyncOnPhase:
             }
 
             coarseSyncCounter++;
-            int correction = processPRS(ofdmBuffer.data(), rro.freqsyncMethod);
+            int correction = processPRS(frame, rro.freqsyncMethod);
             if (correction != 100) {
                 coarseCorrector += correction * params.carrierDiff;
                 if (abs (coarseCorrector) > kHz(35))
@@ -417,10 +484,6 @@ SyncOnPhase:
             lastValidCoarseCorrector = coarseCorrector;
         }
 
-        allSymbols.resize(params.L);
-        allSymbols[0] = move(ofdmBuffer);
-        ofdmBuffer.resize(params.L * params.T_s);
-
         /**
          * after symbol 0, we will just read in the other (params.L - 1) symbols
          */
@@ -434,15 +497,11 @@ SyncOnPhase:
          */
         DSPCOMPLEX FreqCorr = DSPCOMPLEX(0, 0);
         for (int sym = 1; sym < params.L; sym ++) {
-            auto& buf = allSymbols[sym];
-            buf.resize(T_s);
-            getSamples(buf.data(), T_s, coarseCorrector + fineCorrector);
-            for (int i = T_u; i < T_s; i ++)
-                FreqCorr += buf[i] * conj(buf[i - T_u]);
+            getSamples(&frame[sym * T_s], T_s, coarseCorrector + fineCorrector, &FreqCorr);
         }
 
         PROFILE(PushAllSymbols);
-        ofdmDecoder.pushAllSymbols(move(allSymbols));
+        ofdmDecoder.pushFrame(rro.frameDropPolicy);
 
         //NewOffset:
         /// we integrate the newly found frequency error with the
@@ -454,9 +513,6 @@ SyncOnPhase:
          * OK,  here we are at the end of the frame
          * Assume everything went well and skip T_null samples
          */
-        syncBufferIndex  = 0;
-        currentStrength  = 0;
-
         PROFILE(DecodeTII);
         // The NULL is interesting to save because it carries the TII.
         std::vector<DSPCOMPLEX> nullSymbol(T_null);
@@ -473,8 +529,6 @@ SyncOnPhase:
          * samples ahead
          * Here we just check the fineCorrector
          */
-        counter  = 0;
-
         if (fineCorrector > params.carrierDiff / 2) {
             coarseCorrector += params.carrierDiff;
             fineCorrector -= params.carrierDiff;
@@ -486,12 +540,17 @@ SyncOnPhase:
             }
         //ReadyForNewFrame:
         /// and off we go, up to the next frame
+        numFramesProcessed++;
         PROFILE_FRAME_DECODED();
         goto SyncOnPhase;
     }
     catch (const NotRunningAnymore&) {
         std::clog << "OFDM-processor: closing down" << std::endl;
     }
+    catch (const EndOfInput&) {
+        std::clog << "OFDM-processor: end of input, closing down" << std::endl;
+        ofdmDecoder.drain();
+    }
     catch (const InputFailure&) {
         std::clog << "OFDM-processor: input not ok, closing down" << std::endl;
         running = false; //Needed before onInputFailure, because subsequent calls will call OFDMProcessor::stop()
@@ -500,6 +559,16 @@ SyncOnPhase:
     running = false;
 }
 
+uint64_t OFDMProcessor::getNumFramesDropped() const
+{
+    return ofdmDecoder.getNumFramesDropped();
+}
+
+uint64_t OFDMProcessor::getNumFramesProcessed() const
+{
+    return numFramesProcessed;
+}
+
 void OFDMProcessor::stop()
 {
     if (running) {
@@ -510,6 +579,13 @@ void OFDMProcessor::stop()
     }
 }
 
+void OFDMProcessor::waitForEnd()
+{
+    if (threadHandle.joinable()) {
+        threadHandle.join();
+    }
+}
+
 void OFDMProcessor::resetCoarseCorrector()
 {
     coarseCorrector = 0;
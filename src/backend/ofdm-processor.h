@@ -41,8 +41,10 @@
 #include "phasereference.h"
 #include "ofdm-decoder.h"
 #include "tii-decoder.h"
+#include "signal-detector.h"
 #include "virtual_input.h"
 #include "fft.h"
+#include "nco.h"
 #include "radio-controller.h"
 #include "radio-receiver-options.h"
 #include "fic-handler.h"
@@ -64,24 +66,39 @@ class OFDMProcessor
         void restart();
 
         void stop();
+
+        /* Wait until the thread has ended on its own, at the end of the
+         * input or on an input failure. The frames handed to the
+         * decoder before the end of the input are decoded by then. */
+        void waitForEnd();
+
         void resetCoarseCorrector();
         void setReceiverOptions(const RadioReceiverOptions rro);
         void set_scanMode(bool);
 
+        /* Number of complete transmission frames handed to the decoder
+         * since construction. */
+        uint64_t getNumFramesProcessed(void) const;
+
+        /* Number of those the decoder was too slow for, see
+         * FrameDropPolicy */
+        uint64_t getNumFramesDropped(void) const;
+
     private:
         std::mutex receiver_options_mutex;
         RadioReceiverOptions receiver_options;
 
         std::thread threadHandle;
-        int32_t syncBufferIndex = 0;
         RadioControllerInterface& radioInterface;
         InputInterface& input;
         const DABParams& params;
         FicHandler& ficHandler;
         std::vector<float> impulseResponseBuffer;
         TIIDecoder tiiDecoder;
+        SignalDetector signalDetector;
 
         std::atomic<bool> running = ATOMIC_VAR_INIT(false);
+        std::atomic<uint64_t> numFramesProcessed = ATOMIC_VAR_INIT(0);
 
         int32_t T_null;
         int32_t T_u;
@@ -89,9 +106,8 @@ class OFDMProcessor
         int32_t T_F;
         int32_t coarseSyncCounter = 0;
 
-        std::vector<DSPCOMPLEX> oscillatorTable;
-
-        int32_t localPhase = 0;
+        // Frequency correction
+        NCO nco;
 
         float sLevel = 0;
         int32_t sampleCnt = 0;
@@ -112,11 +128,23 @@ class OFDMProcessor
 
         int32_t bufferContent = 0;
 
+        // Search for the NULL symbol, see syncOnNull()
+        std::vector<DSPCOMPLEX> searchBuffer;
+        std::vector<float> envelope;
+        std::vector<float> prefixSum;
+        std::vector<float> strength;
+        // Samples of searchBuffer not handed out yet
+        int32_t pendingBegin = 0;
+        int32_t pendingEnd = 0;
+
         fft::Forward fft_handler;
         DSPCOMPLEX *fft_buffer; // of size T_u
 
-        DSPCOMPLEX getSample(int32_t);
-        void getSamples(DSPCOMPLEX *, int16_t, int32_t);
+        void getSamples(DSPCOMPLEX *, int16_t, int32_t,
+                DSPCOMPLEX *prefixCorrelation = nullptr);
+        void correctFrequency(DSPCOMPLEX *v, int32_t n, int32_t phase,
+                DSPCOMPLEX *prefixCorrelation);
+        bool syncOnNull(void);
         void run(void);
         int16_t processPRS(DSPCOMPLEX *v, const FreqsyncMethod& freqsyncMethod);
         int16_t getMiddle(DSPCOMPLEX *);
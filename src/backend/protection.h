@@ -25,10 +25,20 @@
 #define __PROTECTION
 
 #include <cstdint>
+#include <vector>
 #include "dab-constants.h"
 
 extern uint8_t PI_X[];
 
+//  blocks times 128 bits of the mother code that are punctured
+//  with the same vector. The 24 tail bits always use PI_X.
+struct PuncturingStage {
+    int16_t blocks;
+    const int8_t *pi;
+};
+
+using PuncturingSchedule = std::vector<PuncturingStage>;
+
 class Protection
 {
     public:
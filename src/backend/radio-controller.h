@@ -33,6 +33,7 @@
 #ifndef RADIOCONTROLLER_H
 #define RADIOCONTROLLER_H
 
+#include <chrono>
 #include <cstddef>
 #include <vector>
 #include <string>
@@ -182,6 +183,35 @@ enum class DeviceParam {
     SoapySDRAntenna,
     SoapySDRDriverArgs,
     SoapySDRClockSource,
+    // Deliver this many samples per second instead of INPUT_RATE, for
+    // inputs that feed a channelizer
+    SampleRate,
+    // Remove the DC offset and the IQ imbalance of the tuner, 0 or 1
+    IQCorrection,
+};
+
+/* A gap in the samples an input delivers, because its sample buffer
+ * was full. Consecutive blocks that could not be stored make up one
+ * event. */
+struct InputDropEvent {
+    uint64_t sampleIndex = 0;   // Samples delivered before the gap
+    uint64_t count = 0;         // Samples lost
+};
+
+struct InputStats {
+    uint64_t samples = 0;       // Delivered by the device, including dropped ones
+    uint64_t dropped = 0;
+    uint64_t dropEvents = 0;
+    std::vector<InputDropEvent> recentDrops;    // Oldest first
+};
+
+/* The DC offset and IQ imbalance the input currently corrects. */
+struct IQCorrectionStats {
+    bool enabled = false;
+    float dcOffsetI = 0;        // Relative to full scale
+    float dcOffsetQ = 0;
+    float gainImbalance = 0;    // Amplitude of I over Q in dB
+    float phaseImbalance = 0;   // Error of the Q phase in degrees
 };
 
 /* Definition of the interface all input devices must implement */
@@ -197,12 +227,30 @@ public:
     virtual int32_t getSamples(DSPCOMPLEX* buffer, int32_t size) = 0;
     virtual std::vector<DSPCOMPLEX> getSpectrumSamples(int size) = 0;
     virtual int32_t getSamplesToRead(void) = 0;
+    /* Block until at least n samples can be read or the timeout expires.
+     * Returns the number of samples that can be read. */
+    virtual int32_t waitForSamples(int32_t n, std::chrono::milliseconds timeout) = 0;
+    /* True once no more samples will arrive than those that can be
+     * read already, e.g. at the end of a file that is not rewound.
+     * Tells the end of the input from a failure when is_ok() is false. */
+    virtual bool endOfInput(void) { return false; }
     virtual float setGain(int gain) = 0;
     virtual float getGain(void) const = 0;
     virtual int getGainCount(void) = 0;
     virtual void setAgc(bool agc) = 0;
     virtual std::string getDescription(void) = 0;
 
+    /* Counters of the samples the input delivered and dropped since it
+     * was created. */
+    virtual InputStats getInputStats(void) {
+        return InputStats();
+    }
+
+    /* Only inputs that support DeviceParam::IQCorrection estimate one. */
+    virtual IQCorrectionStats getIQCorrection(void) {
+        return IQCorrectionStats();
+    }
+
     virtual bool setDeviceParam(DeviceParam param, int value) {
         (void)param; (void)value;
         return false;
@@ -62,6 +62,21 @@ enum class FFTPlacementMethod {
 // Default uses the old algorithm until the issues of the new one are solved.
 constexpr auto DEFAULT_FFT_PLACEMENT = FFTPlacementMethod::ThresholdBeforePeak;
 
+// What the OFDMProcessor does with a demodulated frame when all frame
+// buffers of the OfdmDecoder are still waiting to be decoded.
+enum class FrameDropPolicy {
+    /* Wait until the decoder has taken a frame. No frame is lost, which
+     * is what decoding a file as fast as possible needs. With a live input,
+     * the input drops samples instead if the decoder does not catch up.
+     */
+    Wait,
+
+    /* Drop the frame and count it. The demodulator keeps its sync, and
+     * the decoder gets the next frame that fits.
+     */
+    DropNewest,
+};
+
 // Configuration for the backend
 struct RadioReceiverOptions {
     // Select the algorithm used in the OFDMProcessor PRS sync logic
@@ -81,5 +96,17 @@ struct RadioReceiverOptions {
     // Which method to use for the freqsyncmethod used in the coarse corrector.
     // Has no effect when coarse corrector is disabled.
     FreqsyncMethod freqsyncMethod = FreqsyncMethod::PatternOfZeros;
+
+    // Probability that a channel scan takes a channel without signal for
+    // one with a DAB signal, see SignalDetector. The lower it is, the
+    // stronger the signal has to be.
+    float scanFalseAlarmRate = 1e-3;
+
+    // See FrameDropPolicy. Live receivers should drop frames.
+    FrameDropPolicy frameDropPolicy = FrameDropPolicy::Wait;
+
+    // Number of threads that compute the FFTs of the OFDM symbols of a
+    // frame, see OfdmDecoder. Only taken when the receiver is created.
+    int decoderThreads = 1;
 };
 
@@ -93,6 +93,12 @@ void RadioReceiver::restart_decoder()
     ficHandler.clearEnsemble();
 }
 
+void RadioReceiver::waitForEndOfInput()
+{
+    ofdmProcessor.waitForEnd();
+    mscHandler.drain();
+}
+
 void RadioReceiver::stop()
 {
     ofdmProcessor.stop();
@@ -226,5 +232,7 @@ RadioReceiverStats RadioReceiver::getReceiverStats() const
 {
     RadioReceiverStats s;
     s.timeLastFCT0Frame = ficHandler.fibProcessor.getTimeLastFCT0Frame();
+    s.numFramesProcessed = ofdmProcessor.getNumFramesProcessed();
+    s.numFramesDropped = ofdmProcessor.getNumFramesDropped();
     return s;
 }
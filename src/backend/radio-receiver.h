@@ -47,6 +47,8 @@ const char* freqSyncMethodToString(FreqsyncMethod method);
 
 struct RadioReceiverStats {
     std::chrono::system_clock::time_point timeLastFCT0Frame;
+    uint64_t numFramesProcessed = 0;
+    uint64_t numFramesDropped = 0;
 };
 
 class RadioReceiver {
@@ -67,6 +69,12 @@ class RadioReceiver {
 
         void stop();
 
+        /* Block until the input has ended, see InputInterface::endOfInput(),
+         * and all it delivered has gone through the decoders. Also returns
+         * on an input failure. The receiver has to be restarted to be
+         * used again. */
+        void waitForEndOfInput();
+
         /* Update the currently running receiver with new configuration */
         void setReceiverOptions(const RadioReceiverOptions rro);
 
@@ -0,0 +1,149 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include "signal-detector.h"
+
+// The power of this many frames is folded
+static const int32_t numFrames = 2;
+
+SignalDetector::SignalDetector(const DABParams& params) :
+    T_null(params.T_null),
+    T_u(params.T_u),
+    T_s(params.T_s),
+    T_F(params.T_F),
+    T_g(params.guardLength),
+    L(params.L),
+    foldedPower(params.T_F)
+{
+}
+
+size_t SignalDetector::getNumSamples() const
+{
+    // The prefix of the last symbol can start at the end of a frame
+    return numFrames * T_F + T_s;
+}
+
+// The sum over a window that slides over white noise, in units of its
+// standard deviation, goes below -x within numWindows window lengths
+// with about the probability numWindows * x * phi(x), phi being the
+// normal density. Returns x for the given probability.
+static double slidingWindowQuantile(double numWindows, double probability)
+{
+    double low = 1;
+    double high = 40;
+    for (int i = 0; i < 60; i++) {
+        const double x = (low + high) / 2;
+        const double phi = std::exp(-x * x / 2) / std::sqrt(2 * M_PI);
+        if (numWindows * x * phi > probability)
+            low = x;
+        else
+            high = x;
+    }
+    return high;
+}
+
+bool SignalDetector::detect(const DSPCOMPLEX *samples, float falseAlarmRate)
+{
+    falseAlarmRate = std::min(std::max(falseAlarmRate, 1e-12f), 0.5f);
+
+    std::fill(foldedPower.begin(), foldedPower.end(), 0.0f);
+    for (int32_t frame = 0; frame < numFrames; frame++) {
+        const DSPCOMPLEX *s = samples + frame * T_F;
+        for (int32_t i = 0; i < T_F; i++) {
+            foldedPower[i] += std::norm(s[i]);
+        }
+    }
+
+    double total = 0;
+    for (const float p : foldedPower) {
+        total += p;
+    }
+    if (total <= 0)
+        return false;
+
+    //  The NULL is where the power over T_null samples is lowest. The
+    //  frames are periodic, so the window wraps around.
+    double window = 0;
+    for (int32_t i = 0; i < T_null; i++) {
+        window += foldedPower[i];
+    }
+    double minWindow = window;
+    int32_t nullStart = 0;
+    for (int32_t i = 1; i < T_F; i++) {
+        int32_t last = i + T_null - 1;
+        if (last >= T_F)
+            last -= T_F;
+        window += foldedPower[last] - foldedPower[i - 1];
+        if (window < minWindow) {
+            minWindow = window;
+            nullStart = i;
+        }
+    }
+    const double nullRatio = minWindow / (total * T_null / T_F);
+
+    //  Correlate every prefix after the NULL with the end of its symbol
+    DSPCOMPLEX correlation = 0;
+    double prefixEnergy = 0;
+    double endEnergy = 0;
+    const int32_t frameStart = (nullStart + T_null) % T_F;
+    for (int32_t frame = 0; frame < numFrames; frame++) {
+        for (int32_t symbol = 0; symbol < L; symbol++) {
+            const DSPCOMPLEX *prefix = samples + frame * T_F +
+                (frameStart + symbol * T_s) % T_F;
+            const DSPCOMPLEX *end = prefix + T_u;
+            for (int32_t i = 0; i < T_g; i++) {
+                correlation += prefix[i] * std::conj(end[i]);
+                prefixEnergy += std::norm(prefix[i]);
+                endEnergy += std::norm(end[i]);
+            }
+        }
+    }
+    const double prefixRatio = std::abs(correlation) /
+        std::sqrt(prefixEnergy * endEnergy + 1e-30);
+
+    //  Thresholds for noise. The power in a window of noise is about
+    //  normal, with the standard deviation 1 / sqrt(numFrames * T_null)
+    //  of the mean. The squared correlation of N samples of noise is
+    //  exponential with the mean 1 / N.
+    const double nullThreshold = 1 - slidingWindowQuantile(
+            (double)T_F / T_null, falseAlarmRate) /
+        std::sqrt((double)numFrames * T_null);
+    const double prefixThreshold = std::sqrt(
+            -std::log((double)falseAlarmRate) / (numFrames * L * T_g));
+
+    const bool signal = nullRatio < nullThreshold and
+        prefixRatio > prefixThreshold;
+
+    std::clog << "SignalDetector: NULL at " << nullRatio <<
+        " of the mean power (threshold " << nullThreshold <<
+        "), prefix correlation " << prefixRatio <<
+        " (threshold " << prefixThreshold << "): " <<
+        (signal ? "signal" : "no signal") << std::endl;
+
+    return signal;
+}
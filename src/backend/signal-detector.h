@@ -0,0 +1,70 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef SIGNAL_DETECTOR_H
+#define SIGNAL_DETECTOR_H
+
+// Decides quickly whether there is a DAB signal on a channel, so that a
+// channel scan can skip the empty ones without trying to synchronise.
+//
+// It looks at two transmission frames, about 200 ms in mode I, and
+// needs no time or frequency synchronisation:
+//  - The power of the two frames is added sample by sample, i.e. folded
+//    with the period T_F. The NULL symbol of both frames falls on the
+//    same place, where the folded power dips.
+//  - After the NULL, the cyclic prefix of every symbol is correlated
+//    with the samples T_u later, of which it is a copy. A frequency
+//    offset turns the correlation by the same phase for every sample,
+//    so the correlation over all prefixes adds up coherently.
+// Both tests must pass, and each takes noise for a signal with at most
+// the given false alarm rate. A constant tone or a DC offset passes the
+// correlation but has no NULL, a pulsed interferer the other way round.
+
+#include <vector>
+#include "dab-constants.h"
+
+class SignalDetector {
+public:
+    explicit SignalDetector(const DABParams& params);
+
+    // Number of samples detect() looks at
+    size_t getNumSamples(void) const;
+
+    // Returns true if there is a DAB signal in the getNumSamples() samples
+    bool detect(const DSPCOMPLEX *samples, float falseAlarmRate);
+
+private:
+    int32_t T_null;
+    int32_t T_u;
+    int32_t T_s;
+    int32_t T_F;
+    int32_t T_g;
+    int32_t L;
+
+    // Power of the frames, added sample by sample
+    std::vector<float> foldedPower;
+};
+
+#endif // SIGNAL_DETECTOR_H
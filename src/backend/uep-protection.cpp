@@ -144,26 +144,30 @@ UEPProtection::UEPProtection(
         int16_t bitRate,
         int16_t protLevel) :
     Viterbi(24 * bitRate),
+    stages(schedule(bitRate, protLevel)),
     outSize(24 * bitRate),
     viterbiBlock(outSize * 4 + 24)
+{
+}
+
+PuncturingSchedule UEPProtection::schedule(int16_t bitRate, int16_t protLevel)
 {
     int16_t index = findIndex (bitRate, protLevel);
     if (index == -1) {
         fprintf(stderr, "UEP: %d (%d) has a problem\n", bitRate, protLevel);
         index = 1;
     }
-    L1  = profileTable[index].L1;
-    L2  = profileTable[index].L2;
-    L3  = profileTable[index].L3;
-    L4  = profileTable[index].L4;
-
-    PI1 = getPCodes(profileTable[index].PI1 -1);
-    PI2 = getPCodes(profileTable[index].PI2 -1);
-    PI3 = getPCodes(profileTable[index].PI3 -1);
-    if ((profileTable[index].PI4 - 1) != -1)
-        PI4 = getPCodes(profileTable[index].PI4 -1);
-    else
-        PI4 = nullptr;
+
+    const auto& profile = profileTable[index];
+    PuncturingSchedule stages = {
+        {profile.L1, getPCodes(profile.PI1 - 1)},
+        {profile.L2, getPCodes(profile.PI2 - 1)},
+        {profile.L3, getPCodes(profile.PI3 - 1)},
+    };
+    if ((profile.PI4 - 1) != -1)
+        stages.push_back({profile.L4, getPCodes(profile.PI4 - 1)});
+
+    return stages;
 }
 
 bool UEPProtection::deconvolve(const softbit_t *v, int32_t size, uint8_t *outBuffer)
@@ -181,43 +185,14 @@ bool UEPProtection::deconvolve(const softbit_t *v, int32_t size, uint8_t *outBuf
     /// only the non-punctured ones are set
     memset(viterbiBlock.data(), 0, (outSize * 4 + 24) * sizeof(softbit_t));
 
-    for (i = 0; i < L1; i ++) {
-        for (j = 0; j < 128; j ++) {
-            if (PI1[j % 32] != 0) {
-                viterbiBlock[viterbiCounter] = v[inputCounter ++];
-            }
-            viterbiCounter++;
-        }
-    }
-
-    for (i = 0; i < L2; i ++) {
-        for (j = 0; j < 128; j ++) {
-            if (PI2[j % 32] != 0) {
-                viterbiBlock[viterbiCounter] = v[inputCounter ++];
-            }
-            viterbiCounter++;
-        }
-    }
-
-    for (i = 0; i < L3; i ++) {
-        for (j = 0; j < 128; j ++) {
-            if (PI3[j % 32] != 0) {
-                viterbiBlock[viterbiCounter] = v[inputCounter ++];
-            }
-            viterbiCounter++;
-        }
-    }
-
-    for (i = 0; i < L4; i ++) {
-        if (PI4 == nullptr) {
-            throw std::logic_error("Invalid usage of NULL PI4");
-        }
-
-        for (j = 0; j < 128; j ++) {
-            if (PI4[j % 32] != 0) {
-                viterbiBlock[viterbiCounter] = v[inputCounter ++];
+    for (const auto& stage : stages) {
+        for (i = 0; i < stage.blocks; i ++) {
+            for (j = 0; j < 128; j ++) {
+                if (stage.pi[j % 32] != 0) {
+                    viterbiBlock[viterbiCounter] = v[inputCounter ++];
+                }
+                viterbiCounter++;
             }
-            viterbiCounter++;
         }
     }
 
@@ -33,15 +33,11 @@ class UEPProtection: public Protection, public Viterbi
     public:
         UEPProtection(int16_t bitRate, int16_t protLevel);
         bool deconvolve(const softbit_t *v, int32_t size, uint8_t *outBuffer);
+
+        //  the (L1, PI1) .. (L4, PI4) tuples of the standard
+        static PuncturingSchedule schedule(int16_t bitRate, int16_t protLevel);
     private:
-        int16_t L1;
-        int16_t L2;
-        int16_t L3;
-        int16_t L4;
-        const int8_t *PI1;
-        const int8_t *PI2;
-        const int8_t *PI3;
-        const int8_t *PI4;
+        PuncturingSchedule stages;
         int32_t outSize;
         std::vector<softbit_t> viterbiBlock;
 };
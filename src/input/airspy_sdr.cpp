@@ -34,6 +34,7 @@
 
 #include <iostream>
 #include "airspy_sdr.h"
+#include "iq_convert.h"
 
 // For Qt translation if Qt is existing
 #ifdef QT_CORE_LIB
@@ -47,6 +48,7 @@ static const int EXTIO_BASE_TYPE_SIZE = sizeof(float);
 
 CAirspy::CAirspy(RadioControllerInterface &radioController) :
     radioController(radioController),
+    agc(AgcSettings(AGC_CLIP_LEVEL)),
     SampleBuffer(256 * 1024),
     SpectrumSampleBuffer(8192)
 {
@@ -66,7 +68,7 @@ CAirspy::CAirspy(RadioControllerInterface &radioController) :
         throw 0;
     }
 
-    airspy_set_sample_type(device, AIRSPY_SAMPLE_FLOAT32_IQ);
+    airspy_set_sample_type(device, AIRSPY_SAMPLE_INT16_IQ);
 
     result = airspy_set_samplerate(device, AIRSPY_SAMPLERATE);
     if (result != AIRSPY_SUCCESS) {
@@ -127,7 +129,8 @@ bool CAirspy::restart(void)
 
     SampleBuffer.FlushRingBuffer();
     SpectrumSampleBuffer.FlushRingBuffer();
-    result = airspy_set_sample_type(device, AIRSPY_SAMPLE_FLOAT32_IQ);
+    decimator.reset();
+    result = airspy_set_sample_type(device, AIRSPY_SAMPLE_INT16_IQ);
     if (result != AIRSPY_SUCCESS) {
         std::clog  << "Airspy: airspy_set_sample_type () failed: " << airspy_error_name((airspy_error)result) << "(" << result << ")" << std::endl;
         return false;
@@ -176,61 +179,52 @@ int CAirspy::callback(airspy_transfer* transfer)
     }
     auto *p = static_cast<CAirspy*>(transfer->ctx);
 
-    // AIRSPY_SAMPLE_FLOAT32_IQ:
-    p->data_available(reinterpret_cast<const DSPCOMPLEX*>(transfer->samples),
+    // AIRSPY_SAMPLE_INT16_IQ:
+    p->data_available(static_cast<const int16_t*>(transfer->samples),
             transfer->sample_count);
     return 0;
 }
 
-// Called from AirSpy data callback which gives us interleaved float32
+// Called from AirSpy data callback which gives us interleaved int16
 // I and Q according to setting given to airspy_set_sample_type() above.
 // The AirSpy runs at 4096ksps, we need to decimate by two.
-int CAirspy::data_available(const DSPCOMPLEX* buf, size_t num_samples)
+int CAirspy::data_available(const int16_t* buf, size_t num_samples)
 {
     if (num_samples % 2 != 0) {
         throw std::runtime_error("CAirspy::data_available() needs an even number of IQ samples to be able to decimate");
     }
 
-    const DSPCOMPLEX* sbuf = reinterpret_cast<const DSPCOMPLEX*>(buf);
-
-    std::vector<DSPCOMPLEX> temp(num_samples/2);
-
-    float maxnorm = 0;
-
-    for (size_t i = 0; i < num_samples/2; i++) {
-        const auto z = 0.5f * (sbuf[2*i] + sbuf[2*i+1]);
-        temp[i] = z;
-
-        if (sw_agc and (num_frames % 10) == 0) {
-            if (norm(z) > maxnorm) {
-                maxnorm = norm(z);
-            }
-        }
-    }
-
-    if (sw_agc and (num_frames % 10) == 0) {
-        const float maxampl = sqrt(maxnorm);
-        //  std::clog  << "Airspy: maxampl: " << maxampl << std::endl;
-
-        if (maxampl > 0.2f) {
-            const int newgain = currentLinearityGain - 1;
-            if (newgain >= AIRSPY_GAIN_MIN) {
-                setGain(newgain);
-            }
+    bool decide = false;
+
+    // Decimate straight into the sample buffer
+    const int32_t stored = iqconvert::toRingBuffer(SampleBuffer, buf, num_samples / 2, 4,
+            [&](const int16_t *in, DSPCOMPLEX *out, int32_t n) {
+                decimator.processS16(in, out, n);
+            },
+            [&](const DSPCOMPLEX *samples, int32_t n) {
+                SpectrumSampleBuffer.putDataIntoBuffer(samples, n);
+
+                if (sw_agc) {
+                    decide |= agc.add(samples, n);
+                }
+            });
+    accountSamples(num_samples / 2, stored);
+    notifySamplesAvailable();
+
+    if (decide) {
+        const bool atMaximum = currentLinearityGain >= AIRSPY_GAIN_MAX;
+        const AgcStep step = agc.decide(atMaximum ? 0 : AGC_STEP);
+
+        if (step == AgcStep::Down and currentLinearityGain > AIRSPY_GAIN_MIN) {
+            setGain(currentLinearityGain - 1);
+            agc.gainChanged(0);
         }
-        else if (maxampl < 0.02f) {
-             const int newgain = currentLinearityGain + 1;
-            if (newgain <= AIRSPY_GAIN_MAX) {
-                setGain(newgain);
-            }
+        else if (step == AgcStep::Up) {
+            setGain(currentLinearityGain + 1);
+            agc.gainChanged(0);
         }
     }
 
-    num_frames++;
-
-    SampleBuffer.putDataIntoBuffer(temp.data(), num_samples/2);
-    SpectrumSampleBuffer.putDataIntoBuffer(temp.data(), num_samples/2);
-
     return 0;
 }
 
@@ -38,6 +38,8 @@
 #include "dab-constants.h"
 #include "MathHelper.h"
 #include "ringbuffer.h"
+#include "resampler.h"
+#include "histogram_agc.h"
 
 #include <vector>
 
@@ -86,16 +88,21 @@ private:
     bool running = false;
     int freq = 0;
 
-    size_t num_frames = 0;
+    // The software AGC keeps the peaks of the decimated signal below
+    // AGC_CLIP_LEVEL. The linearity gain steps are about AGC_STEP dB.
+    const float AGC_CLIP_LEVEL = 0.2f;
+    const float AGC_STEP = 2.0f;
+    HistogramAgc agc;
 
     bool sw_agc = false;
     int currentLinearityGain = 10;
     RingBuffer<DSPCOMPLEX> SampleBuffer;
     RingBuffer<DSPCOMPLEX> SpectrumSampleBuffer;
     struct airspy_device *device;
+    HalfBandDecimator decimator;
 
     static int callback(airspy_transfer_t*);
-    int data_available(const DSPCOMPLEX* buf, size_t num_samples);
+    int data_available(const int16_t* buf, size_t num_samples);
 };
 
 #endif
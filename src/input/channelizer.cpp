@@ -0,0 +1,420 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include "channelizer.h"
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON)
+#  include <arm_neon.h>
+#endif
+
+// The channel filter passes the ensemble and stops at the edge of the
+// output band, so that the bins that are not synthesised hold nothing
+static const double passbandEdge = 770e3;
+static const double stopbandEdge = INPUT_RATE / 2;
+static const double stopbandAttenuation = 60.0;
+
+// Smallest FFT size of the wideband stream, which gives about 2 kHz
+// resolution at 8 MS/s
+static const size_t minimumInputSize = 4096;
+
+static const int32_t channelBufferSize = 1024 * 1024;
+
+static uint32_t gcd(uint32_t a, uint32_t b)
+{
+    while (b != 0) {
+        const uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// The FFT size must give an integer number of output bins, and both
+// sizes must be divisible by 8 for the overlap.
+static size_t chooseInputSize(uint32_t inputRate)
+{
+    if (inputRate < INPUT_RATE or inputRate % 8000 != 0) {
+        throw std::invalid_argument("Channelizer: unsupported input rate");
+    }
+    const size_t step = 8 * (inputRate / gcd(inputRate, INPUT_RATE));
+    return (minimumInputSize + step - 1) / step * step;
+}
+
+static double besselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+// out = in * w, element-wise on float arrays of length values
+static void weight(const float *in, const float *w, float *out, size_t length)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 8 <= length; i += 8) {
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(in + i), _mm_loadu_ps(w + i)));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_loadu_ps(in + i + 4), _mm_loadu_ps(w + i + 4)));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 8 <= length; i += 8) {
+        vst1q_f32(out + i, vmulq_f32(vld1q_f32(in + i), vld1q_f32(w + i)));
+        vst1q_f32(out + i + 4, vmulq_f32(vld1q_f32(in + i + 4), vld1q_f32(w + i + 4)));
+    }
+#endif
+    for (; i < length; i++) {
+        out[i] = in[i] * w[i];
+    }
+}
+
+CChannelizedInput::CChannelizedInput(CChannelizer& channelizer, size_t outputSize) :
+    channelizer(channelizer),
+    sampleBuffer(channelBufferSize),
+    spectrumSampleBuffer(8192),
+    ifft(outputSize)
+{
+}
+
+void CChannelizedInput::setFrequency(int frequency)
+{
+    channelizer.tune(*this, frequency);
+}
+
+int CChannelizedInput::getFrequency() const
+{
+    std::lock_guard<std::mutex> lock(channelizer.mutex);
+    return frequency;
+}
+
+bool CChannelizedInput::restart()
+{
+    return channelizer.start(*this);
+}
+
+bool CChannelizedInput::is_ok()
+{
+    return channelizer.running and channelizer.source->is_ok();
+}
+
+void CChannelizedInput::stop()
+{
+    channelizer.channelStopped(*this);
+}
+
+void CChannelizedInput::reset()
+{
+    sampleBuffer.FlushRingBuffer();
+}
+
+int32_t CChannelizedInput::getSamples(DSPCOMPLEX *buffer, int32_t size)
+{
+    return sampleBuffer.getDataFromBuffer(buffer, size);
+}
+
+std::vector<DSPCOMPLEX> CChannelizedInput::getSpectrumSamples(int size)
+{
+    std::vector<DSPCOMPLEX> buffer(size);
+    const int32_t amount = spectrumSampleBuffer.getDataFromBuffer(buffer.data(), size);
+    buffer.resize(amount);
+    return buffer;
+}
+
+int32_t CChannelizedInput::getSamplesToRead()
+{
+    return sampleBuffer.GetRingBufferReadAvailable();
+}
+
+float CChannelizedInput::setGain(int gain)
+{
+    return channelizer.source->setGain(gain);
+}
+
+float CChannelizedInput::getGain() const
+{
+    return channelizer.source->getGain();
+}
+
+int CChannelizedInput::getGainCount()
+{
+    return channelizer.source->getGainCount();
+}
+
+void CChannelizedInput::setAgc(bool agc)
+{
+    channelizer.source->setAgc(agc);
+}
+
+std::string CChannelizedInput::getDescription()
+{
+    return channelizer.source->getDescription() + " (channelized)";
+}
+
+CDeviceID CChannelizedInput::getID()
+{
+    return CDeviceID::CHANNELIZER;
+}
+
+CChannelizer::CChannelizer(std::unique_ptr<CVirtualInput> source, uint32_t inputRate) :
+    source(std::move(source)),
+    inputRate(inputRate),
+    inputSize(chooseInputSize(inputRate)),
+    outputSize(inputSize * INPUT_RATE / inputRate),
+    inputHop(inputSize - inputSize / 4),
+    outputHop(outputSize - outputSize / 4),
+    fft(inputSize),
+    window(inputSize)
+{
+    // Zero-phase low-pass filter, its length must not exceed the
+    // overlap of the blocks
+    const double transition = stopbandEdge - passbandEdge;
+    const double beta = 0.1102 * (stopbandAttenuation - 8.7);
+    size_t taps = std::ceil((stopbandAttenuation - 8) /
+            (2.285 * 2 * M_PI * transition / inputRate));
+    taps = std::min(taps | 1, inputSize / 4 - 1);
+    const int half = taps / 2;
+
+    const double cutoff = (passbandEdge + stopbandEdge) / inputRate;
+    std::vector<double> h(half + 1);
+    for (int n = 0; n <= half; n++) {
+        const double sinc = (n == 0) ? 1.0 : std::sin(M_PI * cutoff * n) / (M_PI * cutoff * n);
+        const double r = (double)n / (half + 1);
+        h[n] = cutoff * sinc * besselI0(beta * std::sqrt(1 - r * r)) / besselI0(beta);
+    }
+
+    // The response of a symmetric filter is real. The forward FFT is not
+    // normalised and the inverse one divides by the output size, so
+    // scale by the ratio of the sizes.
+    weights.resize(2 * outputSize);
+    for (size_t j = 0; j < outputSize; j++) {
+        const int k = j < outputSize / 2 ? (int)j : (int)j - (int)outputSize;
+        double response = h[0];
+        for (int n = 1; n <= half; n++) {
+            response += 2 * h[n] * std::cos(2 * M_PI * k * n / inputSize);
+        }
+        weights[2 * j] = weights[2 * j + 1] = response * outputSize / inputSize;
+    }
+
+    std::clog << "Channelizer: " << inputRate << " S/s, FFT of " <<
+        inputSize << " to " << outputSize << " bins, " << taps <<
+        " taps" << std::endl;
+}
+
+CChannelizer::~CChannelizer()
+{
+    std::lock_guard<std::mutex> lock(controlMutex);
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+    source->stop();
+}
+
+bool CChannelizer::fits(int frequency, int centreFrequency, uint32_t inputRate)
+{
+    const double offset = std::abs((double)frequency - centreFrequency);
+    return offset <= ((double)inputRate - INPUT_RATE) / 2;
+}
+
+CChannelizedInput* CChannelizer::addChannel(int frequency)
+{
+    std::unique_ptr<CChannelizedInput> channel(new CChannelizedInput(*this, outputSize));
+    if (not tune(*channel, frequency)) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    channels.push_back(std::move(channel));
+    return channels.back().get();
+}
+
+bool CChannelizer::tune(CChannelizedInput& channel, int frequency)
+{
+    const int centreFrequency = source->getFrequency();
+    if (not fits(frequency, centreFrequency, inputRate)) {
+        std::clog << "Channelizer: " << frequency / 1000 <<
+            " kHz is outside of the stream around " <<
+            centreFrequency / 1000 << " kHz" << std::endl;
+        return false;
+    }
+
+    const double binWidth = (double)inputRate / inputSize;
+    const double offset = frequency - centreFrequency;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    channel.frequency = frequency;
+    channel.bin = std::lround(offset / binWidth);
+    channel.residualOffset = offset - channel.bin * binWidth;
+    channel.block = 0;
+    channel.finePhase = 0;
+    return true;
+}
+
+bool CChannelizer::start(CChannelizedInput& channel)
+{
+    std::lock_guard<std::mutex> lock(controlMutex);
+    channel.active = true;
+    if (running) {
+        return true;
+    }
+
+    if (thread.joinable()) {
+        thread.join();
+    }
+
+    if (not source->restart()) {
+        return false;
+    }
+
+    std::fill(window.begin(), window.end(), DSPCOMPLEX(0, 0));
+    running = true;
+    thread = std::thread(&CChannelizer::run, this);
+    return true;
+}
+
+void CChannelizer::channelStopped(CChannelizedInput& channel)
+{
+    std::lock_guard<std::mutex> controlLock(controlMutex);
+    if (not channel.active.exchange(false)) {
+        return;
+    }
+
+    {
+        // Not held while joining, run() takes it too
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& other : channels) {
+            if (other->active) {
+                return;
+            }
+        }
+    }
+
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+    source->stop();
+}
+
+void CChannelizer::run()
+{
+    const size_t overlap = inputSize - inputHop;
+
+    while (running) {
+        // Slide the window by one hop
+        std::copy(window.end() - overlap, window.end(), window.begin());
+
+        size_t filled = overlap;
+        while (running and filled < inputSize) {
+            const int32_t wanted = inputSize - filled;
+            if (source->getSamplesToRead() < wanted) {
+                if (not source->is_ok()) {
+                    running = false;
+                    break;
+                }
+                source->waitForSamples(wanted, std::chrono::milliseconds(100));
+            }
+            filled += source->getSamples(&window[filled], wanted);
+        }
+
+        if (not running) {
+            break;
+        }
+
+        std::copy(window.begin(), window.end(), fft.getVector());
+        fft.do_FFT();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& channel : channels) {
+            if (channel->active) {
+                synthesise(*channel);
+            }
+        }
+    }
+}
+
+void CChannelizer::synthesise(CChannelizedInput& channel)
+{
+    const DSPCOMPLEX *spectrum = fft.getVector();
+    DSPCOMPLEX *bins = channel.ifft.getVector();
+
+    // Output bin j takes input bin (channel.bin + j) for the positive,
+    // (channel.bin + j - outputSize) for the negative frequencies. Copy
+    // and weight them in runs that do not wrap around the input FFT.
+    const int32_t n = inputSize;
+    size_t j = 0;
+    while (j < outputSize) {
+        const int32_t k = j < outputSize / 2 ? (int32_t)j : (int32_t)j - (int32_t)outputSize;
+        const int32_t from = ((channel.bin + k) % n + n) % n;
+        const size_t halfEnd = j < outputSize / 2 ? outputSize / 2 : outputSize;
+        const size_t length = std::min<size_t>(halfEnd - j, n - from);
+        weight(reinterpret_cast<const float*>(spectrum + from), &weights[2 * j],
+                reinterpret_cast<float*>(bins + j), 2 * length);
+        j += length;
+    }
+
+    channel.ifft.do_IFFT();
+
+    // A channel that is not on bin 0 turns by 2 pi bin hop / N between
+    // blocks, and the residual offset turns the samples within a block.
+    // The filter is zero-phase, so the valid samples are in the middle.
+    const uint64_t turnsNumerator = ((uint64_t)((channel.bin % n + n) % n) *
+            inputHop % n) * (channel.block % n) % n;
+    const double step = -channel.residualOffset / INPUT_RATE;
+    double phase = channel.finePhase - (double)turnsNumerator / n;
+    phase -= std::floor(phase);
+
+    const size_t first = (outputSize - outputHop) / 2;
+    DSPCOMPLEX *samples = bins + first;
+    std::complex<double> phasor = std::polar(1.0, 2 * M_PI * phase);
+    const std::complex<double> rotation = std::polar(1.0, 2 * M_PI * step);
+    for (size_t i = 0; i < outputHop; i++) {
+        samples[i] *= DSPCOMPLEX(phasor);
+        phasor *= rotation;
+    }
+
+    channel.finePhase += step * outputHop;
+    channel.finePhase -= std::floor(channel.finePhase);
+    channel.block++;
+
+    const int32_t stored = channel.sampleBuffer.putDataIntoBuffer(samples, outputHop);
+    channel.accountSamples(outputHop, stored);
+    channel.notifySamplesAvailable();
+    channel.spectrumSampleBuffer.putDataIntoBuffer(samples, outputHop);
+}
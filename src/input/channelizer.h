@@ -0,0 +1,158 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef CHANNELIZER_H
+#define CHANNELIZER_H
+
+// Splits the wideband stream of one input device into several
+// INPUT_RATE inputs, one per DAB ensemble, so that adjacent blocks can be
+// received with a single tuner, each with its own RadioReceiver.
+//
+// The filter bank works in the frequency domain (fast convolution,
+// overlap-save): every block of the wideband stream is transformed with
+// one large FFT, which all channels share. A channel takes the bins
+// around its frequency, weights them with the response of the channel
+// filter and synthesises its samples with a small inverse FFT, which
+// decimates to INPUT_RATE at the same time. As DAB blocks are not on a
+// uniform raster, every channel can sit on any bin; the remaining
+// offset of less than half a bin is removed after synthesis.
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "virtual_input.h"
+#include "ringbuffer.h"
+#include "fft.h"
+
+class CChannelizer;
+
+// One ensemble of the wideband stream, behaves like a normal input
+class CChannelizedInput : public CVirtualInput
+{
+public:
+    CChannelizedInput(CChannelizer& channelizer, size_t outputSize);
+    CChannelizedInput(const CChannelizedInput&) = delete;
+    CChannelizedInput& operator=(const CChannelizedInput&) = delete;
+
+    // Moves the channel within the wideband stream, the tuner itself
+    // stays where it is
+    void setFrequency(int frequency);
+    int getFrequency(void) const;
+    bool restart(void);
+    bool is_ok(void);
+    void stop(void);
+    void reset(void);
+    int32_t getSamples(DSPCOMPLEX *buffer, int32_t size);
+    std::vector<DSPCOMPLEX> getSpectrumSamples(int size);
+    int32_t getSamplesToRead(void);
+    // Gain and AGC are those of the shared tuner
+    float setGain(int gain);
+    float getGain(void) const;
+    int getGainCount(void);
+    void setAgc(bool agc);
+    std::string getDescription(void);
+    CDeviceID getID(void);
+
+private:
+    friend class CChannelizer;
+
+    CChannelizer& channelizer;
+    std::atomic<bool> active = ATOMIC_VAR_INIT(false);
+
+    // Tuning, guarded by the mutex of the channelizer
+    int frequency = 0;
+    int32_t bin = 0;
+    double residualOffset = 0;  // Hz, removed after synthesis
+    uint64_t block = 0;
+    double finePhase = 0;       // turns
+
+    RingBuffer<DSPCOMPLEX> sampleBuffer;
+    RingBuffer<DSPCOMPLEX> spectrumSampleBuffer;
+
+    // Synthesis
+    fft::Backward ifft;
+};
+
+class CChannelizer
+{
+public:
+    // source delivers inputRate samples per second around the frequency
+    // it is tuned to. Only rates that are a multiple of 8 kHz are
+    // supported.
+    CChannelizer(std::unique_ptr<CVirtualInput> source, uint32_t inputRate);
+    ~CChannelizer();
+    CChannelizer(const CChannelizer&) = delete;
+    CChannelizer& operator=(const CChannelizer&) = delete;
+
+    // The returned input belongs to the channelizer. Returns nullptr if
+    // the ensemble does not fit in the wideband stream.
+    CChannelizedInput* addChannel(int frequency);
+
+    // Whether an ensemble at frequency fits in the stream of a source
+    // with that rate and centre frequency
+    static bool fits(int frequency, int centreFrequency, uint32_t inputRate);
+
+    CVirtualInput& getSource(void) { return *source; }
+
+private:
+    friend class CChannelizedInput;
+
+    bool tune(CChannelizedInput& channel, int frequency);
+    bool start(CChannelizedInput& channel);
+    void channelStopped(CChannelizedInput& channel);
+    void run(void);
+    void synthesise(CChannelizedInput& channel);
+
+    std::unique_ptr<CVirtualInput> source;
+    const uint32_t inputRate;
+
+    // Sizes of the overlap-save blocks, at the input and output rate.
+    // Every block overlaps the previous one by a quarter.
+    size_t inputSize = 0;
+    size_t outputSize = 0;
+    size_t inputHop = 0;
+    size_t outputHop = 0;
+
+    // Response of the channel filter for the output bins, in FFT order,
+    // each value twice to weight I and Q. Includes the scaling of the FFTs.
+    std::vector<float> weights;
+
+    fft::Forward fft;
+    std::vector<DSPCOMPLEX> window;
+
+    std::vector<std::unique_ptr<CChannelizedInput> > channels;
+    std::mutex mutex;
+
+    // Serialises starting and stopping the thread and the source, and
+    // the changes of the active flags of the channels. Unlike mutex, it
+    // is held while joining the thread.
+    std::mutex controlMutex;
+    std::thread thread;
+    std::atomic<bool> running = ATOMIC_VAR_INIT(false);
+};
+
+#endif // CHANNELIZER_H
@@ -0,0 +1,755 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+#include "dab_generator.h"
+#include "eep-protection.h"
+#include "uep-protection.h"
+#include "phasetable.h"
+#include "protTables.h"
+#include "tools.h"
+
+extern "C" {
+#include <fec.h>
+}
+
+namespace {
+
+const int cuBits = 64;
+const int cifCUs = 864;
+const int cifBits = cifCUs * cuBits;
+const int cifsPerFrame = 4;
+const int fibBytes = 32;
+const int fibDataBytes = 30;
+const int fibsPerFrame = 12;
+const int ficBlockBits = 768;   // Three FIBs, before coding
+const int ficBlockCodedBits = 2304;
+const int ficSymbols = 3;
+
+// The transmitter delays bit i of every CIF by interleaveMap[i % 16]
+// CIFs, the receiver by 16 - interleaveMap[i % 16].
+const int16_t interleaveMap[] = {0,8,4,12,2,10,6,14,1,9,5,13,3,11,7,15};
+
+// FIC puncturing of every block of 3096 mother code bits, with
+// PI_16 and PI_15
+const PuncturingSchedule ficSchedule = {
+    {21, getPCodes(16 - 1)},
+    {3, getPCodes(15 - 1)},
+};
+
+// Generator polynomials of the mother code, with a_i in the most
+// significant of the 7 bits
+const uint8_t polynomials[4] = {0133, 0171, 0145, 0133};
+
+inline uint8_t parity(uint8_t v)
+{
+    v ^= v >> 4;
+    v ^= v >> 2;
+    v ^= v >> 1;
+    return v & 1;
+}
+
+// Rate 1/4 convolutional code with 6 tail bits, one bit per byte
+void convolutionalEncode(const std::vector<uint8_t>& in, std::vector<uint8_t>& out)
+{
+    out.resize(4 * (in.size() + 6));
+
+    uint8_t reg = 0;
+    size_t o = 0;
+    for (size_t i = 0; i < in.size() + 6; i++) {
+        const uint8_t bit = i < in.size() ? in[i] : 0;
+        reg = (reg >> 1) | (bit << 6);
+        for (const uint8_t polynomial : polynomials) {
+            out[o++] = parity(reg & polynomial);
+        }
+    }
+}
+
+// Inverse of the depuncturing in the Protection classes. Returns the
+// number of bits written to out.
+size_t puncture(const std::vector<uint8_t>& mother,
+        const PuncturingSchedule& schedule, uint8_t *out)
+{
+    size_t in = 0;
+    size_t o = 0;
+    for (const auto& stage : schedule) {
+        for (int i = 0; i < stage.blocks; i++) {
+            for (int j = 0; j < 128; j++) {
+                if (stage.pi[j % 32] != 0)
+                    out[o++] = mother[in];
+                in++;
+            }
+        }
+    }
+
+    for (int j = 0; j < 24; j++) {
+        if (PI_X[j] != 0)
+            out[o++] = mother[in];
+        in++;
+    }
+    return o;
+}
+
+size_t puncturedSize(const PuncturingSchedule& schedule)
+{
+    size_t bits = 0;
+    for (const auto& stage : schedule) {
+        const auto ones = std::count_if(stage.pi, stage.pi + 32,
+                [](int8_t p) { return p != 0; });
+        bits += stage.blocks * 4 * ones;
+    }
+    return bits + std::count_if(PI_X, PI_X + 24,
+            [](uint8_t p) { return p != 0; });
+}
+
+// Deterministic filler, one bit per byte
+void fillPseudoRandom(uint8_t *bits, size_t count, uint32_t seed)
+{
+    uint32_t state = seed * 2654435761u + 0x9E3779B9u;
+    if (state == 0)
+        state = 1;
+
+    for (size_t i = 0; i < count; i += 32) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        const size_t n = std::min<size_t>(32, count - i);
+        for (size_t j = 0; j < n; j++) {
+            bits[i + j] = (state >> j) & 1;
+        }
+    }
+}
+
+// One AU of AAC-LC mono silence: a single channel element without
+// scale factor bands, fill elements up to the requested size, the
+// terminator and the CRC
+void appendSilentAU(std::vector<uint8_t>& sf, size_t size)
+{
+    BitWriter bw;
+    bw.AddBits(0, 3);       // ID_SCE
+    bw.AddBits(0, 4);       // element_instance_tag
+    bw.AddBits(100, 8);     // global_gain
+    bw.AddBits(0, 1);       // ics_reserved_bit
+    bw.AddBits(0, 2);       // ONLY_LONG_SEQUENCE
+    bw.AddBits(0, 1);       // window_shape
+    bw.AddBits(0, 6);       // max_sfb
+    bw.AddBits(0, 1);       // predictor_data_present
+    bw.AddBits(0, 3);       // No pulse, TNS or gain control data
+
+    // A fill element takes 7 + 8 n bits. They fill all but fewer than
+    // eight bits, which the byte alignment after the terminator takes.
+    int bitsLeft = (size - 2) * 8 - 29 - 3;
+    while (bitsLeft >= 7) {
+        const bool escaped = bitsLeft >= 15 + 8 * 14;
+        const int count = escaped ?
+            std::min(269, (bitsLeft - 15) / 8) : (bitsLeft - 7) / 8;
+
+        bw.AddBits(6, 3);   // ID_FIL
+        if (escaped) {
+            bw.AddBits(15, 4);
+            bw.AddBits(count - 14, 8);
+        }
+        else {
+            bw.AddBits(count, 4);
+        }
+        if (count > 0) {
+            bw.AddBits(1, 4);   // EXT_FILL_DATA
+            bw.AddBits(0, 4);   // fill_nibble
+            for (int i = 0; i < count - 1; i++) {
+                bw.AddBits(0xA5, 8);
+            }
+        }
+        bitsLeft -= (escaped ? 15 : 7) + 8 * count;
+    }
+    bw.AddBits(7, 3);       // ID_END
+
+    const auto au = bw.GetData();
+    if (au.size() != size - 2) {
+        throw std::logic_error("DabGenerator: AU size mismatch");
+    }
+    const uint16_t crc = CalcCRC::CalcCRC_CRC16_CCITT.Calc(au.data(), au.size());
+    sf.insert(sf.end(), au.begin(), au.end());
+    sf.push_back(crc >> 8);
+    sf.push_back(crc & 0xFF);
+}
+
+// A DAB+ superframe with six AUs of silence, see ETSI TS 102 563
+std::vector<uint8_t> buildSuperframe(int bitrate)
+{
+    const int s = bitrate / 8;
+    const int numAUs = 6;
+    const int headerSize = 11;
+
+    std::vector<int> auStart(numAUs + 1);
+    for (int i = 0; i <= numAUs; i++) {
+        auStart[i] = headerSize + (110 * s - headerSize) * i / numAUs;
+    }
+
+    // 48 kHz, no SBR, mono, no PS, no MPEG Surround
+    BitWriter header;
+    header.AddBits(0x40, 8);
+    for (int i = 1; i < numAUs; i++) {
+        header.AddBits(auStart[i], 12);
+    }
+    header.AddBits(0, 4);
+
+    const auto format = header.GetData();
+    const uint16_t fire = CalcCRC::CalcCRC_FIRE_CODE.Calc(format.data(), format.size());
+    std::vector<uint8_t> sf = { (uint8_t)(fire >> 8), (uint8_t)(fire & 0xFF) };
+    sf.insert(sf.end(), format.begin(), format.end());
+
+    for (int i = 0; i < numAUs; i++) {
+        appendSilentAU(sf, auStart[i + 1] - auStart[i]);
+    }
+
+    // RS(120, 110) over the columns of the superframe, shortened from
+    // RS(255, 245) in the same way as the RSDecoder does
+    sf.resize(120 * s);
+    void *rs = init_rs_char(8, 0x11D, 0, 1, 10, 135);
+    if (not rs) {
+        throw std::runtime_error("DabGenerator: error while init_rs_char");
+    }
+    uint8_t packet[110];
+    uint8_t parity[10];
+    for (int i = 0; i < s; i++) {
+        for (int pos = 0; pos < 110; pos++) {
+            packet[pos] = sf[pos * s + i];
+        }
+        encode_rs_char(rs, packet, parity);
+        for (int pos = 0; pos < 10; pos++) {
+            sf[(110 + pos) * s + i] = parity[pos];
+        }
+    }
+    free_rs_char(rs);
+    return sf;
+}
+
+void appendLabel(std::vector<uint8_t>& fig, const std::string& label)
+{
+    for (size_t i = 0; i < 16; i++) {
+        fig.push_back(i < label.size() ? label[i] : ' ');
+    }
+    // The first eight characters make up the short label
+    fig.push_back(0xFF);
+    fig.push_back(0x00);
+}
+
+// Splits the entries of a FIG of type 0 over as many FIGs as needed
+// for each of them to fit into a FIB
+void addFig0(std::vector<std::vector<uint8_t>>& carousel, uint8_t extension,
+        const std::vector<std::vector<uint8_t>>& entries)
+{
+    std::vector<uint8_t> fig;
+    auto finish = [&]() {
+        if (not fig.empty()) {
+            fig[0] = fig.size() - 1;
+            carousel.push_back(fig);
+            fig.clear();
+        }
+    };
+
+    for (const auto& entry : entries) {
+        if (fig.size() + entry.size() > fibDataBytes) {
+            finish();
+        }
+        if (fig.empty()) {
+            // Type 0, C/N, OE and P/D all zero
+            fig = {0, extension};
+        }
+        fig.insert(fig.end(), entry.begin(), entry.end());
+    }
+    finish();
+}
+
+}
+
+DabGeneratorConfig DabGeneratorConfig::loadTest(size_t numServices)
+{
+    if (numServices < 1 or numServices > 64) {
+        throw std::invalid_argument("DabGenerator: 1 to 64 services are supported");
+    }
+
+    // EEP 3-A takes 6 CUs per 8 kbit/s
+    const int bitrate = std::min<int>(96, cifCUs / (numServices * 6) * 8);
+
+    DabGeneratorConfig config;
+    for (size_t i = 0; i < numServices; i++) {
+        DabGeneratorService service;
+        service.serviceId = 0x4000 + i;
+        service.label = "Generator " + std::to_string(i + 1);
+        service.bitrate = bitrate;
+        config.services.push_back(service);
+    }
+    return config;
+}
+
+CDabGenerator::CDabGenerator(const DabGeneratorConfig& config, bool throttle) :
+    config(config),
+    params(1),
+    throttle(throttle),
+    interleaver(params),
+    prsTable(params.T_u),
+    phaseReference(params.T_u),
+    ifft(params.T_u),
+    frame(params.T_F),
+    sampleBuffer(1024 * 1024),
+    spectrumSampleBuffer(8192)
+{
+    buildSubchannels();
+    buildFigs();
+
+    PhaseTable phaseTable(params.dabMode);
+    for (int i = 1; i <= params.K / 2; i++) {
+        prsTable[i] = std::polar(1.0f, (float)phaseTable.get_Phi(i));
+        prsTable[params.T_u - i] = std::polar(1.0f, (float)phaseTable.get_Phi(-i));
+    }
+
+    std::clog << "DabGenerator: " << subchannels.size() << " subchannels in " <<
+        (subchannels.empty() ? 0 : subchannels.back().subchannel.startAddr +
+         subchannels.back().subchannel.length) << " CUs" << std::endl;
+}
+
+CDabGenerator::~CDabGenerator()
+{
+    stop();
+}
+
+void CDabGenerator::buildSubchannels()
+{
+    if (config.services.size() > 64) {
+        throw std::invalid_argument("DabGenerator: at most 64 subchannels are supported");
+    }
+
+    static const int eepACUs[] = {12, 8, 6, 4};     // Per 8 kbit/s
+    static const int eepBCUs[] = {27, 21, 18, 15};  // Per 32 kbit/s
+
+    int startAddr = 0;
+    for (size_t i = 0; i < config.services.size(); i++) {
+        const auto& service = config.services[i];
+
+        GeneratedSubchannel sub;
+        sub.bitrate = service.bitrate;
+        sub.subchannel.subChId = i;
+        sub.subchannel.startAddr = startAddr;
+        sub.subchannel.protectionSettings = service.protection;
+
+        auto& ps = sub.subchannel.protectionSettings;
+        if (ps.shortForm) {
+            int index = -1;
+            for (int j = 0; j < 64; j++) {
+                if (ProtLevel[j][2] == service.bitrate and
+                        ProtLevel[j][1] == ps.uepLevel) {
+                    index = j;
+                    break;
+                }
+            }
+            if (index == -1) {
+                throw std::invalid_argument("DabGenerator: no UEP profile for " +
+                        std::to_string(service.bitrate) + " kbit/s, level " +
+                        std::to_string(ps.uepLevel));
+            }
+            ps.uepTableIndex = index;
+            sub.subchannel.length = ProtLevel[index][0];
+            sub.schedule = UEPProtection::schedule(service.bitrate, ps.uepLevel);
+        }
+        else {
+            const bool eepA = ps.eepProfile == EEPProtectionProfile::EEP_A;
+            const int level = static_cast<int>(ps.eepLevel);
+            const int granularity = eepA ? 8 : 32;
+            if (service.bitrate <= 0 or service.bitrate % granularity != 0 or
+                    (eepA and level == 2 and service.bitrate == 8)) {
+                throw std::invalid_argument("DabGenerator: " +
+                        std::to_string(service.bitrate) + " kbit/s is invalid for " +
+                        sub.subchannel.protection());
+            }
+            sub.subchannel.length = eepA ?
+                service.bitrate / 8 * eepACUs[level - 1] :
+                service.bitrate / 32 * eepBCUs[level - 1];
+            sub.schedule = EEPProtection::schedule(service.bitrate, eepA, level);
+        }
+
+        // Some UEP profiles leave a few padding bits at the end
+        if (puncturedSize(sub.schedule) > (size_t)sub.subchannel.length * cuBits) {
+            throw std::logic_error("DabGenerator: puncturing exceeds the subchannel size");
+        }
+
+        if (service.type == AudioServiceComponentType::DABPlus) {
+            // The AU start addresses of a superframe have 12 bits
+            if (service.bitrate % 8 != 0 or service.bitrate > 192) {
+                throw std::invalid_argument("DabGenerator: " +
+                        std::to_string(service.bitrate) + " kbit/s is invalid for DAB+");
+            }
+            sub.superframe = buildSuperframe(service.bitrate);
+        }
+
+        startAddr += sub.subchannel.length;
+        if (startAddr > cifCUs) {
+            throw std::invalid_argument("DabGenerator: the services need " +
+                    std::to_string(startAddr) + " of " + std::to_string(cifCUs) + " CUs");
+        }
+
+        sub.history.assign(16, std::vector<uint8_t>(sub.subchannel.length * cuBits));
+        subchannels.push_back(std::move(sub));
+    }
+}
+
+void CDabGenerator::buildFigs()
+{
+    std::vector<std::vector<uint8_t>> entries;
+
+    // FIG 0/1, subchannel organisation
+    for (const auto& sub : subchannels) {
+        const auto& s = sub.subchannel;
+        const auto& ps = s.protectionSettings;
+        std::vector<uint8_t> entry = {
+            (uint8_t)((s.subChId << 2) | (s.startAddr >> 8)),
+            (uint8_t)(s.startAddr & 0xFF) };
+        if (ps.shortForm) {
+            entry.push_back(ps.uepTableIndex);
+        }
+        else {
+            const int option = ps.eepProfile == EEPProtectionProfile::EEP_A ? 0 : 1;
+            const int level = static_cast<int>(ps.eepLevel) - 1;
+            entry.push_back(0x80 | (option << 4) | (level << 2) | (s.length >> 8));
+            entry.push_back(s.length & 0xFF);
+        }
+        entries.push_back(entry);
+    }
+    addFig0(figCarousel, 1, entries);
+
+    // FIG 0/2, one audio component per service
+    entries.clear();
+    for (size_t i = 0; i < config.services.size(); i++) {
+        const auto& service = config.services[i];
+        const uint8_t ascty =
+            service.type == AudioServiceComponentType::DABPlus ? 63 : 0;
+        entries.push_back({
+                (uint8_t)(service.serviceId >> 8),
+                (uint8_t)(service.serviceId & 0xFF),
+                1,
+                ascty,
+                (uint8_t)((subchannels[i].subchannel.subChId << 2) | 0x02) });
+    }
+    addFig0(figCarousel, 2, entries);
+
+    // FIG 1/0 and 1/1, labels in EBU Latin
+    std::vector<uint8_t> fig = {
+        (1 << 5) | 21, 0x00,
+        (uint8_t)(config.ensembleId >> 8),
+        (uint8_t)(config.ensembleId & 0xFF) };
+    appendLabel(fig, config.ensembleLabel);
+    figCarousel.push_back(fig);
+
+    for (const auto& service : config.services) {
+        fig = {
+            (1 << 5) | 21, 0x01,
+            (uint8_t)(service.serviceId >> 8),
+            (uint8_t)(service.serviceId & 0xFF) };
+        appendLabel(fig, service.label);
+        figCarousel.push_back(fig);
+    }
+}
+
+void CDabGenerator::buildFic(std::vector<uint8_t>& bits)
+{
+    std::vector<uint8_t> block(ficBlockBits);
+    std::vector<uint8_t> mother;
+
+    for (int f = 0; f < fibsPerFrame; f++) {
+        std::vector<uint8_t> fib;
+        fib.reserve(fibBytes);
+
+        if (f == 0) {
+            // FIG 0/0 with the CIF count of the first CIF of the frame
+            fib = { 5, 0x00,
+                (uint8_t)(config.ensembleId >> 8),
+                (uint8_t)(config.ensembleId & 0xFF),
+                (uint8_t)((cifCount / 250) % 20),
+                (uint8_t)(cifCount % 250) };
+        }
+
+        for (size_t tried = 0; tried < figCarousel.size(); tried++) {
+            const auto& fig = figCarousel[carouselPosition];
+            if (fib.size() + fig.size() > fibDataBytes)
+                break;
+            fib.insert(fib.end(), fig.begin(), fig.end());
+            carouselPosition = (carouselPosition + 1) % figCarousel.size();
+        }
+
+        // End marker and padding
+        if (fib.size() < fibDataBytes)
+            fib.push_back(0xFF);
+        fib.resize(fibDataBytes, 0x00);
+
+        const uint16_t crc = CalcCRC::CalcCRC_CRC16_CCITT.Calc(fib.data(), fibDataBytes);
+        fib.push_back(crc >> 8);
+        fib.push_back(crc & 0xFF);
+
+        uint8_t *out = block.data() + (f % 3) * fibBytes * 8;
+        for (int i = 0; i < fibBytes * 8; i++) {
+            out[i] = (fib[i / 8] >> (7 - i % 8)) & 1;
+        }
+
+        if (f % 3 == 2) {
+            ficDispersal.dedisperse(block);
+            convolutionalEncode(block, mother);
+            puncture(mother, ficSchedule, bits.data() + (f / 3) * ficBlockCodedBits);
+        }
+    }
+}
+
+void CDabGenerator::buildCif(uint8_t *bits)
+{
+    // Unused capacity gets filler as well, so that the MSC has the same
+    // power in every symbol
+    fillPseudoRandom(bits, cifBits, 0xFFFFFFFF ^ cifCount);
+
+    std::vector<uint8_t> payload;
+    std::vector<uint8_t> mother;
+    const int slot = cifCount % 16;
+
+    for (auto& sub : subchannels) {
+        payload.resize(24 * sub.bitrate);
+        if (sub.superframe.empty()) {
+            fillPseudoRandom(payload.data(), payload.size(),
+                    (sub.subchannel.subChId << 24) ^ cifCount);
+        }
+        else {
+            // Superframes start at CIF counts that are multiples of five
+            const uint8_t *frame = sub.superframe.data() + (cifCount % 5) * 3 * sub.bitrate;
+            for (size_t i = 0; i < payload.size(); i++) {
+                payload[i] = (frame[i / 8] >> (7 - i % 8)) & 1;
+            }
+        }
+        sub.dispersal.dedisperse(payload);
+        convolutionalEncode(payload, mother);
+        puncture(mother, sub.schedule, sub.history[slot].data());
+
+        // Bit i leaves interleaveMap[i % 16] CIFs after it was coded
+        uint8_t *out = bits + sub.subchannel.startAddr * cuBits;
+        const size_t size = sub.history[slot].size();
+        for (size_t i = 0; i < size; i++) {
+            out[i] = sub.history[(slot - interleaveMap[i & 15]) & 15][i];
+        }
+    }
+
+    cifCount++;
+}
+
+void CDabGenerator::modulateSymbol(const uint8_t *bits, DSPCOMPLEX *out)
+{
+    const int K = params.K;
+    const int T_u = params.T_u;
+    const float scale = 1 / std::sqrt(2.0f);
+
+    DSPCOMPLEX *v = ifft.getVector();
+    std::fill(v, v + T_u, DSPCOMPLEX(0, 0));
+
+    for (int i = 0; i < K; i++) {
+        int index = interleaver.mapIn(i);
+        if (index < 0)
+            index += T_u;
+
+        // Differential QPSK, the inverse of the OfdmDecoder mapping
+        const DSPCOMPLEX symbol((1 - 2 * bits[i]) * scale,
+                (1 - 2 * bits[K + i]) * scale);
+        phaseReference[index] *= symbol;
+        v[index] = phaseReference[index];
+    }
+    transformSymbol(out);
+}
+
+void CDabGenerator::transformSymbol(DSPCOMPLEX *out)
+{
+    DSPCOMPLEX *v = ifft.getVector();
+    ifft.do_IFFT();
+
+    // An rms of about 0.25 leaves headroom for the impairments
+    const float gain = 0.25f * params.T_u / std::sqrt((float)params.K);
+    const int T_g = params.guardLength;
+    for (int i = 0; i < T_g; i++)
+        out[i] = v[params.T_u - T_g + i] * gain;
+    for (int i = 0; i < params.T_u; i++)
+        out[T_g + i] = v[i] * gain;
+}
+
+void CDabGenerator::generateFrame(DSPCOMPLEX *out)
+{
+    const int symbolBits = 2 * params.K;
+    std::vector<uint8_t> bits(params.L * symbolBits);
+
+    // FIC in symbols 1 to 3, the four CIFs after it
+    std::vector<uint8_t> ficBits(ficSymbols * symbolBits);
+    buildFic(ficBits);
+    std::copy(ficBits.begin(), ficBits.end(), bits.begin() + symbolBits);
+    for (int c = 0; c < cifsPerFrame; c++) {
+        buildCif(bits.data() + (1 + ficSymbols) * symbolBits + c * cifBits);
+    }
+
+    std::fill(out, out + params.T_null, DSPCOMPLEX(0, 0));
+    out += params.T_null;
+
+    // Phase reference symbol
+    std::copy(prsTable.begin(), prsTable.end(), ifft.getVector());
+    phaseReference = prsTable;
+    transformSymbol(out);
+    out += params.T_s;
+
+    for (int l = 1; l < params.L; l++) {
+        modulateSymbol(bits.data() + l * symbolBits, out);
+        out += params.T_s;
+    }
+}
+
+void CDabGenerator::run()
+{
+    const auto framePeriod = std::chrono::microseconds(
+            (int64_t)params.T_F * 1000000 / INPUT_RATE);
+    auto nextFrame = std::chrono::steady_clock::now();
+
+    while (running) {
+        generateFrame(frame.data());
+
+        {
+            std::unique_lock<std::mutex> lock(spaceMutex);
+            spaceAvailable.wait(lock, [&]() {
+                    return not running or
+                        sampleBuffer.GetRingBufferWriteAvailable() >= params.T_F; });
+        }
+        if (not running)
+            break;
+
+        if (throttle) {
+            nextFrame += framePeriod;
+            std::this_thread::sleep_until(nextFrame);
+        }
+
+        const int32_t stored = sampleBuffer.putDataIntoBuffer(frame.data(), params.T_F);
+        accountSamples(params.T_F, stored);
+        spectrumSampleBuffer.putDataIntoBuffer(frame.data() + params.T_null, 8192);
+        notifySamplesAvailable();
+    }
+}
+
+void CDabGenerator::setFrequency(int Frequency)
+{
+    frequency = Frequency;
+}
+
+int CDabGenerator::getFrequency(void) const
+{
+    return frequency;
+}
+
+bool CDabGenerator::restart()
+{
+    if (running)
+        return true;
+
+    running = true;
+    worker = std::thread(&CDabGenerator::run, this);
+    return true;
+}
+
+bool CDabGenerator::is_ok()
+{
+    return true;
+}
+
+void CDabGenerator::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(spaceMutex);
+        running = false;
+    }
+    spaceAvailable.notify_all();
+
+    if (worker.joinable())
+        worker.join();
+}
+
+void CDabGenerator::reset()
+{
+    sampleBuffer.FlushRingBuffer();
+}
+
+int32_t CDabGenerator::getSamples(DSPCOMPLEX *Buffer, int32_t Size)
+{
+    const int32_t amount = sampleBuffer.getDataFromBuffer(Buffer, Size);
+    {
+        std::lock_guard<std::mutex> lock(spaceMutex);
+    }
+    spaceAvailable.notify_all();
+    return amount;
+}
+
+std::vector<DSPCOMPLEX> CDabGenerator::getSpectrumSamples(int size)
+{
+    std::vector<DSPCOMPLEX> buffer(size);
+    const int sizeRead = spectrumSampleBuffer.getDataFromBuffer(buffer.data(), size);
+    buffer.resize(sizeRead);
+    return buffer;
+}
+
+int32_t CDabGenerator::getSamplesToRead()
+{
+    return sampleBuffer.GetRingBufferReadAvailable();
+}
+
+float CDabGenerator::getGain() const
+{
+    return 0;
+}
+
+float CDabGenerator::setGain(int Gain)
+{
+    (void) Gain;
+    return 0;
+}
+
+int CDabGenerator::getGainCount()
+{
+    return 0;
+}
+
+void CDabGenerator::setAgc(bool AGC)
+{
+    (void) AGC;
+}
+
+std::string CDabGenerator::getDescription()
+{
+    return "DAB generator, " + std::to_string(config.services.size()) + " services";
+}
+
+CDeviceID CDabGenerator::getID()
+{
+    return CDeviceID::GENERATOR;
+}
@@ -0,0 +1,157 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef DAB_GENERATOR_H
+#define DAB_GENERATOR_H
+
+// An input that synthesises a transmission mode I ensemble instead of
+// receiving one, for reproducible benchmarks and regression runs.
+//
+// The FIC carries FIG 0/0, 0/1, 0/2, 1/0 and 1/1. DAB+ subchannels
+// carry valid superframes of silent 48 kHz AAC-LC mono audio, with the
+// fire code, the AU CRCs and the RS parity. DAB subchannels are filled
+// with a deterministic pseudo-random payload that depends only on the
+// subchannel and the CIF count: the receiver decodes it without errors,
+// but it is no valid MP2 audio.
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "virtual_input.h"
+#include "dab-constants.h"
+#include "energy_dispersal.h"
+#include "freq-interleaver.h"
+#include "protection.h"
+#include "fft.h"
+
+struct DabGeneratorService {
+    uint16_t serviceId = 0;
+    std::string label;
+    AudioServiceComponentType type = AudioServiceComponentType::DABPlus;
+    int bitrate = 64;   // kbit/s
+
+    // Long form EEP, or short form UEP with uepLevel set. The UEP
+    // table index is looked up from the bitrate and the level.
+    ProtectionSettings protection;
+};
+
+struct DabGeneratorConfig {
+    uint16_t ensembleId = 0x4FFF;
+    std::string ensembleLabel = "welle.io test";
+    std::vector<DabGeneratorService> services;
+
+    // numServices DAB+ services with EEP 3-A, all with the highest
+    // bitrate up to 96 kbit/s that lets them fit into the MSC
+    static DabGeneratorConfig loadTest(size_t numServices);
+};
+
+class CDabGenerator : public CVirtualInput
+{
+public:
+    // Throws std::invalid_argument if the services do not fit into
+    // the multiplex. Without throttling, frames are generated as fast
+    // as the receiver consumes them.
+    CDabGenerator(const DabGeneratorConfig& config, bool throttle = true);
+    ~CDabGenerator();
+    CDabGenerator(const CDabGenerator&) = delete;
+    CDabGenerator& operator=(const CDabGenerator&) = delete;
+
+    void setFrequency(int Frequency);
+    int getFrequency(void) const;
+    bool restart(void);
+    bool is_ok(void);
+    void stop(void);
+    void reset(void);
+    int32_t getSamples(DSPCOMPLEX* Buffer, int32_t Size);
+    std::vector<DSPCOMPLEX> getSpectrumSamples(int size);
+    int32_t getSamplesToRead(void);
+    float getGain(void) const;
+    float setGain(int Gain);
+    int getGainCount(void);
+    void setAgc(bool AGC);
+    std::string getDescription(void);
+    CDeviceID getID(void);
+
+    // Writes the next transmission frame of T_F samples to out. Used
+    // by the worker thread, but can also be called directly when no
+    // thread is running.
+    void generateFrame(DSPCOMPLEX *out);
+
+private:
+    struct GeneratedSubchannel {
+        Subchannel subchannel;
+        PuncturingSchedule schedule;
+        int bitrate = 0;
+        EnergyDispersal dispersal;
+
+        // The last 16 punctured logical frames, for time interleaving
+        std::vector<std::vector<uint8_t>> history;
+
+        // DAB+ only, the five logical frames of a superframe. The audio
+        // is silent, so every superframe is the same.
+        std::vector<uint8_t> superframe;
+    };
+
+    void buildSubchannels(void);
+    void buildFigs(void);
+    void buildFic(std::vector<uint8_t>& bits);
+    void buildCif(uint8_t *bits);
+    void modulateSymbol(const uint8_t *bits, DSPCOMPLEX *out);
+    void transformSymbol(DSPCOMPLEX *out);
+    void run(void);
+
+    const DabGeneratorConfig config;
+    const DABParams params;
+    const bool throttle;
+    int frequency = 0;
+
+    std::vector<GeneratedSubchannel> subchannels;
+
+    // FIGs that are sent in turn, FIG 0/0 excluded
+    std::vector<std::vector<uint8_t>> figCarousel;
+    size_t carouselPosition = 0;
+    EnergyDispersal ficDispersal;
+
+    uint32_t cifCount = 0;
+    FrequencyInterleaver interleaver;
+    std::vector<DSPCOMPLEX> prsTable;
+    std::vector<DSPCOMPLEX> phaseReference;
+    fft::Backward ifft;
+
+    std::vector<DSPCOMPLEX> frame;
+    RingBuffer<DSPCOMPLEX> sampleBuffer;
+    RingBuffer<DSPCOMPLEX> spectrumSampleBuffer;
+
+    std::thread worker;
+    std::atomic<bool> running = ATOMIC_VAR_INIT(false);
+    std::mutex spaceMutex;
+    std::condition_variable spaceAvailable;
+};
+
+#endif // DAB_GENERATOR_H
@@ -0,0 +1,155 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <algorithm>
+#include "impaired_input.h"
+
+CImpairedInput::CImpairedInput(CVirtualInput& parent,
+        const ImpairmentSettings& settings) :
+    parent(parent),
+    impairments(settings)
+{
+}
+
+void CImpairedInput::setFrequency(int Frequency)
+{
+    parent.setFrequency(Frequency);
+}
+
+int CImpairedInput::getFrequency(void) const
+{
+    return parent.getFrequency();
+}
+
+bool CImpairedInput::restart(void)
+{
+    discard();
+    return parent.restart();
+}
+
+bool CImpairedInput::is_ok(void)
+{
+    return parent.is_ok();
+}
+
+bool CImpairedInput::endOfInput(void)
+{
+    return parent.endOfInput();
+}
+
+void CImpairedInput::stop(void)
+{
+    parent.stop();
+}
+
+void CImpairedInput::reset(void)
+{
+    discard();
+    parent.reset();
+}
+
+// The samples left from before do not join up with the next ones
+void CImpairedInput::discard(void)
+{
+    discardPending = true;
+    numPending = 0;
+}
+
+int32_t CImpairedInput::getSamples(DSPCOMPLEX* Buffer, int32_t Size)
+{
+    if (discardPending.exchange(false)) {
+        pending.clear();
+    }
+
+    if (pending.size() < (size_t)Size) {
+        input.resize(Size - pending.size());
+        const int32_t read = parent.getSamples(input.data(), input.size());
+        impairments.process(input.data(), read, pending);
+    }
+
+    const size_t n = std::min((size_t)Size, pending.size());
+    std::copy(pending.begin(), pending.begin() + n, Buffer);
+    pending.erase(pending.begin(), pending.begin() + n);
+    numPending = pending.size();
+    return n;
+}
+
+// The spectrum shows the signal without impairments
+std::vector<DSPCOMPLEX> CImpairedInput::getSpectrumSamples(int size)
+{
+    return parent.getSpectrumSamples(size);
+}
+
+int32_t CImpairedInput::getSamplesToRead(void)
+{
+    return parent.getSamplesToRead() + numPending;
+}
+
+int32_t CImpairedInput::waitForSamples(int32_t n, std::chrono::milliseconds timeout)
+{
+    const int32_t buffered = numPending;
+    return parent.waitForSamples(std::max(n - buffered, 0), timeout) + buffered;
+}
+
+InputStats CImpairedInput::getInputStats(void)
+{
+    return parent.getInputStats();
+}
+
+IQCorrectionStats CImpairedInput::getIQCorrection(void)
+{
+    return parent.getIQCorrection();
+}
+
+float CImpairedInput::getGain(void) const
+{
+    return parent.getGain();
+}
+
+float CImpairedInput::setGain(int Gain)
+{
+    return parent.setGain(Gain);
+}
+
+int CImpairedInput::getGainCount(void)
+{
+    return parent.getGainCount();
+}
+
+void CImpairedInput::setAgc(bool AGC)
+{
+    parent.setAgc(AGC);
+}
+
+std::string CImpairedInput::getDescription(void)
+{
+    return parent.getDescription() + " with " +
+        impairments.getSettings().describe();
+}
+
+CDeviceID CImpairedInput::getID(void)
+{
+    return parent.getID();
+}
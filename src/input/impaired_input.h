@@ -0,0 +1,85 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef IMPAIRED_INPUT_H
+#define IMPAIRED_INPUT_H
+
+// Passes the samples of another input through a ChannelImpairments, to
+// run the receiver on a degraded version of a recording or of the
+// generator. The other input must outlive this one.
+
+#include <atomic>
+#include <vector>
+
+#include "virtual_input.h"
+#include "channel_impairments.h"
+
+class CImpairedInput : public CVirtualInput
+{
+public:
+    CImpairedInput(CVirtualInput& parent, const ImpairmentSettings& settings);
+    CImpairedInput(const CImpairedInput&) = delete;
+    CImpairedInput& operator=(const CImpairedInput&) = delete;
+
+    void setFrequency(int Frequency);
+    int getFrequency(void) const;
+    bool restart(void);
+    bool is_ok(void);
+    bool endOfInput(void);
+    void stop(void);
+    void reset(void);
+    int32_t getSamples(DSPCOMPLEX* Buffer, int32_t Size);
+    std::vector<DSPCOMPLEX> getSpectrumSamples(int size);
+    int32_t getSamplesToRead(void);
+    int32_t waitForSamples(int32_t n, std::chrono::milliseconds timeout);
+    float getGain(void) const;
+    float setGain(int Gain);
+    int getGainCount(void);
+    void setAgc(bool AGC);
+    std::string getDescription(void);
+    CDeviceID getID(void);
+    InputStats getInputStats(void);
+    IQCorrectionStats getIQCorrection(void);
+
+    CVirtualInput& getParent(void) { return parent; }
+    const ChannelImpairments& getImpairments(void) const { return impairments; }
+
+private:
+    CVirtualInput& parent;
+    ChannelImpairments impairments;
+
+    std::vector<DSPCOMPLEX> input;
+
+    // Impaired samples not read yet. The sample clock offset makes the
+    // impairments return a few samples more or less than they are given.
+    std::vector<DSPCOMPLEX> pending;
+    std::atomic<int32_t> numPending = ATOMIC_VAR_INIT(0);
+    // Set by reset() and restart(), pending is cleared by the reader
+    std::atomic<bool> discardPending = ATOMIC_VAR_INIT(false);
+
+    void discard(void);
+};
+
+#endif // IMPAIRED_INPUT_H
@@ -26,7 +26,15 @@
  *
  */
 
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 // For Qt translation if Qt is existing
 #ifdef QT_CORE_LIB
@@ -36,6 +44,8 @@
 #endif
 
 #include "input_factory.h"
+#include "dab_generator.h"
+#include "multicast_input.h"
 #include "null_device.h"
 #include "rtl_tcp.h"
 #include "raw_file.h"
@@ -111,6 +121,8 @@ CVirtualInput *CInputFactory::GetDevice(RadioControllerInterface &radioControlle
         case CDeviceID::ANDROID_RTL_SDR: InputDevice = new CAndroid_RTL_SDR(radioController); break;
 #endif
         case CDeviceID::NULLDEVICE: InputDevice = new CNullDevice(); break;
+        case CDeviceID::GENERATOR: InputDevice = new CDabGenerator(DabGeneratorConfig::loadTest(1)); break;
+        case CDeviceID::MULTICAST: InputDevice = new CMulticastInput(radioController); break;
         default: throw std::runtime_error("unknown device ID " + std::string(__FILE__) +":"+ std::to_string(__LINE__));
         }
     }
@@ -129,38 +141,178 @@ CVirtualInput *CInputFactory::GetDevice(RadioControllerInterface &radioControlle
     return InputDevice;
 }
 
-CVirtualInput* CInputFactory::GetAutoDevice(RadioControllerInterface& radioController)
+// Probes that take longer are abandoned. A device they open later is
+// closed again by their thread.
+static const std::chrono::seconds probeTimeout(10);
+
+namespace {
+
+// A backend GetAutoDevice tries, in the order of preference. Backends
+// of the same stage are probed concurrently. A stage only starts if the
+// stages before found no device, because its backends may claim the
+// hardware of the earlier ones, e.g. SoapySDR an RTL-SDR stick.
+struct AutoProbe {
+    const char *name;
+    int stage;
+    std::function<CVirtualInput*(RadioControllerInterface&)> open;
+};
+
+// Receives the callbacks of a device while it is probed. A probe may
+// outlive GetAutoDevice and the radio controller of the caller, so it
+// only ever gets this one, and the device that is chosen is opened
+// again for the caller.
+class ProbeRadioController : public RadioControllerInterface {
+    public:
+        ProbeRadioController(const char *name) : name(name) {}
+
+        void onSNR(float) override {}
+        void onFrequencyCorrectorChange(int, int) override {}
+        void onSyncChange(char) override {}
+        void onSignalPresence(bool) override {}
+        void onServiceDetected(uint32_t) override {}
+        void onNewEnsemble(uint16_t) override {}
+        void onSetEnsembleLabel(DabLabel&) override {}
+        void onDateTimeUpdate(const dab_date_time_t&) override {}
+        void onFIBDecodeSuccess(bool, const uint8_t*) override {}
+        void onNewImpulseResponse(std::vector<float>&&) override {}
+        void onConstellationPoints(std::vector<DSPCOMPLEX>&&) override {}
+        void onNewNullSymbol(std::vector<DSPCOMPLEX>&&) override {}
+        void onTIIMeasurement(tii_measurement_t&&) override {}
+        void onMessage(message_level_t, const std::string& text,
+                const std::string& text2 = std::string()) override {
+            std::ostringstream ss;
+            ss << "InputFactory: Probing " << name << ": " << text << text2 << std::endl;
+            std::clog << ss.str();
+        }
+
+    private:
+        const char *name;
+};
+
+// Shared by GetAutoDevice and the thread that opens the device
+struct ProbeState {
+    ProbeState(const char *name) : radioController(name) {}
+
+    ProbeRadioController radioController;
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool done = false;
+    bool abandoned = false;
+    CVirtualInput *device = nullptr;
+};
+
+void runProbe(const char *name, std::shared_ptr<ProbeState> state,
+        std::function<CVirtualInput*(RadioControllerInterface&)> open)
 {
-    (void)radioController;
-    CVirtualInput *inputDevice = nullptr;
+    const auto start = std::chrono::steady_clock::now();
 
-    // Try to find a input device
-    for (int i = 0; i <= 3; i++) {
-        try {
-            switch(i) {
+    CVirtualInput *device = nullptr;
+    try {
+        device = open(state->radioController);
+    }
+    catch (...) {
+        // An error occurred. Maybe the device isn't present.
+    }
+
+    const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+
+    // One write, so that the lines of the probes do not mix
+    std::ostringstream ss;
+    ss << "InputFactory: Probing " << name << " took " << duration.count() <<
+        " ms, " << (device ? "device found" : "no device") << std::endl;
+    std::clog << ss.str();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    if (state->abandoned) {
+        lock.unlock();
+        delete device;
+        return;
+    }
+    state->device = device;
+    state->done = true;
+    state->finished.notify_all();
+}
+
+}
+
+CVirtualInput* CInputFactory::GetAutoDevice(RadioControllerInterface& radioController)
+{
+    std::vector<AutoProbe> probes;
 #ifdef HAVE_AIRSPY
-            case 0: inputDevice = new CAirspy(radioController); break;
+    probes.push_back({"airspy", 0, [](RadioControllerInterface& rc) -> CVirtualInput* { return new CAirspy(rc); }});
 #endif
 #ifdef HAVE_RTLSDR
-            case 1: inputDevice = new CRTL_SDR(radioController); break;
+    probes.push_back({"rtl_sdr", 0, [](RadioControllerInterface& rc) -> CVirtualInput* { return new CRTL_SDR(rc); }});
 #endif
 #ifdef HAVE_SOAPYSDR
-            case 2: inputDevice = new CSoapySdr(radioController); break;
-#endif
-#ifdef __ANDROID__
-            case 3: inputDevice = new CAndroid_RTL_SDR(radioController); break;
+    probes.push_back({"soapysdr", 1, [](RadioControllerInterface& rc) -> CVirtualInput* { return new CSoapySdr(rc); }});
 #endif
+
+    CVirtualInput *inputDevice = nullptr;
+
+    for (size_t first = 0; first < probes.size() and inputDevice == nullptr; ) {
+        size_t last = first;
+        while (last < probes.size() and probes[last].stage == probes[first].stage)
+            last++;
+
+        std::vector<std::shared_ptr<ProbeState>> states;
+        for (size_t i = first; i < last; i++) {
+            states.push_back(std::make_shared<ProbeState>(probes[i].name));
+            std::thread(runProbe, probes[i].name, states.back(), probes[i].open).detach();
+        }
+
+        // Take the first device in the order of preference, but wait for
+        // the preferred ones before, so that the choice does not depend
+        // on which backend is fastest
+        const auto deadline = std::chrono::steady_clock::now() + probeTimeout;
+        for (size_t i = first; i < last; i++) {
+            auto& state = *states[i - first];
+            std::unique_lock<std::mutex> lock(state.mutex);
+            if (inputDevice == nullptr and
+                    not state.finished.wait_until(lock, deadline, [&]() { return state.done; })) {
+                std::clog << "InputFactory: Probing " << probes[i].name <<
+                    " timed out" << std::endl;
+            }
+
+            // A device from the probe is only proof that the hardware is
+            // there, it refers to the controller of the probe
+            std::unique_ptr<CVirtualInput> probed(state.device);
+            state.device = nullptr;
+            state.abandoned = true;
+            lock.unlock();
+
+            const bool found = probed != nullptr;
+            probed.reset();
+
+            if (found and inputDevice == nullptr) {
+                try {
+                    inputDevice = probes[i].open(radioController);
+                }
+                catch (...) {
+                    std::clog << "InputFactory: Could not open " <<
+                        probes[i].name << " again" << std::endl;
+                }
             }
         }
+
+        first = last;
+    }
+
+#ifdef __ANDROID__
+    // Only starts the Android driver in restart(), so it cannot fail here
+    // and comes last
+    if (inputDevice == nullptr) {
+        try {
+            inputDevice = new CAndroid_RTL_SDR(radioController);
+        }
         catch (...) {
-            // An error occurred. Maybe the device isn't present.
-            // Just try the next input device
         }
-
-        // Break loop if we found a device
-        if (inputDevice != nullptr)
-            break;
     }
+#endif
+
+    if (inputDevice != nullptr)
+        std::clog << "InputFactory: Using " << inputDevice->getDescription() << std::endl;
 
     return inputDevice;
 }
@@ -200,6 +352,12 @@ CVirtualInput* CInputFactory::GetManualDevice(RadioControllerInterface& radioCon
 #endif
         if (device == "rawfile")
             InputDevice = new CRAWFile(radioController);
+        else
+        if (device == "generator")
+            InputDevice = new CDabGenerator(DabGeneratorConfig::loadTest(1));
+        else
+        if (device == "multicast")
+            InputDevice = new CMulticastInput(radioController);
         else
             std::clog << "InputFactory:"
                 "Unknown device \"" << device << "\"." << std::endl;
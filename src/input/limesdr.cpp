@@ -30,6 +30,7 @@
 
 #include <iostream>
 #include "limesdr.h"
+#include "iq_convert.h"
 
 // For Qt translation if Qt is existing
 #ifdef QT_CORE_LIB
@@ -205,12 +206,17 @@ void CLimeSDR::limesdr_thread_run()
         res = LMS_RecvStream (&stream, localBuffer,
                               FIFO_SIZE,  &meta, 1000);
         if (res > 0) {
-            std::vector<DSPCOMPLEX> temp(res);
-            for (int i = 0; i < res; i ++) {
-                temp[i] = DSPCOMPLEX(localBuffer[2*i] / 2048.0, localBuffer[2*i+1] / 2048.0);
-            }
-            SampleBuffer.putDataIntoBuffer (temp.data(), res);
-            SpectrumSampleBuffer.putDataIntoBuffer (temp.data(), res);
+            // 12 bit samples in (little endian) int16, scaled to [-1, 1[
+            const int32_t stored = iqconvert::toRingBuffer(SampleBuffer,
+                    reinterpret_cast<const uint8_t*>(localBuffer), res, 4,
+                    [](const uint8_t *in, DSPCOMPLEX *out, int32_t n) {
+                        iqconvert::fromS16LE(in, out, n, DSPCOMPLEX(0, 0), 32768.0f / 2048.0f);
+                    },
+                    [&](const DSPCOMPLEX *samples, int32_t n) {
+                        SpectrumSampleBuffer.putDataIntoBuffer(samples, n);
+                    });
+            accountSamples(res, stored);
+            notifySamplesAvailable();
             amountRead += res;
             res = LMS_GetStreamStatus (&stream, &streamStatus);
             underruns += streamStatus. underrun;
@@ -0,0 +1,278 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <algorithm>
+#include <iostream>
+
+#include "multicast_input.h"
+
+// For Qt translation if Qt is existing
+#ifdef QT_CORE_LIB
+    #include <QtGlobal>
+#else
+    #define QT_TRANSLATE_NOOP(x,y) (y)
+#endif
+
+// Half a second of signal
+static const uint32_t sampleBufferSize = 1024 * 1024;
+
+// Room for the datagrams that arrive while the receiver is busy, about
+// 180 ms of cf32 at 2.048 MS/s
+static const int socketReceiveBufferSize = 4 * 1024 * 1024;
+
+// Datagrams received with one system call, and the room for each of
+// them. Anything longer than maxDatagramSize is no valid datagram.
+static const size_t receiveBatch = 64;
+static const size_t receiveBufferStride = 2048;
+
+// recvDatagrams() returns at least this often, to check if we have to stop
+static const int receiveTimeout_ms = 100;
+
+// Gaps of up to this many datagrams are filled with silence, longer
+// ones are only counted
+static const uint64_t maxFilledGap = 1024;
+
+CMulticastInput::CMulticastInput(RadioControllerInterface& radioController) :
+    radioController(radioController),
+    sampleBuffer(sampleBufferSize),
+    spectrumSampleBuffer(8192),
+    receiveBuffer(receiveBatch * receiveBufferStride),
+    datagrams(receiveBatch),
+    samples(iqmulticast::samplesPerDatagram(iqmulticast::Format::CS8)),
+    silence(samples.size())
+{
+    recordFormat = "cf32";
+}
+
+CMulticastInput::~CMulticastInput()
+{
+    stop();
+
+    const auto stats = getStats();
+    if (stats.datagrams > 0) {
+        std::clog << "MulticastInput: Received " << stats.datagrams <<
+            " datagrams, lost " << stats.lost << " in " << stats.gaps <<
+            " gaps, " << stats.late << " late, " << stats.invalid <<
+            " invalid, " << stats.restarts << " restarts" << std::endl;
+    }
+}
+
+void CMulticastInput::setGroup(const std::string& group, int port,
+        const std::string& interfaceAddress)
+{
+    this->group = group;
+    this->port = port;
+    this->interfaceAddress = interfaceAddress;
+}
+
+void CMulticastInput::setFrequency(int Frequency)
+{
+    (void) Frequency;
+}
+
+int CMulticastInput::getFrequency(void) const
+{
+    return frequency;
+}
+
+bool CMulticastInput::restart()
+{
+    if (running)
+        return true;
+
+    sock.setReceiveBufferSize(socketReceiveBufferSize);
+    if (not sock.joinMulticastGroup(group, port, interfaceAddress)) {
+        radioController.onMessage(message_level_t::Error,
+                QT_TRANSLATE_NOOP("CRadioController", "Could not join the multicast group."));
+        return false;
+    }
+    sock.setReceiveTimeout(receiveTimeout_ms);
+
+    std::clog << "MulticastInput: Joined " << group << ":" << port <<
+        (interfaceAddress.empty() ? "" : " on " + interfaceAddress) << std::endl;
+
+    synchronised = false;
+    running = true;
+    receiveThread = std::thread(&CMulticastInput::receiveData, this);
+    return true;
+}
+
+bool CMulticastInput::is_ok()
+{
+    return running;
+}
+
+void CMulticastInput::stop()
+{
+    running = false;
+    if (receiveThread.joinable())
+        receiveThread.join();
+
+    if (sock.valid())
+        sock.close();
+}
+
+void CMulticastInput::reset()
+{
+    sampleBuffer.FlushRingBuffer();
+    spectrumSampleBuffer.FlushRingBuffer();
+}
+
+int32_t CMulticastInput::getSamples(DSPCOMPLEX *Buffer, int32_t Size)
+{
+    return sampleBuffer.getDataFromBuffer(Buffer, Size);
+}
+
+std::vector<DSPCOMPLEX> CMulticastInput::getSpectrumSamples(int size)
+{
+    std::vector<DSPCOMPLEX> buffer(size);
+    const int sizeRead = spectrumSampleBuffer.getDataFromBuffer(buffer.data(), size);
+    buffer.resize(sizeRead);
+    return buffer;
+}
+
+int32_t CMulticastInput::getSamplesToRead()
+{
+    return sampleBuffer.GetRingBufferReadAvailable();
+}
+
+float CMulticastInput::getGain() const
+{
+    return 0;
+}
+
+float CMulticastInput::setGain(int Gain)
+{
+    (void) Gain;
+    return 0;
+}
+
+int CMulticastInput::getGainCount()
+{
+    return 0;
+}
+
+void CMulticastInput::setAgc(bool AGC)
+{
+    (void) AGC;
+}
+
+std::string CMulticastInput::getDescription()
+{
+    return "Multicast " + group + ":" + std::to_string(port) + ", " +
+        iqmulticast::formatName(format);
+}
+
+CDeviceID CMulticastInput::getID()
+{
+    return CDeviceID::MULTICAST;
+}
+
+MulticastInputStats CMulticastInput::getStats() const
+{
+    MulticastInputStats stats;
+    stats.datagrams = numDatagrams;
+    stats.lost = numLost;
+    stats.gaps = numGaps;
+    stats.late = numLate;
+    stats.invalid = numInvalid;
+    stats.restarts = numRestarts;
+    return stats;
+}
+
+void CMulticastInput::receiveData()
+{
+    while (running) {
+        for (size_t i = 0; i < receiveBatch; i++) {
+            datagrams[i].data = receiveBuffer.data() + i * receiveBufferStride;
+            datagrams[i].length = receiveBufferStride;
+        }
+
+        const int received = sock.recvDatagrams(datagrams.data(), receiveBatch, 0);
+        if (received <= 0) {
+            // Timeout, check if we have to stop
+            continue;
+        }
+
+        for (int i = 0; i < received; i++) {
+            handleDatagram((const uint8_t*)datagrams[i].data, datagrams[i].length);
+        }
+        notifySamplesAvailable();
+    }
+}
+
+void CMulticastInput::handleDatagram(const uint8_t *datagram, size_t length)
+{
+    iqmulticast::Header header;
+    if (length > iqmulticast::maxDatagramSize or
+            not iqmulticast::readHeader(datagram, length, header)) {
+        numInvalid++;
+        return;
+    }
+
+    const size_t count = iqmulticast::unpack(datagram + iqmulticast::headerSize,
+            length - iqmulticast::headerSize, header.format, samples.data());
+
+    if (synchronised and header.stream != stream) {
+        std::clog << "MulticastInput: Publisher restarted" << std::endl;
+        numRestarts++;
+        synchronised = false;
+    }
+
+    if (synchronised and header.sequence < nextSequence) {
+        numLate++;
+        return;
+    }
+
+    if (synchronised and header.sequence > nextSequence) {
+        const uint64_t lost = header.sequence - nextSequence;
+        numLost += lost;
+        numGaps++;
+
+        // The silence stands in for the lost samples, the receiver sees
+        // them as dropped
+        if (lost <= maxFilledGap) {
+            for (uint64_t i = 0; i < lost; i++) {
+                sampleBuffer.putDataIntoBuffer(silence.data(), count);
+                putIntoRecordBuffer(*reinterpret_cast<const uint8_t*>(silence.data()),
+                        count * sizeof(DSPCOMPLEX));
+            }
+        }
+        accountSamples(lost * count, 0);
+    }
+
+    synchronised = true;
+    stream = header.stream;
+    nextSequence = header.sequence + 1;
+    numDatagrams++;
+    frequency = header.centreFrequency;
+    format = header.format;
+
+    const int32_t stored = sampleBuffer.putDataIntoBuffer(samples.data(), count);
+    accountSamples(count, stored);
+    spectrumSampleBuffer.putDataIntoBuffer(samples.data(), count);
+    putIntoRecordBuffer(*reinterpret_cast<const uint8_t*>(samples.data()),
+            count * sizeof(DSPCOMPLEX));
+}
@@ -0,0 +1,124 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MULTICAST_INPUT_H
+#define MULTICAST_INPUT_H
+
+// Receives the IQ samples another welle-cli publishes to a multicast
+// group, see iq_multicast.h. The datagrams are received in batches.
+// Missing datagrams are replaced by silence, so that the receiver keeps
+// its timing across short losses, and are counted as dropped samples.
+// The tuner belongs to the publisher: the frequency is the one the
+// datagrams carry, and gain settings are ignored.
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "virtual_input.h"
+#include "radio-controller.h"
+#include "ringbuffer.h"
+#include "iq_multicast.h"
+#include "Socket.h"
+
+struct MulticastInputStats {
+    uint64_t datagrams = 0;     // Received and used
+    uint64_t lost = 0;          // Datagrams that never arrived
+    uint64_t gaps = 0;          // Runs of lost datagrams
+    uint64_t late = 0;          // Arrived out of order, or twice
+    uint64_t invalid = 0;       // No IQ datagram, or of unknown version
+    uint64_t restarts = 0;      // Times the publisher restarted
+};
+
+class CMulticastInput : public CVirtualInput
+{
+public:
+    CMulticastInput(RadioControllerInterface& radioController);
+    ~CMulticastInput();
+    CMulticastInput(const CMulticastInput&) = delete;
+    CMulticastInput& operator=(const CMulticastInput&) = delete;
+
+    // Interface methods
+    void setFrequency(int Frequency);
+    int getFrequency(void) const;
+    bool restart(void);
+    bool is_ok(void);
+    void stop(void);
+    void reset(void);
+    int32_t getSamples(DSPCOMPLEX* Buffer, int32_t Size);
+    std::vector<DSPCOMPLEX> getSpectrumSamples(int size);
+    int32_t getSamplesToRead(void);
+    float getGain(void) const;
+    float setGain(int Gain);
+    int getGainCount(void);
+    void setAgc(bool AGC);
+    std::string getDescription(void);
+    CDeviceID getID(void);
+
+    // Specific methods, they take effect at the next restart()
+    void setGroup(const std::string& group, int port,
+            const std::string& interfaceAddress = "");
+
+    MulticastInputStats getStats(void) const;
+
+private:
+    void receiveData(void);
+    void handleDatagram(const uint8_t *datagram, size_t length);
+
+    RadioControllerInterface& radioController;
+
+    std::string group = "239.255.0.1";
+    int port = 5500;
+    std::string interfaceAddress;
+
+    Socket sock;
+    std::thread receiveThread;
+    std::atomic<bool> running = ATOMIC_VAR_INIT(false);
+
+    RingBuffer<DSPCOMPLEX> sampleBuffer;
+    RingBuffer<DSPCOMPLEX> spectrumSampleBuffer;
+
+    // One receive buffer per datagram of a batch
+    std::vector<uint8_t> receiveBuffer;
+    std::vector<Socket::Datagram> datagrams;
+    std::vector<DSPCOMPLEX> samples;
+    std::vector<DSPCOMPLEX> silence;
+
+    bool synchronised = false;
+    uint16_t stream = 0;
+    uint64_t nextSequence = 0;
+    std::atomic<int> frequency = ATOMIC_VAR_INIT(0);
+    std::atomic<iqmulticast::Format> format = ATOMIC_VAR_INIT(iqmulticast::Format::CF32);
+
+    std::atomic<uint64_t> numDatagrams = ATOMIC_VAR_INIT(0);
+    std::atomic<uint64_t> numLost = ATOMIC_VAR_INIT(0);
+    std::atomic<uint64_t> numGaps = ATOMIC_VAR_INIT(0);
+    std::atomic<uint64_t> numLate = ATOMIC_VAR_INIT(0);
+    std::atomic<uint64_t> numInvalid = ATOMIC_VAR_INIT(0);
+    std::atomic<uint64_t> numRestarts = ATOMIC_VAR_INIT(0);
+};
+
+#endif // MULTICAST_INPUT_H
@@ -0,0 +1,112 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MULTICAST_PUBLISHER_H
+#define MULTICAST_PUBLISHER_H
+
+// Publishes the samples the receiver reads from another input to a
+// multicast group, see iq_multicast.h, while passing them on unchanged.
+// Complete datagrams are sent in batches without waiting: if the socket
+// cannot take them, they are dropped and their sequence numbers are
+// skipped, so that the receivers see the loss. The same is done for the
+// samples discarded by reset(), restart() and setFrequency(). The other
+// input must outlive this one.
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "virtual_input.h"
+#include "iq_multicast.h"
+#include "Socket.h"
+
+struct MulticastPublisherStats {
+    uint64_t datagrams = 0;     // Sent
+    uint64_t dropped = 0;       // The socket could not take them
+};
+
+class CMulticastPublisher : public CVirtualInput
+{
+public:
+    // Throws std::runtime_error if the group cannot be used
+    CMulticastPublisher(CVirtualInput& parent, const std::string& group, int port,
+            const std::string& interfaceAddress, iqmulticast::Format format, int ttl = 1);
+    ~CMulticastPublisher();
+    CMulticastPublisher(const CMulticastPublisher&) = delete;
+    CMulticastPublisher& operator=(const CMulticastPublisher&) = delete;
+
+    void setFrequency(int Frequency);
+    int getFrequency(void) const;
+    bool restart(void);
+    bool is_ok(void);
+    bool endOfInput(void);
+    void stop(void);
+    void reset(void);
+    int32_t getSamples(DSPCOMPLEX* Buffer, int32_t Size);
+    std::vector<DSPCOMPLEX> getSpectrumSamples(int size);
+    int32_t getSamplesToRead(void);
+    int32_t waitForSamples(int32_t n, std::chrono::milliseconds timeout);
+    float getGain(void) const;
+    float setGain(int Gain);
+    int getGainCount(void);
+    void setAgc(bool AGC);
+    std::string getDescription(void);
+    CDeviceID getID(void);
+    InputStats getInputStats(void);
+    IQCorrectionStats getIQCorrection(void);
+
+    CVirtualInput& getParent(void) { return parent; }
+    MulticastPublisherStats getStats(void) const;
+
+private:
+    void publish(const DSPCOMPLEX *samples, size_t count);
+    void sendBatch(void);
+    void skipPending(void);
+
+    CVirtualInput& parent;
+    const std::string group;
+    const int port;
+    const iqmulticast::Format format;
+    const size_t samplesPerDatagram;
+    const size_t datagramSize;
+    const uint16_t stream;
+
+    Socket sock;
+
+    // Datagrams of the batch that are complete, and the samples already
+    // in the next one
+    std::vector<uint8_t> batch;
+    std::vector<Socket::Datagram> datagrams;
+    size_t numComplete = 0;
+    size_t numPending = 0;
+    uint64_t sequence = 0;
+    // Set by the controller, handled by the reader in publish()
+    std::atomic<bool> discontinuity = ATOMIC_VAR_INIT(false);
+
+    std::atomic<uint64_t> numSent = ATOMIC_VAR_INIT(0);
+    std::atomic<uint64_t> numDropped = ATOMIC_VAR_INIT(0);
+};
+
+#endif // MULTICAST_PUBLISHER_H
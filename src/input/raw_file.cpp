@@ -38,8 +38,15 @@
 #include <sys/time.h>
 #include <time.h>
 #include <unistd.h>
+#include <algorithm>
+#include <limits>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 #include "raw_file.h"
+#include "iq_convert.h"
 
 // For Qt translation if Qt is existing
 #ifdef QT_CORE_LIB
@@ -73,7 +80,12 @@ CRAWFile::CRAWFile(RadioControllerInterface& radioController,
 
 CRAWFile::~CRAWFile(void)
 {
-    ExitCondition = true;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        ExitCondition = true;
+    }
+    spaceAvailable.notify_all();
+    dataAvailable.notify_all();
     if (readerOK) {
         if (thread.joinable()) {
             thread.join();
@@ -83,6 +95,8 @@ CRAWFile::~CRAWFile(void)
             fclose(filePointer);
         }
     }
+
+    unmapFile();
 }
 
 void CRAWFile::setFrequency(int Frequency)
@@ -97,14 +111,47 @@ int CRAWFile::getFrequency() const
 
 bool CRAWFile::restart(void)
 {
-    if (readerOK)
+    if (readerOK) {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        if (readerPausing) {
+            playbackStart_us = getMyTime();
+            samplesSinceStart = 0;
+        }
         readerPausing = false;
+    }
+    dataAvailable.notify_all();
     return readerOK;
 }
 
 bool CRAWFile::is_ok()
 {
-    return readerOK;
+    if (not readerOK)
+        return false;
+
+    // is_ok() is asked by a consumer that is waiting for more samples,
+    // which it must stop doing once nothing else will arrive.
+    if (endOfInput()) {
+        if (mappedData and not endReached) {
+            radioController.onMessage(message_level_t::Information,
+                    QT_TRANSLATE_NOOP("CRadioController", "End of file"));
+            endReached = true;
+        }
+        return false;
+    }
+
+    return true;
+}
+
+bool CRAWFile::endOfInput()
+{
+    // Without rewinding, once everything left in the file is readable
+    // nothing else will arrive.
+    if (mappedData) {
+        return not autoRewind and not readerPausing and
+            mappedSamplesAvailable() == (mappedSize - mappedPos) / IQByteSize;
+    }
+
+    return readerFinished;
 }
 
 void CRAWFile::stop(void)
@@ -119,10 +166,56 @@ void CRAWFile::reset()
 
 void CRAWFile::rewind()
 {
-    if (filePointer) {
-        fseek(filePointer, 0, SEEK_SET);
+    seek(0);
+}
+
+bool CRAWFile::seek(int64_t samplePosition)
+{
+    if (samplePosition < 0)
+        return false;
+
+    if (mappedData) {
+        mappedPos = std::min(samplePosition * IQByteSize, mappedSize);
+        playbackStart_us = getMyTime();
+        samplesSinceStart = 0;
+        endReached = false;
+        return true;
+    }
+    else if (container) {
+        if (not container->seek(samplePosition))
+            return false;
+        currPos = container->getSamplePosition() * IQByteSize;
+        requestFlush();
+        endReached = false;
+        return true;
+    }
+    else if (filePointer) {
+        if (fseek(filePointer, samplePosition * IQByteSize, SEEK_SET) != 0)
+            return false;
+        currPos = samplePosition * IQByteSize;
+        requestFlush();
         endReached = false;
+        return true;
     }
+
+    return false;
+}
+
+int64_t CRAWFile::getSamplePosition() const
+{
+    if (mappedData)
+        return mappedPos / IQByteSize;
+
+    return currPos / IQByteSize;
+}
+
+int64_t CRAWFile::getNumSamples() const
+{
+    if (container)
+        return container->getInfo().numSamples;
+
+    // The length of a file read through the reader thread is not known
+    return mappedData ? mappedSize / IQByteSize : -1;
 }
 
 float CRAWFile::getGain() const
@@ -152,6 +245,30 @@ std::string CRAWFile::getDescription()
     return "rawfile (" + fileName + ")";
 }
 
+bool CRAWFile::setDeviceParam(DeviceParam param, int value)
+{
+    switch(param) {
+        case DeviceParam::SampleRate:
+            sampleRate = value;
+            return true;
+        case DeviceParam::IQCorrection:
+            // Only the integer formats can be corrected
+            if (fileFormat == CRAWFileFormat::COMPLEXF or
+                    fileFormat == CRAWFileFormat::Unknown)
+                return false;
+            iqCorrector.setEnabled(value);
+            return true;
+        default: std::runtime_error("Unsupported device parameter");
+    }
+
+    return false;
+}
+
+IQCorrectionStats CRAWFile::getIQCorrection()
+{
+    return iqCorrector.getStats();
+}
+
 CDeviceID CRAWFile::getID()
 {
     return CDeviceID::RAWFILE;
@@ -163,6 +280,12 @@ bool ends_with(const std::string& value, const std::string& ending)
     return std::equal(ending.rbegin(), ending.rend(), value.rbegin());
 }
 
+static bool isContainer(const std::string& fileFormat, const std::string& fileName)
+{
+    return fileFormat == "wiq" or
+        (fileFormat == "auto" and ends_with(fileName, ".wiq"));
+}
+
 void CRAWFile::setFileName(const std::string& fileName,
         const std::string& fileFormat)
 {
@@ -181,6 +304,21 @@ void CRAWFile::setFileName(const std::string& fileName,
     readerOK = true;
     readerPausing = true;
     currPos = 0;
+
+    if (isContainer(fileFormat, fileName)) {
+        if (openContainer())
+            thread = std::thread(&CRAWFile::run, this);
+        return;
+    }
+
+    // Regular files are mapped, the mapping stays valid after fclose().
+    // Anything else (pipes, devices) goes through the reader thread.
+    if (mapFile(fileno(filePointer))) {
+        fclose(filePointer);
+        filePointer = nullptr;
+        return;
+    }
+
     thread = std::thread(&CRAWFile::run, this);
 }
 
@@ -201,9 +339,53 @@ void CRAWFile::setFileHandle(int handle, const std::string& fileFormat)
     readerOK = true;
     readerPausing = true;
     currPos = 0;
+
+    if (isContainer(fileFormat, fileName)) {
+        if (openContainer())
+            thread = std::thread(&CRAWFile::run, this);
+        return;
+    }
+
+    if (mapFile(handle)) {
+        fclose(filePointer);
+        filePointer = nullptr;
+        return;
+    }
+
     thread = std::thread(&CRAWFile::run, this);
 }
 
+bool CRAWFile::openContainer()
+{
+    container.reset(new IQContainerReader());
+
+    if (not container->open(filePointer)) {
+        std::clog << "RAWFile: Not a valid IQ container: " << fileName << std::endl;
+        radioController.onMessage(message_level_t::Error,
+                QT_TRANSLATE_NOOP("CRadioController", "Unknown RAW file format"));
+        container.reset();
+        fclose(filePointer);
+        filePointer = nullptr;
+        readerOK = false;
+        return false;
+    }
+
+    const auto& info = container->getInfo();
+    fileFormat = info.format == IQContainerFormat::S8 ?
+        CRAWFileFormat::S8 : CRAWFileFormat::U8;
+    recordFormat = info.format == IQContainerFormat::S8 ? "s8" : "u8";
+    IQByteSize = 2;
+
+    std::clog << "RAWFile: IQ container with " << info.numSamples <<
+        " samples, centre frequency " << info.centreFrequency / 1000 <<
+        " kHz" << std::endl;
+    if (info.sampleRate != INPUT_RATE) {
+        std::clog << "RAWFile: IQ container was recorded at " <<
+            info.sampleRate << " samples/s instead of " << INPUT_RATE << std::endl;
+    }
+    return true;
+}
+
 std::string CRAWFile::getFileName() const
 {
     return fileName;
@@ -212,22 +394,43 @@ std::string CRAWFile::getFileName() const
 //	size is in I/Q pairs, file contains 8 bits values
 int32_t CRAWFile::getSamples(DSPCOMPLEX* V, int32_t size)
 {
+    if (mappedData)
+        return getMappedSamples(V, size);
+
     if (filePointer == nullptr)
         return 0;
 
-    while ((int32_t)(SampleBuffer.GetRingBufferReadAvailable()) < IQByteSize * size)
-        if (readerPausing)
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        else
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    {
+        std::unique_lock<std::mutex> lock(bufferMutex);
+        dataAvailable.wait(lock, [&]() {
+                if (sampleFlushRequested.exchange(false))
+                    SampleBuffer.FlushRingBuffer();
+                return (int32_t)SampleBuffer.GetRingBufferReadAvailable() >= IQByteSize * size or
+                    ExitCondition or readerFinished; });
+    }
 
-    return convertSamples(SampleBuffer, V, size);
+    const int32_t amount = convertSamples(SampleBuffer, V, size, true);
+    spaceAvailable.notify_one();
+    return amount;
 }
 
 std::vector<DSPCOMPLEX> CRAWFile::getSpectrumSamples(int size)
 {
     std::vector<DSPCOMPLEX> buffer(size);
 
+    if (mappedData) {
+        // Show the samples the receiver has consumed last
+        const int64_t end = mappedPos;
+        const int64_t start = std::max<int64_t>(0, end - (int64_t)size * IQByteSize);
+        const int32_t sizeRead = (end - start) / IQByteSize;
+        convertRaw(mappedData + start, buffer.data(), sizeRead);
+        buffer.resize(sizeRead);
+        return buffer;
+    }
+
+    if (spectrumFlushRequested.exchange(false))
+        SpectrumSampleBuffer.FlushRingBuffer();
+
     int sizeRead = convertSamples(SpectrumSampleBuffer, buffer.data(), size);
     if (sizeRead < size) {
         buffer.resize(sizeRead);
@@ -238,7 +441,150 @@ std::vector<DSPCOMPLEX> CRAWFile::getSpectrumSamples(int size)
 
 int32_t CRAWFile::getSamplesToRead(void)
 {
-    return SampleBuffer.GetRingBufferReadAvailable() / 2;
+    if (mappedData) {
+        return std::min<int64_t>(mappedSamplesAvailable(),
+                std::numeric_limits<int32_t>::max());
+    }
+
+    return SampleBuffer.GetRingBufferReadAvailable() / IQByteSize;
+}
+
+int32_t CRAWFile::waitForSamples(int32_t n, std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(bufferMutex);
+
+    if (not mappedData) {
+        dataAvailable.wait_for(lock, timeout, [&]() {
+                return (int32_t)SampleBuffer.GetRingBufferReadAvailable() >= IQByteSize * n or
+                    ExitCondition or readerFinished; });
+        return getSamplesToRead();
+    }
+
+    if (readerPausing) {
+        dataAvailable.wait_for(lock, timeout, [&]() {
+                return not readerPausing or ExitCondition; });
+    }
+    else if (throttle) {
+        // The samples become due as the clock advances, nobody else
+        // has to wake us up.
+        const int64_t due_us = playbackStart_us +
+            (samplesSinceStart + n) * 1000000 / sampleRate;
+        const int64_t timeout_us = std::chrono::duration_cast<
+            std::chrono::microseconds>(timeout).count();
+        const int64_t t_to_wait = std::min(due_us - getMyTime(), timeout_us);
+        if (t_to_wait > 0) {
+            lock.unlock();
+            std::this_thread::sleep_for(std::chrono::microseconds(t_to_wait));
+        }
+    }
+
+    return getSamplesToRead();
+}
+
+bool CRAWFile::mapFile(int fd)
+{
+#ifdef _WIN32
+    (void)fd;
+    return false;
+#else
+    struct stat st;
+    if (fstat(fd, &st) != 0 or not S_ISREG(st.st_mode) or
+            st.st_size < IQByteSize) {
+        return false;
+    }
+
+    void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED) {
+        std::clog << "RAWFile: mmap failed, falling back to reader thread: " <<
+            strerror(errno) << std::endl;
+        return false;
+    }
+
+    madvise(addr, st.st_size, MADV_SEQUENTIAL);
+
+    mappedData = static_cast<const uint8_t*>(addr);
+    mappedLength = st.st_size;
+    // Ignore a trailing incomplete IQ sample
+    mappedSize = st.st_size - (st.st_size % IQByteSize);
+    mappedPos = 0;
+    std::clog << "RAWFile: mapped " << mappedSize << " bytes" << std::endl;
+    return true;
+#endif
+}
+
+void CRAWFile::unmapFile()
+{
+#ifndef _WIN32
+    if (mappedData) {
+        munmap(const_cast<uint8_t*>(mappedData), mappedLength);
+        mappedData = nullptr;
+    }
+#endif
+}
+
+int64_t CRAWFile::mappedSamplesAvailable()
+{
+    if (readerPausing)
+        return 0;
+
+    // With autoRewind, the file never runs out of samples
+    int64_t available = autoRewind ?
+        std::numeric_limits<int32_t>::max() :
+        (mappedSize - mappedPos) / IQByteSize;
+
+    if (throttle) {
+        const int64_t due = (getMyTime() - playbackStart_us) * sampleRate / 1000000;
+        available = std::min(available, std::max<int64_t>(0, due - samplesSinceStart));
+    }
+
+    return available;
+}
+
+int32_t CRAWFile::getMappedSamples(DSPCOMPLEX* V, int32_t size)
+{
+    if (throttle) {
+        // Pace the file at its sample rate: wait once until the requested
+        // samples are due instead of polling.
+        const int64_t due_us = playbackStart_us +
+            (samplesSinceStart + size) * 1000000 / sampleRate;
+        const int64_t t_to_wait = due_us - getMyTime();
+        if (t_to_wait > 0)
+            std::this_thread::sleep_for(std::chrono::microseconds(t_to_wait));
+    }
+
+    int32_t done = 0;
+    while (done < size) {
+        const int64_t pos = mappedPos;
+        const int32_t n = std::min<int64_t>(size - done,
+                (mappedSize - pos) / IQByteSize);
+
+        if (n <= 0) {
+            if (autoRewind) {
+                mappedPos = 0;
+                std::clog << "RAWFile:"  << "End of file, restarting" << std::endl;
+                radioController.onMessage(message_level_t::Information,
+                        QT_TRANSLATE_NOOP("CRadioController", "End of file, restarting"));
+                radioController.onRestartService();
+                continue;
+            }
+            else {
+                if (not endReached) {
+                    radioController.onMessage(message_level_t::Information,
+                            QT_TRANSLATE_NOOP("CRadioController", "End of file"));
+                }
+                endReached = true;
+                break;
+            }
+        }
+
+        convertRaw(mappedData + pos, V + done, n, true);
+        putIntoRecordBuffer(mappedData[pos], n * IQByteSize);
+        mappedPos = pos + (int64_t)n * IQByteSize;
+        done += n;
+    }
+
+    samplesSinceStart += done;
+    return done;
 }
 
 void CRAWFile::run(void)
@@ -253,7 +599,7 @@ void CRAWFile::run(void)
 
     ExitCondition = false;
 
-    period = (32768 * 1000) / (IQByteSize * 2048); // full IQs read
+    period = (int64_t)32768 * 1000000 / (IQByteSize * sampleRate); // full IQs read
 
     std::clog << "RAWFile" << "Period =" << period << std::endl;
     std::vector<uint8_t> bi(bufferSize);
@@ -265,20 +611,37 @@ void CRAWFile::run(void)
             continue;
         }
 
-        while (SampleBuffer.WriteSpace() < bufferSize + 10) {
-            if (ExitCondition)
-                break;
-            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        {
+            std::unique_lock<std::mutex> lock(bufferMutex);
+            spaceAvailable.wait_for(lock, std::chrono::milliseconds(100), [&]() {
+                    return SampleBuffer.WriteSpace() >= bufferSize + 10 or ExitCondition; });
         }
+        if (ExitCondition)
+            break;
+        if (SampleBuffer.WriteSpace() < bufferSize + 10)
+            continue;
 
         nextStop += period;
         t = readBuffer(bi.data(), bufferSize);
-        if (t <= 0) {
+        if (t <= 0 and endReached and not throttle) {
+            // Nobody is listening in real time, so there is no point
+            // in feeding silence after the end of the file.
+            std::lock_guard<std::mutex> lock(bufferMutex);
+            readerFinished = true;
+            dataAvailable.notify_all();
+            break;
+        }
+        else if (t <= 0) {
             for (int i = 0; i < bufferSize; i++)
                 bi[i] = 0;
             t = bufferSize;
         }
-        SampleBuffer.putDataIntoBuffer(bi.data(), t);
+        {
+            std::lock_guard<std::mutex> lock(bufferMutex);
+            const int32_t stored = SampleBuffer.putDataIntoBuffer(bi.data(), t);
+            accountSamples(t / IQByteSize, stored / IQByteSize);
+        }
+        dataAvailable.notify_one();
         SpectrumSampleBuffer.putDataIntoBuffer(bi.data(), t);
         putIntoRecordBuffer(*bi.data(), t);
         int64_t t_to_wait = nextStop - getMyTime();
@@ -289,6 +652,18 @@ void CRAWFile::run(void)
     std::clog << "RAWFile:" <<  "Read threads ends" << std::endl;
 }
 
+// The buffers are flushed by their readers, see getSamples() and
+// getSpectrumSamples()
+void CRAWFile::requestFlush()
+{
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        sampleFlushRequested = true;
+        spectrumFlushRequested = true;
+    }
+    dataAvailable.notify_all();
+}
+
 /*
  *	length is number of uints that we read.
  */
@@ -300,69 +675,94 @@ int32_t CRAWFile::readBuffer(uint8_t* data, int32_t length)
         return 0;
     }
 
-    n = fread(data, sizeof(uint8_t), length, filePointer);
+    if (container)
+        n = container->read(data, length);
+    else
+        n = fread(data, sizeof(uint8_t), length, filePointer);
     currPos += n;
     if (n < length) {
         if (autoRewind) {
-            fseek(filePointer, 0, SEEK_SET);
+            if (container)
+                container->seek(0);
+            else
+                fseek(filePointer, 0, SEEK_SET);
+            currPos = 0;
             std::clog << "RAWFile:"  << "End of file, restarting" << std::endl;
             radioController.onMessage(message_level_t::Information,
                     QT_TRANSLATE_NOOP("CRadioController", "End of file, restarting"));
-            SampleBuffer.FlushRingBuffer();
-            SpectrumSampleBuffer.FlushRingBuffer();
+            requestFlush();
             radioController.onRestartService();
         }
         else {
-            radioController.onMessage(message_level_t::Information, QT_TRANSLATE_NOOP("CRadioController", "End of file"));
+            if (not endReached) {
+                radioController.onMessage(message_level_t::Information, QT_TRANSLATE_NOOP("CRadioController", "End of file"));
+            }
             endReached = true;
-            return 0;
         }
     }
     return n & ~01;
 }
 
-int32_t CRAWFile::convertSamples(RingBuffer<uint8_t>& Buffer, DSPCOMPLEX *V, int32_t size)
+// Native endianness complex<float> requires no conversion
+static void fromComplexF(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        DSPCOMPLEX /*dcOffset*/, float /*scale*/)
+{
+    memcpy(out, in, count * sizeof(DSPCOMPLEX));
+}
+
+static iqconvert::ConvertFunction converterFor(CRAWFileFormat format)
 {
-    // Native endianness complex<float> requires no conversion
-    if (fileFormat == CRAWFileFormat::COMPLEXF) {
-        int32_t amount = Buffer.getDataFromBuffer(V, IQByteSize * size);
-        return amount / IQByteSize;
+    switch (format) {
+        case CRAWFileFormat::U8: return iqconvert::fromU8;
+        case CRAWFileFormat::S8: return iqconvert::fromS8;
+        case CRAWFileFormat::S16LE: return iqconvert::fromS16LE;
+        case CRAWFileFormat::S16BE: return iqconvert::fromS16BE;
+        case CRAWFileFormat::COMPLEXF: return fromComplexF;
+        case CRAWFileFormat::Unknown: break;
     }
+    return nullptr;
+}
 
-    std::vector<uint8_t> temp((size_t)IQByteSize * (size_t)size);
+// Without a correcting variant for cf32, these files are never corrected
+static iqconvert::CorrectedConvertFunction correctedConverterFor(CRAWFileFormat format)
+{
+    switch (format) {
+        case CRAWFileFormat::U8: return iqconvert::fromU8;
+        case CRAWFileFormat::S8: return iqconvert::fromS8;
+        case CRAWFileFormat::S16LE: return iqconvert::fromS16LE;
+        case CRAWFileFormat::S16BE: return iqconvert::fromS16BE;
+        case CRAWFileFormat::COMPLEXF: break;
+        case CRAWFileFormat::Unknown: break;
+    }
+    return nullptr;
+}
 
-    int32_t amount = Buffer.getDataFromBuffer(temp.data(), IQByteSize * size);
+int32_t CRAWFile::convertSamples(RingBuffer<uint8_t>& Buffer, DSPCOMPLEX *V, int32_t size,
+        bool correct)
+{
+    const auto corrected = correctedConverterFor(fileFormat);
+    if (correct and corrected and iqCorrector.isEnabled())
+        return iqCorrector.fromRingBuffer(Buffer, V, size, IQByteSize, corrected);
 
-    // Unsigned 8-bit
-    if (fileFormat == CRAWFileFormat::U8) {
-        for (int i = 0; i < amount / 2; i++)
-            V[i] = DSPCOMPLEX(float(temp[2 * i] - 128) / 128.0,
-                              float(temp[2 * i + 1] - 128) / 128.0);
-    }
-    // Signed 8-bit
-    else if (fileFormat == CRAWFileFormat::S8) {
-        for (int i = 0; i < amount / 2; i++)
-            V[i] = DSPCOMPLEX(float((int8_t)temp[2 * i]) / 128.0,
-                              float((int8_t)temp[2 * i + 1]) / 128.0);
-    }
-    // Signed 16-bit little endian
-    else if (fileFormat == CRAWFileFormat::S16LE) {
-        for (int i = 0, j = 0; i < amount / 4; i++, j+= IQByteSize) {
-            int16_t IQ_I = (int16_t)(temp[j + 0] << 8) | temp[j + 1];
-            int16_t IQ_Q = (int16_t)(temp[j + 2] << 8) | temp[j + 3];
-            V[i] = DSPCOMPLEX((float)(IQ_I), (float)(IQ_Q));
-        }
-    }
-    // Signed 16-bit big endian
-    else if (fileFormat == CRAWFileFormat::S16BE) {
-        for (int i = 0, j = 0; i < amount / 4; i++, j += IQByteSize) {
-            int16_t IQ_I = (int16_t)(temp[j + 1] << 8) | temp[j + 0];
-            int16_t IQ_Q = (int16_t)(temp[j + 3] << 8) | temp[j + 2];
-            V[i] = DSPCOMPLEX((float)(IQ_I), (float)(IQ_Q));
-        }
+    const auto convert = converterFor(fileFormat);
+    if (not convert)
+        return 0;
+
+    return iqconvert::fromRingBuffer(Buffer, V, size, IQByteSize, convert);
+}
+
+//	size is in I/Q pairs, data holds size * IQByteSize bytes
+void CRAWFile::convertRaw(const uint8_t* data, DSPCOMPLEX* V, int32_t size, bool correct)
+{
+    const auto corrected = correctedConverterFor(fileFormat);
+    if (correct and corrected and iqCorrector.isEnabled()) {
+        iqCorrector.convert(corrected, data, V, size);
+        return;
     }
 
-    return amount / IQByteSize;
+    const auto convert = converterFor(fileFormat);
+    if (convert)
+        convert(data, V, size, DSPCOMPLEX(0, 0), 1.0f);
 }
 
 void CRAWFile::setFileFormat(const std::string &fileFormat)
@@ -376,21 +776,30 @@ void CRAWFile::setFileFormat(const std::string &fileFormat)
             (fileFormat == "auto" and ends_with(fileName, ".s8.iq"))) {
         this->fileFormat = CRAWFileFormat::S8;
         IQByteSize = 2;
+        recordFormat = "s8";
     }
     else if(fileFormat == "s16le" or
             (fileFormat == "auto" and ends_with(fileName, ".s16le.iq"))) {
         this->fileFormat = CRAWFileFormat::S16LE;
         IQByteSize = 4;
+        recordFormat = "s16le";
     }
     else if(fileFormat == "s16be" or
             (fileFormat == "auto" and ends_with(fileName, ".s16be.iq"))) {
         this->fileFormat = CRAWFileFormat::S16BE;
         IQByteSize = 4;
+        recordFormat = "s16be";
+    }
+    else if (isContainer(fileFormat, fileName)) {
+        // The actual format is taken from the container header
+        this->fileFormat = CRAWFileFormat::U8;
+        IQByteSize = 2;
     }
     else if(fileFormat == "cf32" or
             (fileFormat == "auto" and ends_with(fileName, ".cf32.iq"))) {
         this->fileFormat = CRAWFileFormat::COMPLEXF;
         IQByteSize = 8;
+        recordFormat = "cf32";
     }
     else if (fileFormat == "auto") {
         // Default to u8 for backward compatibility
@@ -35,10 +35,15 @@
 
 #include <thread>
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
 
 #include "virtual_input.h"
 #include "dab-constants.h"
 #include "ringbuffer.h"
+#include "iq_container.h"
+#include "iq_corrector.h"
 #include "radio-controller.h"
 
 // Enum of available input device
@@ -57,8 +62,10 @@ public:
     int32_t getSamples(DSPCOMPLEX*, int32_t);
     std::vector<DSPCOMPLEX> getSpectrumSamples(int size);
     int32_t getSamplesToRead(void);
+    int32_t waitForSamples(int32_t n, std::chrono::milliseconds timeout);
     bool restart(void);
     bool is_ok(void);
+    bool endOfInput(void);
     void stop(void);
     void reset(void);
     void rewind(void);
@@ -68,12 +75,20 @@ public:
     void setAgc(bool AGC);
     std::string getDescription(void);
     CDeviceID getID(void);
+    bool setDeviceParam(DeviceParam param, int value);
+    IQCorrectionStats getIQCorrection(void);
 
     // Specific methods
     void setFileName(const std::string& FileName, const std::string& FileFormat);
     void setFileHandle(int handle, const std::string& fileFormat);
     std::string getFileName(void) const;
 
+    // Random access, O(1) for memory-mapped files and compressed
+    // containers. Positions are in IQ samples from the start of the file.
+    bool seek(int64_t samplePosition);
+    int64_t getSamplePosition(void) const;
+    int64_t getNumSamples(void) const;
+
     bool endWasReached() const { return endReached; }
 
 private:
@@ -83,21 +98,60 @@ private:
     std::string fileName;
     CRAWFileFormat fileFormat;
     uint8_t IQByteSize = 2;
+    // Rate of the samples in the file, at which it is played back
+    uint32_t sampleRate = INPUT_RATE;
+    IQCorrector iqCorrector;
 
     void run(void);
     int32_t readBuffer(uint8_t*, int32_t);
-    int32_t convertSamples(RingBuffer<uint8_t>& Buffer, DSPCOMPLEX* V, int32_t size);
+    void requestFlush();
+    // With correct set, the samples go through iqCorrector if enabled
+    int32_t convertSamples(RingBuffer<uint8_t>& Buffer, DSPCOMPLEX* V, int32_t size,
+            bool correct = false);
+    void convertRaw(const uint8_t* data, DSPCOMPLEX* V, int32_t size,
+            bool correct = false);
     void setFileFormat(const std::string& fileFormat);
+    bool openContainer(void);
+
+    // Memory-mapped mode: samples are converted straight from the mapped
+    // pages, without reader thread and ring buffer.
+    bool mapFile(int fd);
+    void unmapFile(void);
+    int32_t getMappedSamples(DSPCOMPLEX* V, int32_t size);
+    int64_t mappedSamplesAvailable(void);
 
     RingBuffer<uint8_t> SampleBuffer;
     RingBuffer<uint8_t> SpectrumSampleBuffer;
     FILE* filePointer = nullptr;
+    // Set for compressed IQ containers, which are decoded by the
+    // reader thread
+    std::unique_ptr<IQContainerReader> container;
     bool readerOK = false;
     bool readerPausing = false;
-    bool endReached = false;
+    std::atomic<bool> endReached = ATOMIC_VAR_INIT(false);
     std::atomic<bool> ExitCondition = ATOMIC_VAR_INIT(false);
+    std::atomic<bool> readerFinished = ATOMIC_VAR_INIT(false);
+    // Flushing moves the read index, so it is left to the consumers of
+    // the two buffers when the file is rewound or seeked.
+    std::atomic<bool> sampleFlushRequested = ATOMIC_VAR_INIT(false);
+    std::atomic<bool> spectrumFlushRequested = ATOMIC_VAR_INIT(false);
     int64_t currPos = 0;
 
+    // Handshake between the reader thread and getSamples(), so that
+    // neither side has to poll the ring buffer.
+    std::mutex bufferMutex;
+    std::condition_variable dataAvailable;
+    std::condition_variable spaceAvailable;
+
+    const uint8_t* mappedData = nullptr;
+    size_t mappedLength = 0;
+    int64_t mappedSize = 0;
+    std::atomic<int64_t> mappedPos = ATOMIC_VAR_INIT(0);
+    // Throttling reference for the mapped mode: number of samples
+    // delivered since the wall clock time playbackStart_us.
+    std::atomic<int64_t> playbackStart_us = ATOMIC_VAR_INIT(0);
+    std::atomic<int64_t> samplesSinceStart = ATOMIC_VAR_INIT(0);
+
     std::thread thread;
 };
 
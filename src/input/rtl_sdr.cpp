@@ -34,6 +34,7 @@
 #include <exception>
 
 #include "rtl_sdr.h"
+#include "iq_convert.h"
 
 // For Qt translation if Qt is existing
 #ifdef QT_CORE_LIB
@@ -55,10 +56,12 @@ int __attribute__((weak)) rtlsdr_set_bias_tee(rtlsdr_dev_t *dev, int on)
 
 CRTL_SDR::CRTL_SDR(RadioControllerInterface& radioController) :
     radioController(radioController),
+    agc(AgcSettings::rtl2832()),
     sampleBuffer(1024 * 1024),
     spectrumSampleBuffer(8192)
 {
     open_device();
+    gainThread = std::thread(&CRTL_SDR::gainThreadLoop, this);
 }
 
 void CRTL_SDR::open_device()
@@ -121,6 +124,13 @@ CRTL_SDR::~CRTL_SDR(void)
 {
     stop();
 
+    {
+        std::lock_guard<std::mutex> lock(gainMutex);
+        gainThreadRunning = false;
+    }
+    gainRequested.notify_one();
+    gainThread.join();
+
     rtlsdr_close(device);
 }
 
@@ -163,8 +173,8 @@ bool CRTL_SDR::restart(void)
     rtlsdr_set_center_freq(device, frequency + frequencyOffset);
     rtlsdrRunning = true;
 
+    agc.reset();
     rtlsdrThread = std::thread(&CRTL_SDR::rtlsdr_read_async_wrapper, this);
-    agcThread = std::thread(&CRTL_SDR::agc_timer_thread, this);
 
     return true;
 }
@@ -181,10 +191,6 @@ void CRTL_SDR::stop(void)
 
     rtlsdrRunning = false;
 
-    if (agcThread.joinable()) {
-        agcThread.join();
-    }
-
     rtlsdr_cancel_async(device);
     if (rtlsdrThread.joinable()) {
         rtlsdrThread.join();
@@ -203,6 +209,13 @@ float CRTL_SDR::setGain(int gain_index)
         return 0;
     }
 
+    applyGain(gain_index);
+    return currentGain / 10.0;
+}
+
+void CRTL_SDR::applyGain(int gain_index)
+{
+    std::lock_guard<std::mutex> lock(deviceGainMutex);
     currentGainIndex = gain_index;
     currentGain = gains[gain_index];
 
@@ -212,8 +225,33 @@ float CRTL_SDR::setGain(int gain_index)
     if (ret != 0) {
         std::clog << "RTL_SDR: " << "Setting gain failed" << std::endl;
     }
+}
 
-    return currentGain / 10.0;
+// Called from getSamples(), returns without waiting for the device
+void CRTL_SDR::requestGain(int gain_index)
+{
+    {
+        std::lock_guard<std::mutex> lock(gainMutex);
+        requestedGainIndex = gain_index;
+    }
+    gainRequested.notify_one();
+}
+
+void CRTL_SDR::gainThreadLoop(void)
+{
+    std::unique_lock<std::mutex> lock(gainMutex);
+    while (true) {
+        gainRequested.wait(lock, [this]() {
+                return requestedGainIndex >= 0 or not gainThreadRunning; });
+        if (not gainThreadRunning)
+            break;
+
+        const int gain_index = requestedGainIndex;
+        requestedGainIndex = -1;
+        lock.unlock();
+        applyGain(gain_index);
+        lock.lock();
+    }
 }
 
 int CRTL_SDR::getGainCount()
@@ -242,12 +280,22 @@ bool CRTL_SDR::setDeviceParam(DeviceParam param, int value)
         }
         return true;
 
+        case DeviceParam::IQCorrection:
+            std::clog << "RTL_SDR: "<< "Set IQ correction to " << value << std::endl;
+            iqCorrector.setEnabled(value);
+            return true;
+
         default: std::runtime_error("Unsupported device parameter");
     }
 
     return false;
 }
 
+IQCorrectionStats CRTL_SDR::getIQCorrection()
+{
+    return iqCorrector.getStats();
+}
+
 std::string CRTL_SDR::getDescription()
 {
     char manufact[256] = {0};
@@ -270,80 +318,64 @@ CDeviceID CRTL_SDR::getID()
     return CDeviceID::RTL_SDR;
 }
 
-void CRTL_SDR::agc_timer_thread(void)
+void CRTL_SDR::updateGain(void)
 {
-    while (rtlsdrRunning && not rtlsdrUnplugged) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-
-        if (isAGC) {
-            // Check for overloading
-            if (minAmplitude == 0 || maxAmplitude == 255) {
-                // We have to decrease the gain
-                if (currentGainIndex > 0) {
-                    setGain(currentGainIndex - 1);
-                    //std::clog << "RTL_SDR: " << "Decreased gain to " << (float)currentGain / 10.0f << std::endl;
-                }
-            }
-            else {
-                if (currentGainIndex < ((ssize_t)gains.size() - 1)) {
-                    // Calc if a gain increase overloads the device. Calc it from the gain values
-                    int NewGain = gains[currentGainIndex + 1];
-                    float DeltaGain = ((float) NewGain / 10) - ((float) currentGain / 10);
-                    float LinGain = pow(10, DeltaGain / 20);
-
-                    int NewMaxValue = (float) maxAmplitude * LinGain;
-                    int NewMinValue = (float) minAmplitude / LinGain;
-
-                    // We have to increase the gain
-                    if(NewMinValue >= 0 && NewMaxValue <= 255) {
-                        setGain(currentGainIndex + 1);
-                        //std::clog << "RTL_SDR: " << "Increased gain to " << (float) currentGain / 10 << std::endl;
-                    }
-                }
-            }
-        }
-        else { // AGC is off
-            if (minAmplitude == 0 || maxAmplitude == 255) {
-                std::string Text = QT_TRANSLATE_NOOP("CRadioController", "ADC overload. Maybe you are using a too high gain.");
-                std::clog << "RTL_SDR: " << Text << std::endl;
-                radioController.onMessage(message_level_t::Information, Text);
-            }
+    int gain_index = currentGainIndex;
+    const bool atMaximum = gain_index + 1 >= (int)gains.size();
+    const float stepUp = atMaximum ? 0 :
+        (gains[gain_index + 1] - gains[gain_index]) / 10.0f;
+    const AgcStep step = agc.decide(stepUp);
+
+    if (not isAGC) {
+        if (agc.clippingStarted()) {
+            std::string Text = QT_TRANSLATE_NOOP("CRadioController", "ADC overload. Maybe you are using a too high gain.");
+            std::clog << "RTL_SDR: " << Text << std::endl;
+            radioController.onMessage(message_level_t::Information, Text);
         }
+        return;
+    }
+
+    if (step == AgcStep::Down and gain_index > 0) {
+        gain_index--;
     }
+    else if (step == AgcStep::Up and not atMaximum) {
+        gain_index++;
+    }
+    else {
+        return;
+    }
+
+    requestGain(gain_index);
+    agc.gainChanged(getSamplesToRead());
 }
 
 int32_t CRTL_SDR::getSamples(DSPCOMPLEX *buffer, int32_t size)
 {
-    std::vector<uint8_t> tempBuffer(2 * size);
-
-    int32_t amount = sampleBuffer.getDataFromBuffer(tempBuffer.data(), 2 * size);
-
-    // Normalise samples
-    for (int i = 0; i < amount / 2; i++) {
-        buffer[i] = DSPCOMPLEX(
-                (float(tempBuffer[2 * i] - 128)) / 128.0,
-                (float(tempBuffer[2 * i + 1] - 128)) / 128.0);
+    // The AGC counts the codes of the ADC, before the IQ corrector
+    // has moved the clipped ones
+    const auto regions = sampleBuffer.acquireRead(size * 2);
+    size = regions.size() / 2;
+    bool decide = agc.addU8(regions.first.data, regions.first.size / 2);
+    decide = agc.addU8(regions.second.data, regions.second.size / 2) or decide;
+
+    const int32_t amount = iqCorrector.isEnabled() ?
+        iqCorrector.fromRingBuffer(sampleBuffer, buffer, size, 2, iqconvert::fromU8) :
+        iqconvert::fromRingBuffer(sampleBuffer, buffer, size, 2, iqconvert::fromU8);
+
+    if (decide) {
+        updateGain();
     }
 
-    return amount / 2;
+    return amount;
 }
 
 std::vector<DSPCOMPLEX> CRTL_SDR::getSpectrumSamples(int size)
 {
-    std::vector<uint8_t> tempBuffer(2 * size);
-
-    // Get samples
-    int32_t amount = spectrumSampleBuffer.getDataFromBuffer(
-            tempBuffer.data(), 2 * size);
+    std::vector<DSPCOMPLEX> buffer(size);
 
-    std::vector<DSPCOMPLEX> buffer(amount / 2);
-
-    // Convert samples into generic format
-    for (int i = 0; i < amount / 2; i++) {
-        buffer[i] = DSPCOMPLEX(
-                (float(tempBuffer[2 * i] - 128)) / 128.0,
-                (float(tempBuffer[2 * i + 1] - 128)) / 128.0);
-    }
+    int32_t amount = iqconvert::fromRingBuffer(spectrumSampleBuffer,
+            buffer.data(), size, 2, iqconvert::fromU8);
+    buffer.resize(amount);
 
     return buffer;
 }
@@ -369,23 +401,12 @@ void CRTL_SDR::rtlsdr_read_callback(uint8_t* buf, uint32_t len, void* ctx)
         }
 
         int32_t tmp = rtlsdr->sampleBuffer.putDataIntoBuffer(buf, len);
-        if ((len - tmp) > 0)
-            rtlsdr->sampleCounter += len - tmp;
+        rtlsdr->accountSamples(len / 2, tmp / 2);
+
+        rtlsdr->notifySamplesAvailable();
 
         rtlsdr->spectrumSampleBuffer.putDataIntoBuffer(buf, len);
         rtlsdr->putIntoRecordBuffer(*buf, len);
-
-        // Check if device is overloaded
-        rtlsdr->minAmplitude = 255;
-        rtlsdr->maxAmplitude = 0;
-
-        for (uint32_t i=0;i<len;i++) {
-            if (rtlsdr->minAmplitude > buf[i])
-                rtlsdr->minAmplitude = buf[i];
-
-            if (rtlsdr->maxAmplitude < buf[i])
-                rtlsdr->maxAmplitude = buf[i];
-        }
     }
     else {
         std::clog << "RTL_SDR: " << "ERROR no ctx in RTLSDR callback" << std::endl;
@@ -37,6 +37,8 @@
 #include <thread>
 #include <string>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <rtl-sdr.h>
 
 #include "virtual_input.h"
@@ -44,6 +46,8 @@
 #include "MathHelper.h"
 #include "ringbuffer.h"
 #include "radio-controller.h"
+#include "histogram_agc.h"
+#include "iq_corrector.h"
 
 // This class is a simple wrapper around the
 // rtlsdr library that is read is as dll
@@ -71,15 +75,15 @@ public:
     void setAgc(bool AGC);
     std::string getDescription(void);
     bool setDeviceParam(DeviceParam param, int value);
+    IQCorrectionStats getIQCorrection(void);
 
     CDeviceID getID(void);
 
 private:
-    std::thread agcThread;
     RadioControllerInterface& radioController;
     int frequency = kHz(174928);
     int frequencyOffset = 0;
-    int currentGain = 0;
+    std::atomic<int> currentGain = ATOMIC_VAR_INIT(0);
     bool isAGC = false;
     bool isHwAGC = false;
     std::thread rtlsdrThread;
@@ -88,16 +92,32 @@ private:
     std::atomic<bool> rtlsdrUnplugged = ATOMIC_VAR_INIT(false);
 
     std::vector<int> gains;
-    int currentGainIndex = 0;
-    uint8_t minAmplitude = 255;
-    uint8_t maxAmplitude = 0;
+    std::atomic<int> currentGainIndex = ATOMIC_VAR_INIT(0);
 
-    void agc_timer_thread(void);
+    // The gain steps of the AGC are set by gainThread, so that
+    // getSamples() never waits for a USB control transfer
+    std::thread gainThread;
+    std::mutex gainMutex;
+    std::condition_variable gainRequested;
+    int requestedGainIndex = -1;    // Guarded by gainMutex
+    bool gainThreadRunning = true;  // Guarded by gainMutex
+    void gainThreadLoop(void);
+    void requestGain(int gain_index);
+
+    // Serialises the gain calls to the device
+    std::mutex deviceGainMutex;
+    void applyGain(int gain_index);
+
+    // Runs on the codes read in getSamples(), before any correction
+    HistogramAgc agc;
+    void updateGain(void);
+
+    // The DC offset and the IQ imbalance of the zero-IF tuners
+    IQCorrector iqCorrector;
 
     RingBuffer<uint8_t> sampleBuffer;
     RingBuffer<uint8_t> spectrumSampleBuffer;
     struct rtlsdr_dev *device = nullptr;
-    int32_t sampleCounter = 0;
 
     static void rtlsdr_read_callback(uint8_t* buf, uint32_t len, void *ctx);
     void open_device();
@@ -30,10 +30,11 @@
  *
  */
 
+#include <algorithm>
 #include <iostream>
-#include <sys/time.h>
 
 #include "rtl_tcp.h"
+#include "iq_convert.h"
 
 // For Qt translation if Qt is existing
 #ifdef QT_CORE_LIB
@@ -42,14 +43,6 @@
     #define QT_TRANSLATE_NOOP(x,y) (y)
 #endif
 
-// commands are packed in 5 bytes, one "command byte"
-// and an integer parameter
-struct command
-{
-    unsigned char cmd;
-    unsigned int param;
-}__attribute__((packed));
-
 enum rtlsdr_tuner {
     RTLSDR_TUNER_UNKNOWN = 0,
     RTLSDR_TUNER_E4000,
@@ -62,22 +55,32 @@ enum rtlsdr_tuner {
 
 #define ONE_BYTE 8
 
-static inline int64_t getMyTime(void)
-{
-    struct timeval tv;
+// The sample buffer holds 2 s of signal; it is also the jitter buffer
+static const uint32_t sampleBufferSize = 256 * 32768;
 
-    gettimeofday(&tv, NULL);
-    return ((int64_t)tv.tv_sec * 1000000 + (int64_t)tv.tv_usec);
-}
+// Let the kernel buffer a lot more than the default, so that TCP keeps
+// the data flowing while the decoder is busy
+static const int socketReceiveBufferSize = 4 * 1024 * 1024;
+
+// Largest amount of data handed to a single recv()
+static const size_t receiveChunkSize = 65536;
+
+// recv() returns at least this often, to check if we have to stop
+static const int receiveTimeout_ms = 100;
+
+static const auto defaultJitterBuffer = std::chrono::milliseconds(250);
 
 CRTL_TCP_Client::CRTL_TCP_Client(RadioControllerInterface& radioController) :
     radioController(radioController),
-    sampleBuffer(32 * 32768),
-    sampleNetworkBuffer(256 * 32768),
-    spectrumSampleBuffer(8192)
+    sampleBuffer(sampleBufferSize),
+    spectrumSampleBuffer(8192),
+    agc(AgcSettings::rtl2832()),
+    overrunBuffer(receiveChunkSize)
 {
     memset(&dongleInfo, 0, sizeof(dongle_info_t));
     dongleInfo.tuner_type = RTLSDR_TUNER_UNKNOWN;
+    sock.setReceiveBufferSize(socketReceiveBufferSize);
+    setJitterBuffer(defaultJitterBuffer);
 }
 
 CRTL_TCP_Client::~CRTL_TCP_Client(void)
@@ -103,13 +106,14 @@ bool CRTL_TCP_Client::restart(void)
         return true;
     }
 
-    rtlsdrRunning = true;
+    // The threads of a previous run may have ended by themselves
+    if (receiveThread.joinable()) {
+        receiveThread.join();
+    }
 
-    networkBufferThread = std::thread(&CRTL_TCP_Client::networkBufferCopy, this);
-    networkBufferThread.detach();
+    rtlsdrRunning = true;
 
     receiveThread = std::thread(&CRTL_TCP_Client::receiveAndReconnect, this);
-    receiveThread.detach();
 
     // Wait so that the other thread has a chance to establish the connection
     std::this_thread::sleep_for(std::chrono::milliseconds(500));
@@ -127,57 +131,75 @@ void CRTL_TCP_Client::stop(void)
 {
 #ifdef __ANDROID__
     // Send TCP_ANDROID_EXIT cmd to explicitly cause the driver to turn off itself
-    sendCommand(0x7e, 0);
+    sendCommand(RtlTcpCommand::AndroidExit, 0);
 #endif
 
     std::unique_lock<std::mutex> lock(mutex);
-
-    // Close connection
-    sock.close();
-
-    agcRunning = false;
     rtlsdrRunning = false;
-
     lock.unlock();
 
-    if (agcThread.joinable()) {
-        agcThread.join();
-    }
-
+    // The receive thread wakes up at least every receiveTimeout_ms
     if (receiveThread.joinable()) {
         receiveThread.join();
     }
 
-    if (networkBufferThread.joinable()) {
-        networkBufferThread.join();
-    }
-
+    // Close connection
+    lock.lock();
+    sock.close();
     connected = false;
+
+    if (wasConnected) {
+        const auto stats = getStats();
+        std::clog << "RTL_TCP_CLIENT: Received " << stats.bytesReceived <<
+            " bytes, " << stats.overruns << " overruns, " <<
+            stats.reconnects << " reconnects" << std::endl;
+    }
 }
 
 static int32_t read_convert_from_buffer(
         RingBuffer<uint8_t>& buffer,
         DSPCOMPLEX *v, int32_t size)
 {
-    int32_t amount, i;
-    std::vector<uint8_t> tempBuffer(2 * size);
-
-    // Get data from the ring buffer
-    amount = buffer.getDataFromBuffer(tempBuffer.data(), 2 * size);
-    for (i = 0; i < amount / 2; i ++)
-        v[i] = DSPCOMPLEX(((float)tempBuffer[2 * i] - 128.0f) / 128.0f,
-                          ((float)tempBuffer[2 * i + 1] - 128.0f) / 128.0f);
-    return amount / 2;
+    return iqconvert::fromRingBuffer(buffer, v, size, 2, iqconvert::fromU8);
 }
 
 int32_t CRTL_TCP_Client::getSamples(DSPCOMPLEX *v, int32_t size)
 {
-    return read_convert_from_buffer(sampleBuffer, v, size);
+    flushIfRequested();
+
+    if (not jitterBufferFilled) {
+        return 0;
+    }
+
+    // The AGC counts the codes of the ADC, before the IQ corrector
+    // has moved the clipped ones. A sample split by the end of the
+    // buffer is left out.
+    const auto regions = sampleBuffer.acquireRead(size * 2);
+    size = regions.size() / 2;
+    bool decide = agc.addU8(regions.first.data, regions.first.size / 2);
+    const int32_t split = regions.first.size % 2;
+    decide = agc.addU8(regions.second.data + split,
+            std::max(regions.second.size - split, 0) / 2) or decide;
+
+    const int32_t amount = iqCorrector.isEnabled() ?
+        iqCorrector.fromRingBuffer(sampleBuffer, v, size, 2, iqconvert::fromU8) :
+        read_convert_from_buffer(sampleBuffer, v, size);
+
+    if (decide) {
+        updateGain();
+    }
+
+    return amount;
 }
 
 std::vector<DSPCOMPLEX> CRTL_TCP_Client::getSpectrumSamples(int size)
 {
     std::vector<DSPCOMPLEX> buffer(size);
+
+    if (spectrumFlushRequested.exchange(false)) {
+        spectrumSampleBuffer.FlushRingBuffer();
+    }
+
     int sizeRead = read_convert_from_buffer(spectrumSampleBuffer, buffer.data(), size);
     if (sizeRead < size) {
         buffer.resize(sizeRead);
@@ -187,140 +209,191 @@ std::vector<DSPCOMPLEX> CRTL_TCP_Client::getSpectrumSamples(int size)
 
 int32_t CRTL_TCP_Client::getSamplesToRead(void)
 {
+    flushIfRequested();
+
+    if (not jitterBufferFilled) {
+        return 0;
+    }
+
     return sampleBuffer.GetRingBufferReadAvailable() / 2;
 }
 
+// Also called by the network thread on reconnection, so the buffers are
+// only flushed by their readers, see flushIfRequested()
 void CRTL_TCP_Client::reset(void)
 {
-    sampleBuffer.FlushRingBuffer();
-    sampleNetworkBuffer.FlushRingBuffer();
-    spectrumSampleBuffer.FlushRingBuffer();
-    firstFilledNetworkBuffer = false;
+    jitterBufferFilled = false;
+    sampleFlushRequested = true;
+    spectrumFlushRequested = true;
 }
 
-void CRTL_TCP_Client::receiveData(void)
+void CRTL_TCP_Client::flushIfRequested(void)
 {
-    std::vector<uint8_t> buffer(8192);
-
-    size_t read = 0;
-
-    while (sock.valid() && read < buffer.size()) {
-        const size_t remain = buffer.size() - read;
+    if (sampleFlushRequested.exchange(false)) {
+        sampleBuffer.FlushRingBuffer();
+    }
+}
 
-        ssize_t ret = sock.recv(buffer.data() + read, remain, 0);
+ssize_t CRTL_TCP_Client::receive(void *buffer, size_t length)
+{
+    ssize_t ret = sock.recv(buffer, length, 0);
 
-        if (ret == 0) {
+    if (ret == 0) {
+        handleDisconnect();
+    }
+    else if (ret == -1) {
+#if defined(_WIN32)
+        if (WSAGetLastError() == WSAEINTR ||
+                WSAGetLastError() == WSAETIMEDOUT ||
+                WSAGetLastError() == WSAECONNABORTED ||
+                WSAGetLastError() == WSAENOTSOCK) {
+            return 0;
+        }
+        else if (WSAGetLastError() == WSAECONNRESET || WSAGetLastError() == WSAEBADF) {
             handleDisconnect();
         }
-        else if (ret == -1) {
-#if defined(_WIN32)
-            if (WSAGetLastError() == WSAEINTR ||
-                    WSAGetLastError() == WSAECONNABORTED ||
-                    WSAGetLastError() == WSAENOTSOCK) {
-                continue;
-            }
-            else if (WSAGetLastError() == WSAECONNRESET || WSAGetLastError() == WSAEBADF) {
-                handleDisconnect();
-            }
-            else {
-                std::wstring s;
-                int error = WSAGetLastError();
-                throw std::runtime_error("RTL_TCP_CLIENT recv error: " +  std::to_string(error));
-            }
+        else {
+            std::wstring s;
+            int error = WSAGetLastError();
+            throw std::runtime_error("RTL_TCP_CLIENT recv error: " +  std::to_string(error));
+        }
 #else
-            if (errno == EAGAIN) {
-                continue;
-            }
-            else if (errno == EINTR) {
-                continue;
-            }
-            else if (errno == ECONNRESET || errno == EBADF) {
-                handleDisconnect();
-            }
-            else {
-                std::string errstr = strerror(errno);
-                throw std::runtime_error("RTL_TCP_CLIENT recv error: " + errstr);
-            }
-#endif
+        if (errno == EAGAIN or errno == EWOULDBLOCK) {
+            return 0;
+        }
+        else if (errno == EINTR) {
+            return 0;
+        }
+        else if (errno == ECONNRESET || errno == EBADF) {
+            handleDisconnect();
         }
         else {
-            read += ret;
+            std::string errstr = strerror(errno);
+            throw std::runtime_error("RTL_TCP_CLIENT recv error: " + errstr);
         }
+#endif
+        return 0;
+    }
+
+    return ret;
+}
+
+bool CRTL_TCP_Client::receiveDongleInfo(void)
+{
+    // rtl_tcp sends the dongle information once, before the samples
+    uint8_t *info = reinterpret_cast<uint8_t*>(&dongleInfo);
+    size_t read = 0;
+
+    while (sock.valid() and read < sizeof(dongle_info_t)) {
+        read += receive(info + read, sizeof(dongle_info_t) - read);
 
         if (not rtlsdrRunning) {
-            break;
+            return false;
         }
     }
 
-    if (firstData) {
-        firstData = false;
+    if (read < sizeof(dongle_info_t)) {
+        return false;
+    }
 
-        // Get dongle information
-        ::memcpy(&dongleInfo, buffer.data(), sizeof(dongle_info_t));
-
-        // Convert the byte order
-        dongleInfo.tuner_type = ntohl(dongleInfo.tuner_type);
-        dongleInfo.tuner_gain_count = ntohl(dongleInfo.tuner_gain_count);
-
-        if(dongleInfo.magic[0] == 'R' &&
-                dongleInfo.magic[1] == 'T' &&
-                dongleInfo.magic[2] == 'L' &&
-                dongleInfo.magic[3] == '0') {
-            std::string TunerType;
-            switch(dongleInfo.tuner_type)
-            {
-                case RTLSDR_TUNER_UNKNOWN: TunerType = "Unknown"; break;
-                case RTLSDR_TUNER_E4000: TunerType = "E4000"; break;
-                case RTLSDR_TUNER_FC0012: TunerType = "FC0012"; break;
-                case RTLSDR_TUNER_FC0013: TunerType = "FC0013"; break;
-                case RTLSDR_TUNER_FC2580: TunerType = "FC2580"; break;
-                case RTLSDR_TUNER_R820T: TunerType = "R820T"; break;
-                case RTLSDR_TUNER_R828D: TunerType = "R828D"; break;
-                default: TunerType = "Unknown";
-            }
-            std::clog << "RTL_TCP_CLIENT: Tuner type: " <<
-                dongleInfo.tuner_type << " " << TunerType << std::endl;
-            std::clog << "RTL_TCP_CLIENT: Tuner gain count: " <<
-                dongleInfo.tuner_gain_count << std::endl;
-            
-            // Always use manual gain, the AGC is implemented in software
-            setGainMode(1);
-            setGain(currentGainCount);
-            sendRate(INPUT_RATE);
-            sendVFO(frequency);  
+    // Convert the byte order
+    dongleInfo.tuner_type = ntohl(dongleInfo.tuner_type);
+    dongleInfo.tuner_gain_count = ntohl(dongleInfo.tuner_gain_count);
+
+    if(dongleInfo.magic[0] == 'R' &&
+            dongleInfo.magic[1] == 'T' &&
+            dongleInfo.magic[2] == 'L' &&
+            dongleInfo.magic[3] == '0') {
+        std::string TunerType;
+        switch(dongleInfo.tuner_type)
+        {
+            case RTLSDR_TUNER_UNKNOWN: TunerType = "Unknown"; break;
+            case RTLSDR_TUNER_E4000: TunerType = "E4000"; break;
+            case RTLSDR_TUNER_FC0012: TunerType = "FC0012"; break;
+            case RTLSDR_TUNER_FC0013: TunerType = "FC0013"; break;
+            case RTLSDR_TUNER_FC2580: TunerType = "FC2580"; break;
+            case RTLSDR_TUNER_R820T: TunerType = "R820T"; break;
+            case RTLSDR_TUNER_R828D: TunerType = "R828D"; break;
+            default: TunerType = "Unknown";
         }
-        else {
-            std::clog << "RTL_TCP_CLIENT: Didn't find the \"RTL0\" magic key." <<
-                std::endl;
+        std::clog << "RTL_TCP_CLIENT: Tuner type: " <<
+            dongleInfo.tuner_type << " " << TunerType << std::endl;
+        std::clog << "RTL_TCP_CLIENT: Tuner gain count: " <<
+            dongleInfo.tuner_gain_count << std::endl;
+        
+        // Always use manual gain, the AGC is implemented in software
+        setGainMode(1);
+        setGain(currentGainCount);
+        sendRate(INPUT_RATE);
+        sendVFO(frequency);  
+    }
+    else {
+        std::clog << "RTL_TCP_CLIENT: Didn't find the \"RTL0\" magic key." <<
+            std::endl;
+    }
+
+    return true;
+}
+
+void CRTL_TCP_Client::receiveData(void)
+{
+    if (firstData) {
+        if (not receiveDongleInfo()) {
+            return;
         }
+        firstData = false;
+    }
+
+    // Receive straight into the sample buffer. If the decoder does not
+    // keep up and the buffer is full, drain the socket into
+    // overrunBuffer and drop the data. An odd number of dropped bytes
+    // would swap I and Q, so one more byte gets dropped in that case.
+    auto regions = sampleBuffer.acquireWrite(receiveChunkSize);
+    const bool drop = skipOddByte or regions.first.size == 0;
+
+    uint8_t *data = regions.first.data;
+    size_t length = regions.first.size;
+    if (drop) {
+        data = overrunBuffer.data();
+        length = skipOddByte ? 1 : overrunBuffer.size();
     }
 
-    sampleNetworkBuffer.putDataIntoBuffer(buffer.data(), buffer.size());
+    const ssize_t ret = receive(data, length);
+    if (ret <= 0) {
+        return;
+    }
 
-    // First fill the complete buffer to avoid sound outtages if the stream data rate is not stable e.g. over WIFI
-    if(!firstFilledNetworkBuffer) {
-        float bufferFill = (float) sampleNetworkBuffer.GetRingBufferReadAvailable() / sampleNetworkBuffer.GetBufferSize() * 100;
+    // Bytes, not samples, are received: count the samples completed
+    // by them
+    const uint64_t samples = (bytesReceived + ret) / 2 - bytesReceived / 2;
+    bytesReceived += ret;
+    accountSamples(samples, drop ? 0 : samples);
 
-        // Wait for 50% filled buffer
-        if(bufferFill >= 50)
-            firstFilledNetworkBuffer = true;
+    if (drop) {
+        if (not skipOddByte and not inOverrun) {
+            inOverrun = true;
+            overruns++;
+        }
 
-        if((getMyTime() - oldTime_us > 100e3) || firstFilledNetworkBuffer) {
-            //std::clog << "RTL_TCP_CLIENT: Fill network buffer " << bufferFill << "%" << std::endl;
-            oldTime_us = getMyTime();
+        if (ret % 2) {
+            skipOddByte = not skipOddByte;
         }
+        return;
     }
 
+    inOverrun = false;
+    sampleBuffer.commitWrite(ret);
+    spectrumSampleBuffer.putDataIntoBuffer(data, ret);
+    putIntoRecordBuffer(*data, ret);
 
-    // Check if device is overloaded
-    minAmplitude = 255;
-    maxAmplitude = 0;
+    // Until the reader has flushed, the old samples still count
+    if (not jitterBufferFilled and not sampleFlushRequested and
+            sampleBuffer.GetRingBufferReadAvailable() >= jitterBufferBytes) {
+        jitterBufferFilled = true;
+    }
 
-    for (const auto b : buffer) {
-        if (minAmplitude > b)
-            minAmplitude = b;
-        if (maxAmplitude < b)
-            maxAmplitude = b;
+    if (jitterBufferFilled) {
+        notifySamplesAvailable();
     }
 }
 
@@ -333,7 +406,7 @@ void CRTL_TCP_Client::handleDisconnect()
     sock.close();
 }
 
-void CRTL_TCP_Client::sendCommand(uint8_t cmd, int32_t param)
+void CRTL_TCP_Client::sendCommand(RtlTcpCommand cmd, int32_t param)
 {
     if (!connected || !sock.valid()) {
         return;
@@ -342,7 +415,7 @@ void CRTL_TCP_Client::sendCommand(uint8_t cmd, int32_t param)
     std::vector<uint8_t> datagram;
 
     datagram.resize(5);
-    datagram[0] = cmd; // command to set rate
+    datagram[0] = static_cast<uint8_t>(cmd);
     datagram[4] = param & 0xFF;  //lsb last
     datagram[3] = (param >> ONE_BYTE) & 0xFF;
     datagram[2] = (param >> (2 * ONE_BYTE)) & 0xFF;
@@ -352,17 +425,17 @@ void CRTL_TCP_Client::sendCommand(uint8_t cmd, int32_t param)
 
 void CRTL_TCP_Client::sendVFO(int32_t frequency)
 {
-    sendCommand(0x01, frequency);
+    sendCommand(RtlTcpCommand::SetFrequency, frequency);
 }
 
 void CRTL_TCP_Client::sendRate(int32_t theRate)
 {
-    sendCommand(0x02, theRate);
+    sendCommand(RtlTcpCommand::SetSampleRate, theRate);
 }
 
 void CRTL_TCP_Client::setGainMode(int32_t gainMode)
 {
-    sendCommand (0x03, gainMode);
+    sendCommand(RtlTcpCommand::SetGainMode, gainMode);
 }
 
 float CRTL_TCP_Client::getGain() const
@@ -375,7 +448,7 @@ float CRTL_TCP_Client::setGain(int32_t gain)
     currentGainCount = gain;
     float gainValue = getGainValue(gain);
 
-    sendCommand(0x04, (int)10 * gainValue);
+    sendCommand(RtlTcpCommand::SetGain, (int)10 * gainValue);
 
     currentGain = gainValue;
     return gainValue;
@@ -405,7 +478,7 @@ void CRTL_TCP_Client::setAgc(bool AGC)
 //void CRTL_TCP_Client::setHwAgc(bool hwAGC)
 //{
 //    isHwAGC = hwAGC;
-//    sendCommand(0x08, hwAGC ? 1 : 0);
+//    sendCommand(RtlTcpCommand::SetAgcMode, hwAGC ? 1 : 0);
 //}
 
 std::string CRTL_TCP_Client::getDescription()
@@ -420,6 +493,22 @@ CDeviceID CRTL_TCP_Client::getID()
     return CDeviceID::RTL_TCP;
 }
 
+bool CRTL_TCP_Client::setDeviceParam(DeviceParam param, int value)
+{
+    if (param == DeviceParam::IQCorrection) {
+        std::clog << "RTL_TCP_CLIENT: Set IQ correction to " << value << std::endl;
+        iqCorrector.setEnabled(value);
+        return true;
+    }
+
+    return false;
+}
+
+IQCorrectionStats CRTL_TCP_Client::getIQCorrection()
+{
+    return iqCorrector.getStats();
+}
+
 void CRTL_TCP_Client::setServerAddress(const std::string& serverAddress)
 {
     this->serverAddress = serverAddress;
@@ -430,6 +519,22 @@ void CRTL_TCP_Client::setPort(uint16_t Port)
     serverPort = Port;
 }
 
+void CRTL_TCP_Client::setJitterBuffer(std::chrono::milliseconds duration)
+{
+    // Leave at least half of the sample buffer for the decoder to lag behind
+    const int64_t bytes = 2 * (int64_t)INPUT_RATE * duration.count() / 1000;
+    jitterBufferBytes = std::min<int64_t>(bytes, sampleBufferSize / 2);
+}
+
+RtlTcpClientStats CRTL_TCP_Client::getStats() const
+{
+    RtlTcpClientStats stats;
+    stats.bytesReceived = bytesReceived;
+    stats.overruns = overruns;
+    stats.reconnects = reconnects;
+    return stats;
+}
+
 void CRTL_TCP_Client::receiveAndReconnect()
 {
     while (rtlsdrRunning) {
@@ -450,10 +555,15 @@ void CRTL_TCP_Client::receiveAndReconnect()
                 std::clog << "RTL_TCP_CLIENT: Successful connected to server " <<
                     std::endl;
 
-                if (!agcRunning) {
-                    agcRunning = true;
-                    agcThread = std::thread(&CRTL_TCP_Client::agcTimer, this);
+                if (wasConnected) {
+                    reconnects++;
                 }
+                wasConnected = true;
+
+                sock.setReceiveTimeout(receiveTimeout_ms);
+                inOverrun = false;
+                skipOddByte = false;
+
                 firstData = true;
                 reset(); // Clear buffers
             }
@@ -461,7 +571,6 @@ void CRTL_TCP_Client::receiveAndReconnect()
                 std::clog << "RTL_TCP_CLIENT: Could not connect to server" <<
                     std::endl;
 
-                agcRunning = false;
                 rtlsdrRunning = false;
                 lock.unlock();
 
@@ -481,97 +590,36 @@ void CRTL_TCP_Client::receiveAndReconnect()
     }
 }
 
-#define NETWORK_BUFFER_READ_SAMPLES 32768
-void CRTL_TCP_Client::networkBufferCopy()
+void CRTL_TCP_Client::updateGain(void)
 {
-    std::vector<uint8_t> tempBuffer(NETWORK_BUFFER_READ_SAMPLES * 2);
-
-    while (rtlsdrRunning) {
-        if(!firstFilledNetworkBuffer) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            nextStop_us = getMyTime();
-            continue;
-        }
-
-        int32_t samples = NETWORK_BUFFER_READ_SAMPLES;
+    const bool atMaximum = currentGainCount + 1 >= getGainCount();
+    const float stepUp = atMaximum ? 0 :
+        getGainValue(currentGainCount + 1) - currentGain;
+    const AgcStep step = agc.decide(stepUp);
 
-        // Figure out the max samples to read from network buffer
-        int32_t samplesInBuffer = sampleNetworkBuffer.GetRingBufferReadAvailable() / 2;
-        if(samplesInBuffer < samples)
-            samples = samplesInBuffer;
-
-        if(samples == 0) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            nextStop_us = getMyTime();
-            continue;
+    if (not isAGC or dongleInfo.tuner_type == RTLSDR_TUNER_UNKNOWN) {
+        if (agc.clippingStarted()) {
+            std::string text = QT_TRANSLATE_NOOP("CRadioController", "ADC overload."
+                " Maybe you are using a too high gain.");
+            std::clog << "RTL_TCP_CLIENT:" << text << std::endl;
+            radioController.onMessage(message_level_t::Information, text);
         }
-
-        // Read data
-        int32_t amount = sampleNetworkBuffer.getDataFromBuffer(tempBuffer.data(), 2 * samples);
-
-        // Write data to standard buffers
-        sampleBuffer.putDataIntoBuffer(tempBuffer.data(), amount);
-        spectrumSampleBuffer.putDataIntoBuffer(tempBuffer.data(), amount);
-
-        if(getMyTime() - oldTime_us > 500e3) { // 500 ms
-
-            // float bufferFill = (float) sampleNetworkBuffer.GetRingBufferReadAvailable() / sampleNetworkBuffer.GetBufferSize() * 100;
-            //std::clog << "RTL_TCP_CLIENT: Network buffer fill level " << bufferFill << "%" << std::endl;
-
-            oldTime_us = getMyTime();
-        }
-
-
-        uint32_t period_us = samples / ((float) INPUT_RATE / 1e6);
-        nextStop_us += period_us;
-        int64_t timeToWait_us = nextStop_us - getMyTime();
-
-        // Send thread to sleep
-        std::this_thread::sleep_for(std::chrono::microseconds(timeToWait_us));
+        return;
     }
-}
-
-void CRTL_TCP_Client::agcTimer(void)
-{
-    while (agcRunning) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
 
-        if (isAGC && (dongleInfo.tuner_type != RTLSDR_TUNER_UNKNOWN)) {
-            // Check for overloading
-            if (minAmplitude == 0 || maxAmplitude == 255) {
-                // We have to decrease the gain
-                if(currentGainCount > 0) {
-                    setGain(currentGainCount - 1);
-                    //std::clog << "RTL_TCP_CLIENT: Decrease gain to " << (float)currentGain << std::endl;
-                }
-            }
-            else {
-                if (currentGainCount < (getGainCount() - 1)) {
-                    // Calc if a gain increase overloads the device. Calc it
-                    // from the gain values
-                    const float newGain = getGainValue(currentGainCount + 1);
-                    const float deltaGain = newGain - currentGain;
-                    const float linGain = pow(10, deltaGain / 20);
-                    const int newMaxValue = (float)maxAmplitude * linGain;
-                    const int newMinValue = (float)minAmplitude / linGain;
-
-                    // We have to increase the gain
-                    if (newMinValue >=0 && newMaxValue <= 255) {
-                        setGain(currentGainCount + 1);
-                        //std::clog << "RTL_TCP_CLIENT: Increase gain to " << currentGain << std::endl;
-                    }
-                }
-            }
-        }
-        else { // AGC is off or unknown tuner
-            if (minAmplitude == 0 || maxAmplitude == 255) {
-                std::string text = QT_TRANSLATE_NOOP("CRadioController", "ADC overload."
-                    " Maybe you are using a too high gain.");
-                std::clog << "RTL_TCP_CLIENT:" << text << std::endl;
-                radioController.onMessage(message_level_t::Information, text);
-            }
-        }
+    if (step == AgcStep::Down and currentGainCount > 0) {
+        setGain(currentGainCount - 1);
+    }
+    else if (step == AgcStep::Up) {
+        setGain(currentGainCount + 1);
     }
+    else {
+        return;
+    }
+
+    // The samples on their way from the server were received with the
+    // previous gain as well, the settling time of the AGC covers them
+    agc.gainChanged(sampleBuffer.GetRingBufferReadAvailable() / 2);
 }
 
 float CRTL_TCP_Client::getGainValue(uint16_t gainCount)
@@ -34,6 +34,7 @@
 #define __RTL_TCP_CLIENT
 
 #include <array>
+#include <atomic>
 #include <string>
 #include <thread>
 #include <mutex>
@@ -43,13 +44,43 @@
 #include "MathHelper.h"
 #include "ringbuffer.h"
 #include "radio-controller.h"
+#include "histogram_agc.h"
+#include "iq_corrector.h"
+
+// Commands are sent to the server in 5 bytes: the command, followed by
+// its parameter as 32-bit integer in network byte order
+enum class RtlTcpCommand : uint8_t {
+    SetFrequency = 0x01,
+    SetSampleRate = 0x02,
+    SetGainMode = 0x03,
+    SetGain = 0x04,             // In tenths of dB
+    SetFrequencyCorrection = 0x05,
+    SetIfGain = 0x06,
+    SetTestMode = 0x07,
+    SetAgcMode = 0x08,
+    SetDirectSampling = 0x09,
+    SetOffsetTuning = 0x0a,
+    SetRtlXtal = 0x0b,
+    SetTunerXtal = 0x0c,
+    SetGainByIndex = 0x0d,
+    SetBiasTee = 0x0e,
+    AndroidExit = 0x7e,
+};
 
+// Sent by the server when a client connects, followed by the samples
+// as unsigned 8-bit I/Q
 struct dongle_info_t { /* structure size must be multiple of 2 bytes */
     char magic[4];
     uint32_t tuner_type;
     uint32_t tuner_gain_count;
 };
 
+struct RtlTcpClientStats {
+    uint64_t bytesReceived = 0;
+    uint64_t overruns = 0;
+    uint64_t reconnects = 0;
+};
+
 class CRTL_TCP_Client : public CVirtualInput {
 public:
     CRTL_TCP_Client(RadioControllerInterface& radioController);
@@ -70,49 +101,73 @@ public:
     void setAgc(bool AGC);
     std::string getDescription(void);
     CDeviceID getID(void);
+    bool setDeviceParam(DeviceParam param, int value);
+    IQCorrectionStats getIQCorrection(void);
 
     // Specific methods
     void setServerAddress(const std::string& serverAddress);
     void setPort(uint16_t Port);
 
+    // How much signal to receive after (re)connecting before the samples
+    // are handed to the decoder. It absorbs the jitter of the network.
+    void setJitterBuffer(std::chrono::milliseconds duration);
+
+    RtlTcpClientStats getStats(void) const;
+
     RadioControllerInterface& radioController;
 
 private:
     void stop(void);
-    void agcTimer(void);
+    void updateGain(void);
     void receiveData(void);
     void receiveAndReconnect(void);
-    void networkBufferCopy(void);
+    void flushIfRequested(void);
     void handleDisconnect(void);
+    ssize_t receive(void *buffer, size_t length);
+    bool receiveDongleInfo(void);
 
     std::mutex mutex;
     Socket sock;
     std::thread receiveThread;
-    bool agcRunning = false;
-    std::thread agcThread;
-    std::thread networkBufferThread;
 
     float currentGain = 0;
     uint16_t currentGainCount = 0;
-    uint8_t minAmplitude = 255;
-    uint8_t maxAmplitude = 0;
     bool isAGC = true;
     bool isHwAGC = false;
     int frequency = kHz(220000);
     RingBuffer<uint8_t> sampleBuffer;
-    RingBuffer<uint8_t> sampleNetworkBuffer;
     RingBuffer<uint8_t> spectrumSampleBuffer;
+
+    // Runs on the codes read in getSamples(), before any correction
+    HistogramAgc agc;
+    IQCorrector iqCorrector;
+
     bool connected = false;
-    bool rtlsdrRunning = false;
+    std::atomic<bool> rtlsdrRunning = ATOMIC_VAR_INIT(false);
     std::string serverAddress = "127.0.0.1";
     uint16_t serverPort = 1234;
 
     bool firstData = true;
-    bool firstFilledNetworkBuffer = false;
-    int64_t oldTime_us = 0;
-    int64_t nextStop_us = 0;
+    bool wasConnected = false;
     dongle_info_t dongleInfo;
 
+    // Received samples are held back until jitterBufferBytes are buffered
+    int32_t jitterBufferBytes = 0;
+    std::atomic<bool> jitterBufferFilled = ATOMIC_VAR_INIT(false);
+
+    // Set by reset(), carried out by the readers of the buffers
+    std::atomic<bool> sampleFlushRequested = ATOMIC_VAR_INIT(false);
+    std::atomic<bool> spectrumFlushRequested = ATOMIC_VAR_INIT(false);
+
+    // Receive buffer used to drain the socket when sampleBuffer is full
+    std::vector<uint8_t> overrunBuffer;
+    bool inOverrun = false;
+    bool skipOddByte = false;
+
+    std::atomic<uint64_t> bytesReceived = ATOMIC_VAR_INIT(0);
+    std::atomic<uint64_t> overruns = ATOMIC_VAR_INIT(0);
+    std::atomic<uint64_t> reconnects = ATOMIC_VAR_INIT(0);
+
     // Gain values for the different tuners
     const std::array<float, 14> e4k_gains{{-1.0, 1.5, 4.0, 6.5, 9.0, 11.5,
         14.0, 16.5, 19.0, 21.5, 24.0, 29.0, 34.0, 42.0}};
@@ -132,7 +187,7 @@ private:
     void sendVFO(int32_t frequency);
     void sendRate(int32_t theRate);
     void setGainMode(int32_t gainMode);
-    void sendCommand(uint8_t cmd, int32_t param);
+    void sendCommand(RtlTcpCommand cmd, int32_t param);
     float getGainValue(uint16_t gainCount);
 };
 
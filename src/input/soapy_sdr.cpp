@@ -24,13 +24,19 @@
  *
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <vector>
 #include <sstream>
 #include <iostream>
 #include <cassert>
+#include <cmath>
 #include <SoapySDR/Errors.hpp>
+#include <SoapySDR/Formats.hpp>
 #include "soapy_sdr.h"
 #include "dab-constants.h"
+#include "iq_convert.h"
 #include "unistd.h"
 
 // For Qt translation if Qt is existing
@@ -119,15 +125,29 @@ bool CSoapySdr::restart()
     }
     std::clog << ss.str().c_str() << std::endl;
 
-    m_device->setMasterClockRate(INPUT_RATE*16);
-    std::clog << "SoapySDR master clock rate set to " <<
-        m_device->getMasterClockRate()/1000.0 << " kHz" << std::endl;
-
-    m_device->setSampleRate(SOAPY_SDR_RX, 0, INPUT_RATE);
-    std::clog << "SoapySDR:Actual RX rate: " <<
-        m_device->getSampleRate(SOAPY_SDR_RX, 0) / 1000.0 <<
+    m_device->setSampleRate(SOAPY_SDR_RX, 0, chooseSampleRate());
+    const long rate = lround(m_device->getSampleRate(SOAPY_SDR_RX, 0));
+    std::clog << "SoapySDR:Actual RX rate: " << rate / 1000.0 <<
         " ksps." << std::endl;
 
+    m_resampler.reset();
+    if (rate != (long)m_outputRate) {
+        if (m_outputRate == INPUT_RATE) {
+            m_resampler.reset(new Resampler(rate));
+        }
+        else {
+            // The resampler only passes the bandwidth of one ensemble,
+            // a wideband stream must come from the device as it is
+            std::clog << "SoapySDR: Device does not support " <<
+                m_outputRate / 1000.0 << " ksps" << std::endl;
+            stop();
+            radioController.onMessage(message_level_t::Error,
+                    QT_TRANSLATE_NOOP("CRadioController",
+                        "The device does not support the requested sample rate."));
+            return false;
+        }
+    }
+
 
     clog << "Supported antenna: ";
     for (const auto& ant : m_device->listAntennas(SOAPY_SDR_RX, 0)) {
@@ -188,6 +208,12 @@ void CSoapySdr::stop()
     m_running = false;
     if (m_thread.joinable()) {
         m_thread.join();
+
+        const auto stats = getStats();
+        std::clog << "SoapySDR: " << stats.samples << " samples in " <<
+            stats.reads << " reads, " << stats.overflows << " overflows, " <<
+            stats.timeouts << " timeouts, " << getInputStats().dropped <<
+            " dropped, longest read " << stats.maxReadTimeUs << " us" << std::endl;
     }
 
     if (m_device != nullptr) {
@@ -345,6 +371,22 @@ CDeviceID CSoapySdr::getID()
     return CDeviceID::SOAPYSDR;
 }
 
+bool CSoapySdr::setDeviceParam(DeviceParam param, int value)
+{
+    switch(param) {
+        case DeviceParam::SampleRate:
+            m_outputRate = value;
+            if (m_running) {
+                stop();
+                restart();
+            }
+            return true;
+        default: std::runtime_error("Unsupported device parameter");
+    }
+
+    return false;
+}
+
 bool CSoapySdr::setDeviceParam(DeviceParam param, const std::string& value)
 {
     switch(param) {
@@ -357,17 +399,86 @@ bool CSoapySdr::setDeviceParam(DeviceParam param, const std::string& value)
     return false;
 }
 
+double CSoapySdr::chooseSampleRate()
+{
+    // Use the requested rate if the device supports it, otherwise the
+    // lowest rate above it, which the resampler converts to INPUT_RATE.
+    const double wanted = m_outputRate;
+    double best = 0;
+    for (const auto& range : m_device->getSampleRateRange(SOAPY_SDR_RX, 0)) {
+        double candidate = 0;
+        if (range.maximum() < wanted) {
+            candidate = range.maximum();
+        }
+        else if (range.minimum() >= wanted) {
+            candidate = range.minimum();
+        }
+        else if (range.step() > 0) {
+            candidate = std::min(range.maximum(), range.minimum() +
+                ceil((wanted - range.minimum()) / range.step()) * range.step());
+        }
+        else {
+            candidate = wanted;
+        }
+
+        bool better = false;
+        if (best == 0) {
+            better = true;
+        }
+        else if ((candidate >= wanted) != (best >= wanted)) {
+            better = candidate >= wanted;
+        }
+        else if (candidate >= wanted) {
+            better = candidate < best;
+        }
+        else {
+            better = candidate > best;
+        }
+
+        if (better) {
+            best = candidate;
+        }
+    }
+
+    return best > 0 ? best : wanted;
+}
+
+std::string CSoapySdr::chooseStreamFormat(double& fullScale)
+{
+    // Reading the samples in the format the hardware delivers them saves
+    // the driver a conversion to CF32, and halves to quarters the data
+    // that goes through it. We convert them ourselves, once, into the
+    // sample buffer.
+    const auto formats = m_device->getStreamFormats(SOAPY_SDR_RX, 0);
+    const auto native = m_device->getNativeStreamFormat(SOAPY_SDR_RX, 0, fullScale);
+    const bool supported = std::find(formats.begin(), formats.end(), native) != formats.end();
+
+    if (supported and fullScale > 0 and
+            (native == SOAPY_SDR_CS8 or native == SOAPY_SDR_CS12 or native == SOAPY_SDR_CS16)) {
+        return native;
+    }
+
+    std::clog << "SoapySDR: Native format " << native <<
+        " not supported, using " << SOAPY_SDR_CF32 << std::endl;
+    fullScale = 1.0;
+    return SOAPY_SDR_CF32;
+}
+
 void CSoapySdr::workerthread()
 {
     std::vector<size_t> channels;
     channels.push_back(0);
     std::clog << " *************** Setup soapy stream" << std::endl;
     auto args = SoapySDR::KwargsFromString(m_driver_args);
-    auto stream = m_device->setupStream(SOAPY_SDR_RX, "CF32", channels, args);
+    double fullScale = 1.0;
+    const auto format = chooseStreamFormat(fullScale);
+    std::clog << "SoapySDR: Stream format " << format <<
+        ", full scale " << fullScale << std::endl;
+    auto stream = m_device->setupStream(SOAPY_SDR_RX, format, channels, args);
 
     m_device->activateStream(stream);
     try {
-        process(stream);
+        process(stream, format, fullScale);
     }
     catch (std::exception& e) {
         std::clog << " *************** Exception caught in soapy: " << e.what() << std::endl;
@@ -378,31 +489,79 @@ void CSoapySdr::workerthread()
     m_running = false;
 }
 
-void CSoapySdr::process(SoapySDR::Stream *stream)
+static void copyCF32(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        DSPCOMPLEX, float)
 {
+    std::memcpy(out, in, count * sizeof(DSPCOMPLEX));
+}
+
+void CSoapySdr::process(SoapySDR::Stream *stream, const std::string& format,
+        double fullScale)
+{
+    // The integer formats are normalised to their type, the scale
+    // corrects for devices that don't use the full range of it
+    iqconvert::ConvertFunction convert = copyCF32;
+    size_t sampleSize = sizeof(DSPCOMPLEX);
+    float scale = 1.0f;
+    if (format == SOAPY_SDR_CS8) {
+        convert = iqconvert::fromS8;
+        sampleSize = 2;
+        scale = 128.0 / fullScale;
+    }
+    else if (format == SOAPY_SDR_CS12) {
+        convert = iqconvert::fromCS12;
+        sampleSize = 3;
+        scale = 2048.0 / fullScale;
+    }
+    else if (format == SOAPY_SDR_CS16) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        convert = iqconvert::fromS16BE;
+#else
+        convert = iqconvert::fromS16LE;
+#endif
+        sampleSize = 4;
+        scale = 32768.0 / fullScale;
+    }
+
+    // Stream MTU is in samples, not bytes. Asking for several MTUs lets
+    // the driver hand over everything it has queued in one call, which
+    // it returns early if less is available.
+    const size_t minimumReadSize = 16384;
+    const size_t readSize = std::max(m_device->getStreamMTU(stream), minimumReadSize);
+    m_readBuffer.resize(readSize * sampleSize);
+    if (m_resampler) {
+        m_converted.resize(readSize);
+        m_resampled.resize(m_resampler->maxOutput(readSize));
+    }
+
     size_t frames = 0;
     while (m_running) {
         frames++;
 
-        // Stream MTU is in samples, not bytes.
-        const size_t mtu = m_device->getStreamMTU(stream);
-
-        const size_t samps_to_read = mtu; // Always read MTU samples
-        std::vector<DSPCOMPLEX> buf(samps_to_read);
-
         void *buffs[1];
-        buffs[0] = buf.data();
+        buffs[0] = m_readBuffer.data();
 
         int flags = 0;
         long long timeNs = 0;
         assert(m_device != nullptr);
+        const auto readStart = std::chrono::steady_clock::now();
         int ret = m_device->readStream(
-                stream, buffs, samps_to_read, flags, timeNs);
+                stream, buffs, readSize, flags, timeNs);
+        const uint64_t readTime = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - readStart).count();
+
+        m_reads++;
+        m_readTimeUs += readTime;
+        if (readTime > m_maxReadTimeUs) {
+            m_maxReadTimeUs = readTime;
+        }
 
         if (ret == SOAPY_SDR_TIMEOUT) {
+            m_timeouts++;
             continue;
         }
         else if (ret == SOAPY_SDR_OVERFLOW) {
+            m_overflows++;
             continue;
         }
         else if (ret == SOAPY_SDR_UNDERFLOW) {
@@ -413,30 +572,61 @@ void CSoapySdr::process(SoapySDR::Stream *stream)
             std::clog << " *************** Unexpected stream error " <<
                 SoapySDR::errToStr(ret) << std::endl;
             m_running = false;
+            break;
         }
-        else {
-            buf.resize(ret);
-
-            if (m_sw_agc and (frames % 200) == 0) {
-                float maxnorm = 0;
-                for (const DSPCOMPLEX& z : buf) {
-                    if (norm(z) > maxnorm) {
-                        maxnorm = norm(z);
-                    }
-                }
 
-                const float maxampl = sqrt(maxnorm);
+        m_samples += ret;
 
-                if (maxampl > 0.5f) {
-                    decreaseGain();
-                }
-                else if (maxampl < 0.1f) {
-                    increaseGain();
+        const bool measure = m_sw_agc and (frames % 200) == 0;
+        float maxnorm = 0;
+        auto written = [&](const DSPCOMPLEX *samples, int32_t count) {
+            m_spectrumSampleBuffer.putDataIntoBuffer(samples, count);
+            if (measure) {
+                for (int32_t i = 0; i < count; i++) {
+                    maxnorm = std::max(maxnorm, norm(samples[i]));
                 }
             }
+        };
+
+        if (m_resampler) {
+            convert(m_readBuffer.data(), m_converted.data(), ret,
+                    DSPCOMPLEX(0, 0), scale);
+            const int32_t count = m_resampler->process(
+                    m_converted.data(), ret, m_resampled.data());
+            accountSamples(count, m_sampleBuffer.putDataIntoBuffer(m_resampled.data(), count));
+            written(m_resampled.data(), count);
+        }
+        else {
+            const int32_t stored = iqconvert::toRingBuffer(m_sampleBuffer,
+                    m_readBuffer.data(), ret, sampleSize,
+                    [&](const uint8_t *in, DSPCOMPLEX *out, int32_t count) {
+                        convert(in, out, count, DSPCOMPLEX(0, 0), scale);
+                    }, written);
+            accountSamples(ret, stored);
+        }
+        notifySamplesAvailable();
+
+        if (measure) {
+            const float maxampl = sqrt(maxnorm);
 
-            m_sampleBuffer.putDataIntoBuffer(buf.data(), ret);
-            m_spectrumSampleBuffer.putDataIntoBuffer(buf.data(), ret);
+            if (maxampl > 0.5f) {
+                decreaseGain();
+            }
+            else if (maxampl < 0.1f) {
+                increaseGain();
+            }
         }
     }
 }
+
+SoapySdrStats CSoapySdr::getStats() const
+{
+    SoapySdrStats stats;
+    stats.reads = m_reads;
+    stats.samples = m_samples;
+    stats.overflows = m_overflows;
+    stats.timeouts = m_timeouts;
+    stats.readTimeUs = m_readTimeUs;
+    stats.maxReadTimeUs = m_maxReadTimeUs;
+    return stats;
+}
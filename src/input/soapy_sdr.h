@@ -27,9 +27,11 @@
 #pragma once
 
 #include <atomic>
+#include <memory>
 #include <thread>
 #include "virtual_input.h"
 #include "ringbuffer.h"
+#include "resampler.h"
 #include <SoapySDR/Version.hpp>
 #include <SoapySDR/Modules.hpp>
 #include <SoapySDR/Registry.hpp>
@@ -37,6 +39,15 @@
 
 class CSoapySdr_Thread;
 
+struct SoapySdrStats {
+    uint64_t reads = 0;
+    uint64_t samples = 0;
+    uint64_t overflows = 0;     // Reported by the driver
+    uint64_t timeouts = 0;
+    uint64_t readTimeUs = 0;    // Total time spent in readStream
+    uint64_t maxReadTimeUs = 0;
+};
+
 class CSoapySdr : public CVirtualInput
 {
 public:
@@ -60,14 +71,19 @@ public:
     virtual void setAgc(bool AGC);
     virtual std::string getDescription(void);
     virtual CDeviceID getID(void);
+    virtual bool setDeviceParam(DeviceParam param, int value);
     virtual bool setDeviceParam(DeviceParam param, const std::string& value);
 
+    SoapySdrStats getStats(void) const;
+
 private:
     void setDriverArgs(const std::string& args);
     void setAntenna(const std::string& antenna);
     void setClockSource(const std::string& clock_source);
     void decreaseGain();
     void increaseGain();
+    double chooseSampleRate(void);
+    std::string chooseStreamFormat(double& fullScale);
 
     RadioControllerInterface& radioController;
     int m_freq = 0;
@@ -77,14 +93,32 @@ private:
     SoapySDR::Device *m_device = nullptr;
     std::atomic<bool> m_running = ATOMIC_VAR_INIT(false);
     bool m_sw_agc = false;
+    uint32_t m_outputRate = INPUT_RATE;
 
     RingBuffer<DSPCOMPLEX> m_sampleBuffer;
     RingBuffer<DSPCOMPLEX> m_spectrumSampleBuffer;
 
     std::vector<double> m_gains;
 
+    // Converts the native rate of the device to INPUT_RATE, if needed
+    std::unique_ptr<Resampler> m_resampler;
+    std::vector<DSPCOMPLEX> m_resampled;
+
+    // Samples as read from the device, in its native format, and
+    // converted to DSPCOMPLEX if they have to be resampled
+    std::vector<uint8_t> m_readBuffer;
+    std::vector<DSPCOMPLEX> m_converted;
+
+    std::atomic<uint64_t> m_reads = ATOMIC_VAR_INIT(0);
+    std::atomic<uint64_t> m_samples = ATOMIC_VAR_INIT(0);
+    std::atomic<uint64_t> m_overflows = ATOMIC_VAR_INIT(0);
+    std::atomic<uint64_t> m_timeouts = ATOMIC_VAR_INIT(0);
+    std::atomic<uint64_t> m_readTimeUs = ATOMIC_VAR_INIT(0);
+    std::atomic<uint64_t> m_maxReadTimeUs = ATOMIC_VAR_INIT(0);
+
     std::thread m_thread;
     void workerthread(void);
-    void process(SoapySDR::Stream *stream);
+    void process(SoapySDR::Stream *stream, const std::string& format,
+            double fullScale);
 };
 
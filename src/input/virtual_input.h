@@ -30,26 +30,70 @@
 #ifndef __VIRTUAL_INPUT
 #define __VIRTUAL_INPUT
 
+#include <atomic>
 #include <memory>
 #include <fstream>
 #include <iostream>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
 
 #include "dab-constants.h"
 #include "radio-controller.h"
 #include "ringbuffer.h"
+#include "iq_container.h"
+
+// Gets a copy of the raw samples the driver records, e.g. to write them
+// to disk continuously. push() is called from the driver's thread and
+// must never block it.
+class IQRecordSink {
+public:
+    virtual ~IQRecordSink() {}
+    virtual void push(const uint8_t *data, size_t length) = 0;
+};
 
 enum class CDeviceID {
-    UNKNOWN, NULLDEVICE, AIRSPY, RAWFILE, RTL_SDR, RTL_TCP, SOAPYSDR, ANDROID_RTL_SDR, LIMESDR};
+    UNKNOWN, NULLDEVICE, AIRSPY, RAWFILE, RTL_SDR, RTL_TCP, SOAPYSDR, ANDROID_RTL_SDR, LIMESDR, CHANNELIZER, GENERATOR, MULTICAST};
 
 class CVirtualInput : public InputInterface {
 public:
     virtual ~CVirtualInput() {}
     virtual CDeviceID getID(void) = 0;
 
+    virtual int32_t waitForSamples(int32_t n, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(samplesMutex);
+        int32_t available = 0;
+        samplesAvailable.wait_for(lock, timeout, [&]() {
+                available = getSamplesToRead();
+                return available >= n; });
+        return available;
+    }
+
+    // Files ending with .wiq are written as compressed IQ container,
+    // anything else as raw samples.
     void writeRecordBufferToFile(std::string &fileanme) {
         if(!recordBuffer)
             return;
 
+        IQContainerInfo info;
+        const std::string containerExtension = ".wiq";
+        if (fileanme.size() >= containerExtension.size() and
+                fileanme.compare(fileanme.size() - containerExtension.size(),
+                    containerExtension.size(), containerExtension) == 0) {
+            if (parseIQContainerFormat(recordFormat, info.format)) {
+                info.sampleRate = INPUT_RATE;
+                info.centreFrequency = getFrequency();
+                info.captureTime = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count();
+                writeRecordBufferToContainer(fileanme, info);
+                return;
+            }
+
+            std::clog << "CVirtualInput: " << recordFormat <<
+                " samples cannot be compressed, writing them raw" << std::endl;
+        }
+
         std::ofstream rawStream(fileanme, std::ios::binary);
 
         while (1) {
@@ -68,6 +112,25 @@ public:
         rawStream.close();
     }
 
+    InputStats getInputStats(void) {
+        InputStats stats;
+        stats.samples = samplesDelivered;
+        stats.dropped = samplesDropped;
+
+        std::lock_guard<std::mutex> lock(dropsMutex);
+        stats.dropEvents = dropEvents;
+        stats.recentDrops.assign(recentDrops.begin(), recentDrops.end());
+        return stats;
+    }
+
+    void setRecordSink(IQRecordSink *sink) {
+        recordSink = sink;
+    }
+
+    const std::string& getRecordFormat(void) const {
+        return recordFormat;
+    }
+
     void initRecordBuffer(uint32_t size) {
         // The ring buffer size has to be power of 2
         uint32_t bitCount = ceil(log2(size));
@@ -83,7 +146,60 @@ public:
     }
 
 protected:
-    void putIntoRecordBuffer(uint8_t &data, uint32_t size) {
+    // Format of the samples given to putIntoRecordBuffer()
+    std::string recordFormat = "u8";
+
+    // To be called by the drivers whenever they have written
+    // to their sample buffer, wakes up waitForSamples().
+    void notifySamplesAvailable(void) {
+        {
+            std::lock_guard<std::mutex> lock(samplesMutex);
+        }
+        samplesAvailable.notify_all();
+    }
+
+    // To be called by the drivers for every block the device delivered,
+    // with the number of samples that fit into the sample buffer. Both
+    // are counted in samples, not bytes. Only one thread may call it.
+    void accountSamples(uint64_t delivered, uint64_t stored) {
+        const uint64_t index = samplesDelivered;
+        samplesDelivered = index + delivered;
+
+        const uint64_t lost = delivered - stored;
+        if (lost == 0) {
+            if (inDrop) {
+                inDrop = false;
+                std::lock_guard<std::mutex> lock(dropsMutex);
+                std::clog << "CVirtualInput: dropped " << recentDrops.back().count <<
+                    " samples at sample " << recentDrops.back().sampleIndex << std::endl;
+            }
+            return;
+        }
+
+        samplesDropped += lost;
+
+        std::lock_guard<std::mutex> lock(dropsMutex);
+        if (inDrop and stored == 0) {
+            recentDrops.back().count += lost;
+            return;
+        }
+
+        InputDropEvent event;
+        event.sampleIndex = index + stored;
+        event.count = lost;
+        recentDrops.push_back(event);
+        if (recentDrops.size() > maxRecentDrops) {
+            recentDrops.pop_front();
+        }
+        dropEvents++;
+        inDrop = true;
+    }
+
+    void putIntoRecordBuffer(const uint8_t &data, uint32_t size) {
+        IQRecordSink *sink = recordSink;
+        if (sink)
+            sink->push(&data, size);
+
         if(!recordBuffer)
             return;
 
@@ -92,7 +208,36 @@ protected:
     }
 
 private:
+    void writeRecordBufferToContainer(const std::string& filename,
+            const IQContainerInfo& info) {
+        IQContainerWriter writer;
+        if (not writer.open(filename, info))
+            return;
+
+        const auto regions = recordBuffer->acquireRead(
+                recordBuffer->GetRingBufferReadAvailable());
+        for (const auto& span : {regions.first, regions.second}) {
+            writer.write(span.data, span.size);
+        }
+        recordBuffer->release(regions.size());
+
+        writer.close();
+        std::clog << "CVirtualInput: wrote " << writer.getNumSamples() <<
+            " samples in " << writer.getFileSize() << " bytes" << std::endl;
+    }
+
+    static const size_t maxRecentDrops = 16;
+    std::atomic<uint64_t> samplesDelivered = ATOMIC_VAR_INIT(0);
+    std::atomic<uint64_t> samplesDropped = ATOMIC_VAR_INIT(0);
+    bool inDrop = false;
+    std::mutex dropsMutex;
+    uint64_t dropEvents = 0;
+    std::deque<InputDropEvent> recentDrops;
+
     std::unique_ptr<RingBuffer<uint8_t>> recordBuffer;
+    std::atomic<IQRecordSink*> recordSink = ATOMIC_VAR_INIT(nullptr);
+    std::mutex samplesMutex;
+    std::condition_variable samplesAvailable;
 };
 
 #endif
@@ -26,6 +26,7 @@
 #include <QtTest>
 
 #include <algorithm>
+#include <atomic>
 #include <numeric>
 #include <random>
 #include <condition_variable>
@@ -36,6 +37,8 @@
 
 #include "radio-receiver.h"
 #include "raw_file.h"
+#include "dab_generator.h"
+#include "impaired_input.h"
 
 class TestRadioInterface : public RadioControllerInterface {
     public:
@@ -62,15 +65,22 @@ class TestProgrammeHandler: public ProgrammeHandlerInterface {
 
 public:
     std::string label = "";
+    std::atomic<size_t> audioSamples = ATOMIC_VAR_INIT(0);
+    std::atomic<int> audioSampleRate = ATOMIC_VAR_INIT(0);
+    std::atomic<int> frameErrors = ATOMIC_VAR_INIT(0);
+    std::atomic<int> aacErrors = ATOMIC_VAR_INIT(0);
 
-    virtual void onFrameErrors(int frameErrors) override { (void)frameErrors; }
+    virtual void onFrameErrors(int frameErrors) override { this->frameErrors += frameErrors; }
 
     virtual void onNewAudio(std::vector<int16_t>&& audioData, int sampleRate, const std::string& mode) override {
-        (void) audioData; (void)sampleRate; (void)mode;}
+        (void)mode;
+        audioSamples += audioData.size();
+        audioSampleRate = sampleRate;
+    }
 
     virtual void onRsErrors(bool uncorrectedErrors, int numCorrectedErrors) override {
         (void)uncorrectedErrors; (void)numCorrectedErrors; }
-    virtual void onAacErrors(int aacErrors) override { (void)aacErrors; }
+    virtual void onAacErrors(int aacErrors) override { if (aacErrors) this->aacErrors++; }
     virtual void onNewDynamicLabel(const std::string& label) override
     {
         this->label = label;
@@ -93,6 +103,7 @@ private slots:
     void cleanupTestCase() {}
     void testTuneToService();
     void testDLS();
+    void testImpairedGenerator();
 
 private:
     void runRadio(const std::string &rawFileName,
@@ -192,6 +203,53 @@ void BackendTests::testDLS()
     QCOMPARE(isOK, true);
 }
 
+void BackendTests::testImpairedGenerator()
+{
+    TestRadioInterface testRadioInterface;
+    RadioReceiverOptions radioReceiverOptions;
+    TestProgrammeHandler testProgrammeHandler;
+
+    CDabGenerator generator(DabGeneratorConfig::loadTest(2), false);
+    CImpairedInput input(generator, ImpairmentSettings::parse(
+                "snr=10,sco=20,path=0:0,path=30:-6:10"));
+
+    RadioReceiver radioReceiver(testRadioInterface, input, radioReceiverOptions);
+
+    generator.restart();
+    radioReceiver.restart(false);
+
+    std::vector<Service> services;
+    for (int i = 0; i < 30 and services.size() < 2; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        services = radioReceiver.getServiceList();
+    }
+
+    // The DAB+ superframes of the generator carry silent AAC audio,
+    // which must get through the impairments without an AU CRC or
+    // AAC error once the superframe sync is found
+    bool tuned = false;
+    if (not services.empty())
+    {
+        tuned = radioReceiver.playSingleProgramme(testProgrammeHandler, "", services.front());
+    }
+
+    for (int i = 0; i < 30 and tuned and testProgrammeHandler.audioSamples < 2 * 48000; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+
+    radioReceiver.stop();
+    generator.stop();
+
+    QCOMPARE(services.size(), (size_t)2);
+    QVERIFY(tuned);
+    QVERIFY(testProgrammeHandler.audioSamples >= 2 * 48000);
+    QCOMPARE(testProgrammeHandler.audioSampleRate.load(), 48000);
+    QCOMPARE(testProgrammeHandler.frameErrors.load(), 0);
+    QCOMPARE(testProgrammeHandler.aacErrors.load(), 0);
+}
+
 QTEST_APPLESS_MAIN(BackendTests)
 
 #include "backend_tests.moc"
@@ -30,11 +30,15 @@
  *
  */
 
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
 #include <cstring>
 #include "various/Socket.h"
 
+// Largest number of datagrams handed to one recvmmsg() or sendmmsg()
+static const int maxDatagramBatch = 64;
+
 #if defined(_WIN32)
 class SocketInitialiseWrapper {
     public:
@@ -71,6 +75,7 @@ Socket::Socket(Socket&& other)
         return;
     }
     sock = other.sock;
+    receiveBufferSize = other.receiveBufferSize;
     other.sock = INVALID_SOCKET;
 }
 
@@ -78,6 +83,7 @@ Socket& Socket::operator=(Socket&& other)
 {
     if (&other != this) {
         sock = other.sock;
+        receiveBufferSize = other.receiveBufferSize;
         other.sock = INVALID_SOCKET;
     }
     return *this;
@@ -109,6 +115,75 @@ ssize_t Socket::send(const void *buffer, size_t length, int flags)
     return ::send(sock, (const char*)buffer, length, flags);
 }
 
+static void closeSocket(int sfd)
+{
+#if defined(_WIN32)
+    closesocket(sfd);
+#else
+    ::close(sfd);
+#endif
+}
+
+static bool setOption(int sfd, int level, int option, const void *value, socklen_t length)
+{
+#if defined(_WIN32)
+    return setsockopt(sfd, level, option, (const char *) value, length) == 0;
+#else
+    return setsockopt(sfd, level, option, value, length) == 0;
+#endif
+}
+
+static void applyReceiveBufferSize(int sfd, int bytes)
+{
+    if (bytes <= 0) {
+        return;
+    }
+
+#if defined(_WIN32)
+    if (setsockopt(sfd, SOL_SOCKET, SO_RCVBUF, (char *) &bytes, sizeof(bytes))
+#else
+    if (setsockopt(sfd, SOL_SOCKET, SO_RCVBUF, &bytes, sizeof(bytes))
+#endif
+            == -1) {
+        std::clog << "Socket: Could not set receive buffer size to " <<
+            bytes << std::endl;
+    }
+}
+
+void Socket::setReceiveBufferSize(int bytes)
+{
+    receiveBufferSize = bytes;
+
+    if (valid()) {
+        applyReceiveBufferSize(sock, receiveBufferSize);
+    }
+}
+
+static bool setTimeout(int sock, int option, int timeout_ms)
+{
+#if defined(_WIN32)
+    DWORD timeout = timeout_ms;
+    return setsockopt(sock, SOL_SOCKET, option,
+            (char *) &timeout, sizeof(timeout)) == 0;
+#else
+    struct timeval timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
+    return setsockopt(sock, SOL_SOCKET, option,
+            &timeout, sizeof(timeout)) == 0;
+#endif
+}
+
+bool Socket::setReceiveTimeout(int timeout_ms)
+{
+    return setTimeout(sock, SO_RCVTIMEO, timeout_ms);
+}
+
+bool Socket::setSendTimeout(int timeout_ms)
+{
+    return setTimeout(sock, SO_SNDTIMEO, timeout_ms);
+}
+
 bool Socket::bind(int port)
 {
     if (valid()) {
@@ -167,7 +242,7 @@ Socket Socket::accept()
     socklen_t remote_addr_len = sizeof(remote_addr);
     int conn = ::accept(sock, (sockaddr*)&remote_addr, &remote_addr_len);
     if (conn == -1) {
-        if (errno == ECONNABORTED) {
+        if (errno == ECONNABORTED or errno == EAGAIN or errno == EWOULDBLOCK) {
             return {};
         }
         perror("accept failed");
@@ -179,6 +254,188 @@ Socket Socket::accept()
     return s;
 }
 
+static bool parseMulticastAddress(const std::string& group,
+        const std::string& interfaceAddress, ip_mreq& request)
+{
+    if (inet_pton(AF_INET, group.c_str(), &request.imr_multiaddr) != 1 or
+            not IN_MULTICAST(ntohl(request.imr_multiaddr.s_addr))) {
+        std::clog << "Socket: " << group << " is no IPv4 multicast address" << std::endl;
+        return false;
+    }
+
+    if (interfaceAddress.empty()) {
+        request.imr_interface.s_addr = htonl(INADDR_ANY);
+    }
+    else if (inet_pton(AF_INET, interfaceAddress.c_str(), &request.imr_interface) != 1) {
+        std::clog << "Socket: " << interfaceAddress << " is no IPv4 address" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Socket::joinMulticastGroup(const std::string& group, int port,
+        const std::string& interfaceAddress)
+{
+    ip_mreq request = {};
+    if (valid() or not parseMulticastAddress(group, interfaceAddress, request)) {
+        return false;
+    }
+
+    int sfd = ::socket(PF_INET, SOCK_DGRAM, 0);
+    if (sfd == -1) {
+        perror("Could not create socket");
+        return false;
+    }
+
+    // Let several receivers on this host share the group
+    int reuse = 1;
+    if (not setOption(sfd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse))) {
+        std::clog << "Socket: Could not reuse address" << std::endl;
+    }
+
+    applyReceiveBufferSize(sfd, receiveBufferSize);
+
+    // Windows can only bind to the wildcard address, elsewhere binding to
+    // the group filters out other groups on the same port
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+#if defined(_WIN32)
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+#else
+    addr.sin_addr = request.imr_multiaddr;
+#endif
+    addr.sin_port = htons(port);
+    if (::bind(sfd, (sockaddr*)&addr, sizeof(addr)) == -1) {
+        perror("Could not bind socket");
+        closeSocket(sfd);
+        return false;
+    }
+
+    if (not setOption(sfd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &request, sizeof(request))) {
+        perror("Could not join multicast group");
+        closeSocket(sfd);
+        return false;
+    }
+
+    sock = sfd;
+    return true;
+}
+
+bool Socket::connectMulticastGroup(const std::string& group, int port,
+        const std::string& interfaceAddress, int ttl)
+{
+    ip_mreq request = {};
+    if (valid() or not parseMulticastAddress(group, interfaceAddress, request)) {
+        return false;
+    }
+
+    int sfd = ::socket(PF_INET, SOCK_DGRAM, 0);
+    if (sfd == -1) {
+        perror("Could not create socket");
+        return false;
+    }
+
+    if (not setOption(sfd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl))) {
+        std::clog << "Socket: Could not set multicast TTL to " << ttl << std::endl;
+    }
+
+    if (not interfaceAddress.empty() and not setOption(sfd, IPPROTO_IP,
+                IP_MULTICAST_IF, &request.imr_interface, sizeof(request.imr_interface))) {
+        perror("Could not select multicast interface");
+        closeSocket(sfd);
+        return false;
+    }
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr = request.imr_multiaddr;
+    addr.sin_port = htons(port);
+    if (::connect(sfd, (sockaddr*)&addr, sizeof(addr)) == -1) {
+        perror("Could not connect socket");
+        closeSocket(sfd);
+        return false;
+    }
+
+#ifdef _WIN32
+    // Winsock has no MSG_DONTWAIT, so sends never block on this socket
+    unsigned long mode = 1;
+    if (ioctlsocket(sfd, FIONBIO, &mode) != 0) {
+        std::clog << "Socket: Failed to put multicast socket into non-blocking mode" << std::endl;
+    }
+#endif
+
+    sock = sfd;
+    return true;
+}
+
+int Socket::recvDatagrams(Datagram *datagrams, int count, int flags)
+{
+    if (count <= 0) {
+        return 0;
+    }
+
+#if defined(__linux__)
+    count = std::min(count, maxDatagramBatch);
+    mmsghdr messages[maxDatagramBatch] = {};
+    iovec vectors[maxDatagramBatch];
+    for (int i = 0; i < count; i++) {
+        vectors[i].iov_base = datagrams[i].data;
+        vectors[i].iov_len = datagrams[i].length;
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    const int received = ::recvmmsg(sock, messages, count, flags | MSG_WAITFORONE, nullptr);
+    for (int i = 0; i < received; i++) {
+        datagrams[i].length = messages[i].msg_len;
+    }
+    return received;
+#else
+    const ssize_t ret = recv(datagrams[0].data, datagrams[0].length, flags);
+    if (ret < 0) {
+        return -1;
+    }
+    datagrams[0].length = ret;
+    return 1;
+#endif
+}
+
+int Socket::sendDatagrams(const Datagram *datagrams, int count, int flags)
+{
+    int sent = 0;
+
+#if defined(__linux__)
+    mmsghdr messages[maxDatagramBatch] = {};
+    iovec vectors[maxDatagramBatch];
+    while (sent < count) {
+        const int batch = std::min(count - sent, maxDatagramBatch);
+        for (int i = 0; i < batch; i++) {
+            vectors[i].iov_base = datagrams[sent + i].data;
+            vectors[i].iov_len = datagrams[sent + i].length;
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        const int ret = ::sendmmsg(sock, messages, batch, flags);
+        if (ret <= 0) {
+            break;
+        }
+        sent += ret;
+        if (ret < batch) {
+            break;
+        }
+    }
+#else
+    for (; sent < count; sent++) {
+        if (send(datagrams[sent].data, datagrams[sent].length, flags) < 0) {
+            break;
+        }
+    }
+#endif
+
+    return (sent == 0 and count > 0) ? -1 : sent;
+}
+
 bool Socket::connect(const std::string& address, int port, int timeout)
 {
 #if defined(_WIN32)
@@ -223,6 +480,8 @@ bool Socket::connect(const std::string& address, int port, int timeout)
         if (sfd == -1)
             continue;
 
+        applyReceiveBufferSize(sfd, receiveBufferSize);
+
         // set the socket in non-blocking mode
 #ifdef _WIN32
         unsigned long mode = 1;
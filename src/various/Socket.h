@@ -43,6 +43,9 @@
     #ifndef MSG_NOSIGNAL
     # define MSG_NOSIGNAL 0
     #endif
+    #ifndef MSG_DONTWAIT
+    # define MSG_DONTWAIT 0
+    #endif
 #else
     #include <sys/socket.h>
     #include <netinet/in.h>
@@ -75,9 +78,48 @@ class Socket {
         Socket accept();
         bool connect(const std::string& address, int port, int timeout);
 
+        // Size of the kernel receive buffer, in bytes. It is applied before
+        // connecting so that TCP can scale its window to it. 0 keeps the
+        // system default.
+        void setReceiveBufferSize(int bytes);
+
+        // Let recv() and accept() give up with EAGAIN after timeout_ms
+        // milliseconds
+        bool setReceiveTimeout(int timeout_ms);
+
+        // Let send() give up after timeout_ms milliseconds
+        bool setSendTimeout(int timeout_ms);
+
         ssize_t recv(void *buffer, size_t length, int flags);
         ssize_t send(const void *buffer, size_t length, int flags);
 
+        // UDP socket bound to port that receives the datagrams sent to the
+        // IPv4 multicast group. The group is joined on the interface with
+        // the given local address, or on the default one if it is empty.
+        bool joinMulticastGroup(const std::string& group, int port,
+                const std::string& interfaceAddress);
+
+        // UDP socket that sends its datagrams to the multicast group, over
+        // at most ttl routers. It is non-blocking on Windows, which does
+        // not know MSG_DONTWAIT.
+        bool connectMulticastGroup(const std::string& group, int port,
+                const std::string& interfaceAddress, int ttl);
+
+        // One datagram of a batch. length is the size of data, and is set
+        // to the size of the datagram by recvDatagrams().
+        struct Datagram {
+            void *data;
+            size_t length;
+        };
+
+        // Receive or send up to count datagrams with a single recvmmsg() or
+        // sendmmsg() where they exist, one at a time elsewhere.
+        // recvDatagrams() only waits for the first one. Both return the
+        // number of datagrams, or -1 like recv().
+        int recvDatagrams(Datagram *datagrams, int count, int flags);
+        int sendDatagrams(const Datagram *datagrams, int count, int flags);
+
     private:
         int sock = INVALID_SOCKET;
+        int receiveBufferSize = 0;
 };
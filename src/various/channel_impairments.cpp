@@ -0,0 +1,479 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include "channel_impairments.h"
+
+namespace {
+
+// Fractional resampler, taps per output sample and number of fractions
+// of a sample the taps are computed for
+const int resamplerLength = 16;
+const int resamplerPhases = 1024;
+
+// Blocks over which the multipath taps keep the same phase increment
+const size_t tapBlock = 64;
+
+// ln(x) for normal x > 0, with an error below 1e-6
+inline float fastLog(float x)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    const int exponent = (int)(bits >> 23) - 127;
+    bits = (bits & 0x007FFFFF) | 0x3F800000;
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+
+    // ln(m) = 2 atanh((m - 1) / (m + 1)), with m in [1, 2[
+    const float t = (m - 1) / (m + 1);
+    const float t2 = t * t;
+    const float p = 2.0f + t2 * (2.0f / 3 + t2 * (2.0f / 5 +
+                t2 * (2.0f / 7 + t2 * (2.0f / 9))));
+    return exponent * 0.69314718f + t * p;
+}
+
+// sqrt(x) for x > 0. std::sqrt keeps the loops it is in from being
+// vectorised unless errno is disabled.
+inline float fastSqrt(float x)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    bits = 0x5F375A86 - (bits >> 1);
+    float r;
+    std::memcpy(&r, &bits, sizeof(r));
+
+    // Newton iterations of 1 / sqrt(x)
+    r = r * (1.5f - 0.5f * x * r * r);
+    r = r * (1.5f - 0.5f * x * r * r);
+    r = r * (1.5f - 0.5f * x * r * r);
+    return x * r;
+}
+
+// Complex multiplication over interleaved floats, which the compiler
+// vectorises, unlike std::complex with its checks for infinity
+inline void multiplyAccumulate(float *out, const float *in, size_t count,
+        float gr, float gi)
+{
+    for (size_t i = 0; i < count; i++) {
+        const float re = in[2 * i];
+        const float im = in[2 * i + 1];
+        out[2 * i] += gr * re - gi * im;
+        out[2 * i + 1] += gr * im + gi * re;
+    }
+}
+
+float parseNumber(const std::string& value, const std::string& spec)
+{
+    try {
+        size_t used = 0;
+        const float v = std::stof(value, &used);
+        if (used == value.size())
+            return v;
+    }
+    catch (const std::exception&) {
+    }
+    throw std::invalid_argument("Impairments: cannot parse '" + value +
+            "' in '" + spec + "'");
+}
+
+std::vector<std::string> split(const std::string& s, char separator)
+{
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, separator)) {
+        parts.push_back(part);
+    }
+    return parts;
+}
+
+}
+
+ImpairmentSettings ImpairmentSettings::parse(const std::string& spec)
+{
+    ImpairmentSettings settings;
+
+    for (const auto& item : split(spec, ',')) {
+        const auto equals = item.find('=');
+        if (equals == std::string::npos) {
+            throw std::invalid_argument("Impairments: expected key=value instead of '" +
+                    item + "'");
+        }
+        const std::string key = item.substr(0, equals);
+        const auto values = split(item.substr(equals + 1), ':');
+        if (values.empty()) {
+            throw std::invalid_argument("Impairments: no value for " + key);
+        }
+
+        std::vector<float> v;
+        for (const auto& value : values) {
+            v.push_back(parseNumber(value, spec));
+        }
+
+        if (key == "snr" and v.size() == 1) {
+            settings.snr = v[0];
+        }
+        else if (key == "cfo" and v.size() == 1) {
+            settings.frequencyOffset = v[0];
+        }
+        else if (key == "sco" and v.size() == 1) {
+            settings.sampleClockOffset = v[0];
+        }
+        else if (key == "iq" and v.size() == 2) {
+            settings.iqGainImbalance = v[0];
+            settings.iqPhaseImbalance = v[1];
+        }
+        else if (key == "seed" and v.size() == 1) {
+            settings.seed = v[0];
+        }
+        else if (key == "path" and v.size() >= 2 and v.size() <= 4) {
+            ImpairmentPath path;
+            path.delay = v[0];
+            path.gain = v[1];
+            path.doppler = v.size() > 2 ? v[2] : 0;
+            path.phase = v.size() > 3 ? v[3] : 0;
+            if (path.delay < 0 or path.delay != v[0]) {
+                throw std::invalid_argument("Impairments: path delays are whole samples");
+            }
+            settings.paths.push_back(path);
+        }
+        else {
+            throw std::invalid_argument("Impairments: invalid setting '" + item + "'");
+        }
+    }
+
+    return settings;
+}
+
+std::string ImpairmentSettings::describe() const
+{
+    std::stringstream ss;
+    if (std::isfinite(snr))
+        ss << "SNR " << snr << " dB, ";
+    for (const auto& path : paths) {
+        ss << "path " << path.delay << " samples " << path.gain << " dB";
+        if (path.doppler != 0)
+            ss << " " << path.doppler << " Hz";
+        ss << ", ";
+    }
+    if (frequencyOffset != 0)
+        ss << "CFO " << frequencyOffset << " Hz, ";
+    if (sampleClockOffset != 0)
+        ss << "SCO " << sampleClockOffset << " ppm, ";
+    if (iqGainImbalance != 0 or iqPhaseImbalance != 0)
+        ss << "IQ imbalance " << iqGainImbalance << " dB " << iqPhaseImbalance << " deg, ";
+
+    std::string s = ss.str();
+    if (s.empty())
+        return "none";
+    return s.substr(0, s.size() - 2);
+}
+
+GaussianNoise::GaussianNoise(uint32_t seed)
+{
+    // splitmix32 spreads the seed over the states of all lanes
+    uint32_t x = seed;
+    auto next = [&x]() {
+        x += 0x9E3779B9;
+        uint32_t z = x;
+        z = (z ^ (z >> 16)) * 0x85EBCA6B;
+        z = (z ^ (z >> 13)) * 0xC2B2AE35;
+        return z ^ (z >> 16);
+    };
+
+    for (size_t l = 0; l < lanes; l++) {
+        s0[l] = next();
+        s1[l] = next();
+        s2[l] = next();
+        s3[l] = next() | 1;
+    }
+}
+
+void GaussianNoise::generate()
+{
+    // xoshiro128+, one generator per lane, on local copies of the state
+    // so that the compiler sees that nothing aliases
+    uint32_t a[lanes], b[lanes], c[lanes], d[lanes];
+    std::copy(s0, s0 + lanes, a);
+    std::copy(s1, s1 + lanes, b);
+    std::copy(s2, s2 + lanes, c);
+    std::copy(s3, s3 + lanes, d);
+
+    uint32_t r1[block], r2[block];
+    for (size_t n = 0; n < block; n += lanes) {
+        for (size_t l = 0; l < lanes; l++) {
+            r1[n + l] = a[l] + d[l];
+            uint32_t t = b[l] << 9;
+            c[l] ^= a[l];
+            d[l] ^= b[l];
+            b[l] ^= c[l];
+            a[l] ^= d[l];
+            c[l] ^= t;
+            d[l] = (d[l] << 11) | (d[l] >> 21);
+
+            r2[n + l] = a[l] + d[l];
+            t = b[l] << 9;
+            c[l] ^= a[l];
+            d[l] ^= b[l];
+            b[l] ^= c[l];
+            a[l] ^= d[l];
+            c[l] ^= t;
+            d[l] = (d[l] << 11) | (d[l] >> 21);
+        }
+    }
+
+    std::copy(a, a + lanes, s0);
+    std::copy(b, b + lanes, s1);
+    std::copy(c, c + lanes, s2);
+    std::copy(d, d + lanes, s3);
+
+    // Box-Muller. The angle is drawn within a quarter turn, around
+    // which two random signs spread it. Only the upper bits are used,
+    // the lowest ones of xoshiro128+ are weak.
+    const float sqrtHalf = 0.70710678f;
+    for (size_t i = 0; i < block; i++) {
+        const float u = ((r1[i] >> 8) + 0.5f) * (1.0f / 16777216.0f);
+        const float radius = fastSqrt(-2.0f * fastLog(u));
+
+        const float x = (r2[i] >> 9) * (1.5707963f / 8388608.0f) - 0.78539816f;
+        const float x2 = x * x;
+        const float sx = x * (1 - x2 / 6 * (1 - x2 / 20 * (1 - x2 / 42 * (1 - x2 / 72))));
+        const float cx = 1 - x2 / 2 * (1 - x2 / 12 * (1 - x2 / 30 * (1 - x2 / 56)));
+
+        const float signI = 1.0f - 2.0f * ((r2[i] >> 8) & 1);
+        const float signQ = 1.0f - 2.0f * ((r1[i] >> 7) & 1);
+        noiseI[i] = signI * radius * (cx - sx) * sqrtHalf;
+        noiseQ[i] = signQ * radius * (cx + sx) * sqrtHalf;
+    }
+    used = 0;
+}
+
+void GaussianNoise::add(DSPCOMPLEX *samples, size_t count, float stddev)
+{
+    float *s = reinterpret_cast<float*>(samples);
+
+    size_t i = 0;
+    while (i < count) {
+        if (used == block)
+            generate();
+
+        const size_t n = std::min(block - used, count - i);
+        for (size_t j = 0; j < n; j++) {
+            s[2 * (i + j)] += stddev * noiseI[used + j];
+            s[2 * (i + j) + 1] += stddev * noiseQ[used + j];
+        }
+        used += n;
+        i += n;
+    }
+}
+
+ChannelImpairments::ChannelImpairments(const ImpairmentSettings& settings,
+        float sampleRate) :
+    settings(settings),
+    sampleRate(sampleRate),
+    noise(settings.seed),
+    frequencyShift(sampleRate)
+{
+    if (settings.sampleClockOffset != 0) {
+        // The receiver takes its samples 1 + offset times as often
+        resamplerStep = 1.0 / (1.0 + settings.sampleClockOffset * 1e-6);
+
+        // Windowed sinc for every fraction, normalised to unity gain.
+        // Blackman-Harris keeps the error below -60 dB up to the edge of
+        // the DAB signal at 0.375 of the sample rate.
+        resamplerTaps.resize((resamplerPhases + 1) * resamplerLength);
+        const int half = resamplerLength / 2;
+        for (int p = 0; p <= resamplerPhases; p++) {
+            const double frac = (double)p / resamplerPhases;
+            float *taps = &resamplerTaps[p * resamplerLength];
+            double sum = 0;
+            for (int k = 0; k < resamplerLength; k++) {
+                const double t = k - (half - 1) - frac;
+                const double sinc = t == 0 ? 1 : std::sin(M_PI * t) / (M_PI * t);
+                const double w = 2 * M_PI * (t + half) / (2 * half);
+                const double window = 0.35875 - 0.48829 * std::cos(w) +
+                    0.14128 * std::cos(2 * w) - 0.01168 * std::cos(3 * w);
+                taps[k] = sinc * window;
+                sum += taps[k];
+            }
+            for (int k = 0; k < resamplerLength; k++) {
+                taps[k] /= sum;
+            }
+        }
+
+        resamplerInput.assign(half - 1, DSPCOMPLEX(0, 0));
+        resamplerPosition = half - 1;
+    }
+
+    for (const auto& path : settings.paths) {
+        maxDelay = std::max(maxDelay, path.delay);
+        tapGains.push_back(std::polar(std::pow(10.0f, path.gain / 20),
+                    path.phase * (float)M_PI / 180));
+        tapRotations.push_back(std::polar(1.0f,
+                    (float)(2 * M_PI * path.doppler * tapBlock / sampleRate)));
+    }
+    multipathInput.assign(maxDelay, DSPCOMPLEX(0, 0));
+
+    frequencyShift.setFrequency(settings.frequencyOffset);
+}
+
+void ChannelImpairments::process(const DSPCOMPLEX *in, size_t count,
+        std::vector<DSPCOMPLEX>& out)
+{
+    const size_t start = out.size();
+    if (resamplerTaps.empty()) {
+        out.insert(out.end(), in, in + count);
+    }
+    else {
+        resample(in, count, out);
+    }
+
+    // The other stages work in place
+    DSPCOMPLEX *samples = out.data() + start;
+    const size_t n = out.size() - start;
+    applyMultipath(samples, n);
+    addNoise(samples, n);
+    rotate(samples, n);
+    applyIqImbalance(samples, n);
+}
+
+void ChannelImpairments::resample(const DSPCOMPLEX *in, size_t count,
+        std::vector<DSPCOMPLEX>& out)
+{
+    const int half = resamplerLength / 2;
+    resamplerInput.insert(resamplerInput.end(), in, in + count);
+
+    // Output sample at resamplerPosition uses the input samples from
+    // half - 1 before to half after it
+    const double end = (double)resamplerInput.size() - half;
+    const size_t start = out.size();
+    const double available = std::max(0.0, end - resamplerPosition);
+    out.resize(start + (size_t)(available / resamplerStep) + 2);
+
+    const float *input = reinterpret_cast<const float*>(resamplerInput.data());
+    float *output = reinterpret_cast<float*>(out.data() + start);
+    size_t produced = 0;
+    while (resamplerPosition < end) {
+        const size_t index = (size_t)resamplerPosition;
+        const int phase = (int)((resamplerPosition - index) * resamplerPhases + 0.5);
+        const float *taps = &resamplerTaps[phase * resamplerLength];
+        const float *x = input + 2 * (index - (half - 1));
+
+        float re = 0, im = 0;
+        for (int k = 0; k < resamplerLength; k++) {
+            re += taps[k] * x[2 * k];
+            im += taps[k] * x[2 * k + 1];
+        }
+        output[2 * produced] = re;
+        output[2 * produced + 1] = im;
+        produced++;
+        resamplerPosition += resamplerStep;
+    }
+    out.resize(start + produced);
+
+    const size_t consumed = (size_t)resamplerPosition - (half - 1);
+    resamplerInput.erase(resamplerInput.begin(), resamplerInput.begin() + consumed);
+    resamplerPosition -= consumed;
+}
+
+void ChannelImpairments::applyMultipath(DSPCOMPLEX *samples, size_t n)
+{
+    if (settings.paths.empty())
+        return;
+
+    multipathInput.insert(multipathInput.end(), samples, samples + n);
+    std::fill(samples, samples + n, DSPCOMPLEX(0, 0));
+
+    float *out = reinterpret_cast<float*>(samples);
+    for (size_t k = 0; k < settings.paths.size(); k++) {
+        const float *x = reinterpret_cast<const float*>(
+                multipathInput.data() + maxDelay - settings.paths[k].delay);
+
+        auto& gain = tapGains[k];
+        for (size_t b = 0; b < n; b += tapBlock) {
+            const size_t length = std::min(tapBlock, n - b);
+            multiplyAccumulate(out + 2 * b, x + 2 * b, length,
+                    gain.real(), gain.imag());
+            gain *= tapRotations[k];
+        }
+
+        // Keep rounding errors from changing the gain
+        gain *= std::pow(10.0f, settings.paths[k].gain / 20) / std::abs(gain);
+    }
+
+    multipathInput.erase(multipathInput.begin(), multipathInput.end() - maxDelay);
+}
+
+void ChannelImpairments::addNoise(DSPCOMPLEX *samples, size_t n)
+{
+    if (not std::isfinite(settings.snr) or n == 0)
+        return;
+
+    const float *s = reinterpret_cast<const float*>(samples);
+    float energy = 0;
+    for (size_t i = 0; i < 2 * n; i++) {
+        energy += s[i] * s[i];
+    }
+
+    // Cumulative mean at first, then an average over about a second
+    powerSamples += n;
+    const float weight = std::min(1.0f, (float)n /
+            std::min((float)powerSamples, sampleRate));
+    signalPower += (energy / n - signalPower) * weight;
+
+    const float noisePower = signalPower / std::pow(10.0f, settings.snr / 10);
+    noise.add(samples, n, std::sqrt(noisePower / 2));
+}
+
+void ChannelImpairments::rotate(DSPCOMPLEX *samples, size_t n)
+{
+    if (settings.frequencyOffset != 0) {
+        frequencyShift.process(samples, n);
+    }
+}
+
+void ChannelImpairments::applyIqImbalance(DSPCOMPLEX *samples, size_t n)
+{
+    if (settings.iqGainImbalance == 0 and settings.iqPhaseImbalance == 0)
+        return;
+
+    const float gainI = std::pow(10.0f, settings.iqGainImbalance / 40);
+    const float gainQ = 1 / gainI;
+    const float phi = settings.iqPhaseImbalance * (float)M_PI / 180;
+    const float cosPhi = gainQ * std::cos(phi);
+    const float sinPhi = gainQ * std::sin(phi);
+
+    float *s = reinterpret_cast<float*>(samples);
+    for (size_t i = 0; i < n; i++) {
+        const float re = s[2 * i];
+        const float im = s[2 * i + 1];
+        s[2 * i] = gainI * re;
+        s[2 * i + 1] = cosPhi * im - sinPhi * re;
+    }
+}
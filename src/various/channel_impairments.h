@@ -0,0 +1,152 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef CHANNEL_IMPAIRMENTS_H
+#define CHANNEL_IMPAIRMENTS_H
+
+// Simulation of the propagation channel and of the receiver front-end,
+// to measure the sensitivity of the receiver on clean recordings or on
+// the signal of the generator input. The stages are applied in this
+// order:
+//
+//  - sample clock offset, with a windowed-sinc fractional resampler
+//  - multipath, a sparse FIR filter whose taps may rotate with their
+//    own Doppler frequency
+//  - white gaussian noise at a given SNR
+//  - carrier frequency offset
+//  - IQ imbalance of the mixer
+//
+// All loops run over plain float arrays without dependencies between
+// the iterations, so that the compiler vectorises them. The noise comes
+// from several interleaved xoshiro128+ generators and a Box-Muller
+// transform with polynomial log, sin and cos. The frequency offset is
+// applied by an NCO.
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include "dab-constants.h"
+#include "nco.h"
+
+struct ImpairmentPath {
+    int delay = 0;          // In samples
+    float gain = 0;         // In dB
+    float phase = 0;        // In degrees
+    float doppler = 0;      // Rotation of the tap in Hz, 0 for a static tap
+};
+
+struct ImpairmentSettings {
+    // Relative to the mean power of the signal at the input of the noise
+    // stage. Infinity disables the noise.
+    float snr = std::numeric_limits<float>::infinity();
+
+    // An empty list leaves the signal as it is
+    std::vector<ImpairmentPath> paths;
+
+    float frequencyOffset = 0;      // In Hz
+    float sampleClockOffset = 0;    // In ppm, positive if the receiver is fast
+
+    // Amplitude of I over Q in dB, and error of the Q phase in degrees
+    float iqGainImbalance = 0;
+    float iqPhaseImbalance = 0;
+
+    uint32_t seed = 1;
+
+    // Parses a comma-separated list of
+    //  snr=<dB>, cfo=<Hz>, sco=<ppm>, iq=<dB>:<degrees>, seed=<n> and
+    //  path=<delay>:<gain dB>[:<Doppler Hz>[:<phase degrees>]]
+    // where path can be given several times. Throws std::invalid_argument.
+    static ImpairmentSettings parse(const std::string& spec);
+
+    std::string describe(void) const;
+};
+
+// Complex gaussian noise, independent on I and Q
+class GaussianNoise {
+public:
+    explicit GaussianNoise(uint32_t seed = 1);
+
+    // Adds noise with the given standard deviation on I and on Q
+    void add(DSPCOMPLEX *samples, size_t count, float stddev);
+
+private:
+    void generate(void);
+
+    // Independent generators, and the samples generated at once
+    static const size_t lanes = 16;
+    static const size_t block = 256;
+
+    uint32_t s0[lanes], s1[lanes], s2[lanes], s3[lanes];
+    float noiseI[block], noiseQ[block];
+    size_t used = block;
+};
+
+class ChannelImpairments {
+public:
+    ChannelImpairments(const ImpairmentSettings& settings,
+            float sampleRate = INPUT_RATE);
+
+    // Applies the impairments to count samples and appends the result to
+    // out. Because of the sample clock offset, the number of samples
+    // appended may differ from count by a few.
+    void process(const DSPCOMPLEX *in, size_t count, std::vector<DSPCOMPLEX>& out);
+
+    const ImpairmentSettings& getSettings(void) const { return settings; }
+
+    // The mean power the noise level is based on
+    float getSignalPower(void) const { return signalPower; }
+
+private:
+    void resample(const DSPCOMPLEX *in, size_t count, std::vector<DSPCOMPLEX>& out);
+    void applyMultipath(DSPCOMPLEX *samples, size_t n);
+    void addNoise(DSPCOMPLEX *samples, size_t n);
+    void rotate(DSPCOMPLEX *samples, size_t n);
+    void applyIqImbalance(DSPCOMPLEX *samples, size_t n);
+
+    const ImpairmentSettings settings;
+    const float sampleRate;
+
+    // Resampler: one set of taps per fraction of a sample
+    std::vector<float> resamplerTaps;
+    std::vector<DSPCOMPLEX> resamplerInput;
+    double resamplerPosition = 0;
+    double resamplerStep = 1;
+
+    // Multipath: the last maxDelay input samples before the new ones
+    std::vector<DSPCOMPLEX> multipathInput;
+    std::vector<DSPCOMPLEX> tapGains;
+    std::vector<DSPCOMPLEX> tapRotations;  // Per block of tapBlock samples
+    int maxDelay = 0;
+
+    GaussianNoise noise;
+    float signalPower = 0;
+    uint64_t powerSamples = 0;
+
+    NCO frequencyShift;
+};
+
+#endif // CHANNEL_IMPAIRMENTS_H
@@ -0,0 +1,177 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "histogram_agc.h"
+
+// Three mantissa bits: eight bins per octave
+static const int mantissaShift = 20;
+
+static inline uint32_t floatBits(float f)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+AgcSettings AgcSettings::rtl2832()
+{
+    return AgcSettings(127.0f / 128.0f);
+}
+
+HistogramAgc::HistogramAgc(const AgcSettings& settings) :
+    settings(settings),
+    binWidth(20 * std::log10(2.0f) / 8),
+    clipBits(floatBits(settings.clipLevel))
+{
+    reset();
+}
+
+void HistogramAgc::reset()
+{
+    std::memset(counts, 0, sizeof(counts));
+    collected = 0;
+    holdOff = 0;
+    clipping = false;
+    wasClipping = false;
+}
+
+// Returns the number of the count samples that are skipped
+size_t HistogramAgc::skipHoldOff(size_t count)
+{
+    const size_t skipped = std::min(holdOff, count);
+    holdOff -= skipped;
+    return skipped;
+}
+
+// x holds n interleaved I/Q pairs, n is at most block
+void HistogramAgc::addBlock(const float *x, size_t n)
+{
+    const uint32_t clip = clipBits;
+    const uint32_t lastBin = numBins - 1;
+
+    // Bin 0 holds the clipped samples, bin k the samples between
+    // k - 1 and k bin widths below the clipping level
+    uint8_t bins[block];
+    for (size_t i = 0; i < n; i++) {
+        const float a = std::max(std::fabs(x[2 * i]), std::fabs(x[2 * i + 1]));
+        const uint32_t bits = floatBits(a);
+        const uint32_t below = ((clip - bits - 1) >> mantissaShift) + 1;
+        bins[i] = bits >= clip ? 0 : std::min(below, lastBin);
+    }
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        counts[0][bins[i]]++;
+        counts[1][bins[i + 1]]++;
+        counts[2][bins[i + 2]]++;
+        counts[3][bins[i + 3]]++;
+    }
+    for (; i < n; i++) {
+        counts[0][bins[i]]++;
+    }
+
+    collected += n;
+}
+
+bool HistogramAgc::add(const DSPCOMPLEX *samples, size_t count)
+{
+    const size_t skipped = skipHoldOff(count);
+    samples += skipped;
+    count -= skipped;
+
+    const float *s = reinterpret_cast<const float*>(samples);
+    for (size_t b = 0; b < count; b += block) {
+        addBlock(s + 2 * b, std::min(block, count - b));
+    }
+
+    return collected >= settings.interval;
+}
+
+bool HistogramAgc::addU8(const uint8_t *iq, size_t count)
+{
+    const size_t skipped = skipHoldOff(count);
+    iq += 2 * skipped;
+    count -= skipped;
+
+    float x[2 * block];
+    for (size_t b = 0; b < count; b += block) {
+        const size_t n = std::min(block, count - b);
+        const uint8_t *codes = iq + 2 * b;
+        for (size_t i = 0; i < 2 * n; i++) {
+            x[i] = codes[i] * (1.0f / 128.0f) - 1.0f;
+        }
+        addBlock(x, n);
+    }
+
+    return collected >= settings.interval;
+}
+
+AgcStep HistogramAgc::decide(float stepUp)
+{
+    uint32_t histogram[numBins];
+    for (size_t k = 0; k < numBins; k++) {
+        histogram[k] = counts[0][k] + counts[1][k] + counts[2][k] + counts[3][k];
+    }
+
+    const size_t total = std::max(collected, (size_t)1);
+    std::memset(counts, 0, sizeof(counts));
+    collected = 0;
+
+    wasClipping = clipping;
+    clipFraction = (float)histogram[0] / total;
+    clipping = clipFraction > settings.maxClipFraction;
+
+    // Walk down from the clipping level until the peak fraction of the
+    // samples lies above. The samples of bin k are at least k - 1 bin
+    // widths below the clipping level.
+    const size_t peakCount = settings.peakFraction * total;
+    size_t above = histogram[0];
+    size_t k = 1;
+    while (k < numBins - 1 and above + histogram[k] <= peakCount) {
+        above += histogram[k];
+        k++;
+    }
+    headroom = (k - 1) * binWidth;
+
+    if (clipping) {
+        return AgcStep::Down;
+    }
+
+    if (stepUp > 0 and headroom - stepUp >= settings.minHeadroom) {
+        return AgcStep::Up;
+    }
+
+    return AgcStep::Hold;
+}
+
+void HistogramAgc::gainChanged(size_t samplesInFlight)
+{
+    std::memset(counts, 0, sizeof(counts));
+    collected = 0;
+    holdOff = samplesInFlight + settings.settleTime;
+}
@@ -0,0 +1,125 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef HISTOGRAM_AGC_H
+#define HISTOGRAM_AGC_H
+
+// Software AGC for inputs with stepped tuner gains. The drivers hand it
+// the samples they convert anyway. It collects a histogram of the
+// sample amplitudes and, once per interval, decides on a gain step
+// from the fraction of clipped samples and the headroom left below
+// the clipping level.
+//
+// The histogram bins are derived from the bits of the float amplitude:
+// the exponent and the three upper mantissa bits give steps of about
+// 0.75 dB without calling log(), in a loop the compiler vectorises.
+
+#include <cstddef>
+#include <cstdint>
+#include "dab-constants.h"
+
+enum class AgcStep { Down, Hold, Up };
+
+struct AgcSettings {
+    explicit AgcSettings(float clipLevel = 1.0f) : clipLevel(clipLevel) {}
+
+    // Amplitude of I or Q at which the samples count as clipped
+    float clipLevel;
+
+    // More clipped samples than this fraction lower the gain
+    float maxClipFraction = 1e-4f;
+
+    // The peak is the amplitude exceeded by this fraction of the
+    // samples. The gain is raised if the peak stays minHeadroom dB
+    // below clipLevel after the step. The margin has to cover the
+    // distance between the two fractions, or the gain would go up and
+    // down in turn.
+    float peakFraction = 1e-3f;
+    float minHeadroom = 3.0f;
+
+    // Samples per decision, and samples to ignore after a gain change
+    // until the tuner has settled
+    size_t interval = INPUT_RATE / 20;
+    size_t settleTime = INPUT_RATE / 40;
+
+    // For the 8-bit ADC of the RTL2832U, as converted by iqconvert::fromU8:
+    // the outermost codes count as clipped
+    static AgcSettings rtl2832(void);
+};
+
+class HistogramAgc {
+public:
+    explicit HistogramAgc(const AgcSettings& settings = AgcSettings());
+
+    // Adds samples to the histogram. Returns true once interval samples
+    // were collected and decide() should be called.
+    bool add(const DSPCOMPLEX *samples, size_t count);
+
+    // The same for count unsigned 8-bit I/Q pairs as they come from the
+    // ADC, scaled like iqconvert::fromU8. Lets an input that corrects
+    // the samples count the clipping before the correction moves the
+    // outermost codes.
+    bool addU8(const uint8_t *iq, size_t count);
+
+    // Evaluates the histogram and starts a new one. stepUp is the gain
+    // increase of the next step in dB, 0 if the gain is at its maximum.
+    AgcStep decide(float stepUp);
+
+    // To be called after the gain was changed. The samples in flight,
+    // that were received with the previous gain, are not counted.
+    void gainChanged(size_t samplesInFlight);
+
+    void reset(void);
+
+    // Results of the last decision
+    bool isClipping(void) const { return clipping; }
+    bool clippingStarted(void) const { return clipping and not wasClipping; }
+    float getClipFraction(void) const { return clipFraction; }
+    float getHeadroom(void) const { return headroom; }
+
+private:
+    static const size_t numBins = 64;
+    static const size_t block = 256;
+
+    size_t skipHoldOff(size_t count);
+    void addBlock(const float *x, size_t n);
+
+    const AgcSettings settings;
+    const float binWidth;       // In dB
+    uint32_t clipBits;
+
+    // Four interleaved histograms avoid a dependency between consecutive
+    // increments of the same bin
+    uint32_t counts[4][numBins];
+    size_t collected = 0;
+    size_t holdOff = 0;
+
+    bool clipping = false;
+    bool wasClipping = false;
+    float clipFraction = 0;
+    float headroom = 0;
+};
+
+#endif // HISTOGRAM_AGC_H
@@ -0,0 +1,687 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "iq_container.h"
+
+#ifdef _WIN32
+#define fseeko _fseeki64
+#define ftello _ftelli64
+#endif
+
+static const uint8_t headerMagic[4] = {'W', 'I', 'Q', '1'};
+static const uint8_t indexMagic[4] = {'W', 'I', 'Q', 'X'};
+static const uint16_t containerVersion = 1;
+static const size_t headerSize = 64;
+static const size_t blockHeaderSize = 8;
+
+// Offsets of the fields completed by IQContainerWriter::close()
+static const size_t numSamplesOffset = 32;
+static const size_t indexOffsetOffset = 40;
+
+// 32 ms at 2.048 MS/s, the granularity of seeking
+static const uint32_t defaultSamplesPerBlock = 65536;
+
+// Predictor order and Rice parameter are chosen per partition
+static const uint32_t partitionSize = 4096;
+
+static const uint8_t methodVerbatim = 0;
+static const uint8_t methodRice = 1;
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++)
+        p[i] = v >> (8 * i);
+}
+
+static void put64(uint8_t *p, uint64_t v)
+{
+    for (int i = 0; i < 8; i++)
+        p[i] = v >> (8 * i);
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++)
+        v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+static uint64_t get64(const uint8_t *p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++)
+        v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+static inline int countLeadingZeros(uint64_t v)
+{
+#if defined(__GNUC__)
+    return __builtin_clzll(v);
+#else
+    int n = 0;
+    while (not (v & (1ULL << 63))) {
+        v <<= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+class BitWriter {
+public:
+    BitWriter(std::vector<uint8_t>& out) : out(out) {}
+
+    // count <= 32
+    void putBits(uint32_t value, int count) {
+        acc = (acc << count) | value;
+        bits += count;
+        while (bits >= 8) {
+            bits -= 8;
+            out.push_back(acc >> bits);
+        }
+    }
+
+    void putRice(uint32_t value, int k) {
+        uint32_t q = value >> k;
+        while (q >= 32) {
+            putBits(0, 32);
+            q -= 32;
+        }
+        putBits(1, q + 1);
+        if (k > 0)
+            putBits(value & ((1u << k) - 1), k);
+    }
+
+    void flush(void) {
+        if (bits > 0) {
+            out.push_back(acc << (8 - bits));
+            bits = 0;
+        }
+    }
+
+private:
+    std::vector<uint8_t>& out;
+    uint64_t acc = 0;
+    int bits = 0;
+};
+
+class BitReader {
+public:
+    BitReader(const uint8_t *data, size_t size) :
+        p(data), end(data + size), available(8 * (uint64_t)size) {}
+
+    // count <= 32
+    uint32_t getBits(int count) {
+        if (count == 0)
+            return 0;
+        refill();
+        const uint32_t v = acc >> (64 - count);
+        acc <<= count;
+        bits -= count;
+        consumed += count;
+        return v;
+    }
+
+    uint32_t getRice(int k) {
+        uint32_t q = 0;
+        for (;;) {
+            refill();
+            if (acc == 0) {
+                q += bits;
+                consumed += bits;
+                bits = 0;
+                if (not valid())
+                    return 0;
+                continue;
+            }
+            const int zeros = countLeadingZeros(acc);
+            q += zeros;
+            acc <<= zeros;
+            acc <<= 1;
+            bits -= zeros + 1;
+            consumed += zeros + 1;
+            break;
+        }
+        return (q << k) | getBits(k);
+    }
+
+    // False once more bits were taken than the payload holds
+    bool valid(void) const { return consumed <= available; }
+
+private:
+    void refill(void) {
+        // Past the end, the reader is fed with zeros
+        while (bits <= 56) {
+            const uint64_t byte = p < end ? *p++ : 0;
+            acc |= byte << (56 - bits);
+            bits += 8;
+        }
+    }
+
+    const uint8_t *p;
+    const uint8_t *end;
+    uint64_t available;
+    uint64_t consumed = 0;
+    uint64_t acc = 0;
+    int bits = 0;
+};
+
+static inline int32_t toSigned(uint8_t v, IQContainerFormat format)
+{
+    return format == IQContainerFormat::U8 ? (int32_t)v - 128 : (int8_t)v;
+}
+
+static inline uint8_t fromSigned(int32_t v, IQContainerFormat format)
+{
+    return format == IQContainerFormat::U8 ? v + 128 : (uint8_t)(int8_t)v;
+}
+
+static inline int32_t predict(int order, int32_t h1, int32_t h2)
+{
+    switch (order) {
+        case 1: return h1;
+        case 2: return 2 * h1 - h2;
+        default: return 0;
+    }
+}
+
+static inline uint32_t zigzag(int32_t e)
+{
+    return ((uint32_t)e << 1) ^ (uint32_t)(e >> 31);
+}
+
+// Compress n samples of one channel. h1 and h2 are the two previous
+// samples of the channel, zero at the start of a block.
+static void encodeChannel(BitWriter& bw, const int32_t *s, uint32_t n,
+        int32_t& h1, int32_t& h2, std::vector<uint32_t>& residual)
+{
+    uint64_t cost[3] = {0, 0, 0};
+    int32_t p1 = h1, p2 = h2;
+    for (uint32_t i = 0; i < n; i++) {
+        cost[0] += std::abs(s[i]);
+        cost[1] += std::abs(s[i] - p1);
+        cost[2] += std::abs(s[i] - 2 * p1 + p2);
+        p2 = p1;
+        p1 = s[i];
+    }
+    const int order = std::min_element(cost, cost + 3) - cost;
+
+    residual.resize(n);
+    uint64_t sum = 0;
+    p1 = h1;
+    p2 = h2;
+    for (uint32_t i = 0; i < n; i++) {
+        residual[i] = zigzag(s[i] - predict(order, p1, p2));
+        sum += residual[i];
+        p2 = p1;
+        p1 = s[i];
+    }
+    h1 = p1;
+    h2 = p2;
+
+    // The mean residual gives a first estimate of the Rice parameter,
+    // the neighbours are tried as well
+    int estimate = 0;
+    while (estimate < 14 and ((uint64_t)n << (estimate + 1)) < sum)
+        estimate++;
+
+    int k = estimate;
+    uint64_t bestBits = UINT64_MAX;
+    for (int candidate = std::max(0, estimate - 1);
+            candidate <= std::min(15, estimate + 1); candidate++) {
+        uint64_t bits = (uint64_t)n * (candidate + 1);
+        for (uint32_t i = 0; i < n; i++)
+            bits += residual[i] >> candidate;
+        if (bits < bestBits) {
+            bestBits = bits;
+            k = candidate;
+        }
+    }
+
+    bw.putBits(order, 2);
+    bw.putBits(k, 4);
+    for (uint32_t i = 0; i < n; i++)
+        bw.putRice(residual[i], k);
+}
+
+static bool decodeChannel(BitReader& br, uint8_t *out, uint32_t n,
+        int32_t& h1, int32_t& h2, IQContainerFormat format)
+{
+    const int order = br.getBits(2);
+    const int k = br.getBits(4);
+    if (order > 2)
+        return false;
+
+    int32_t p1 = h1, p2 = h2;
+    for (uint32_t i = 0; i < n; i++) {
+        const uint32_t u = br.getRice(k);
+        const int32_t e = (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+        const int32_t s = e + predict(order, p1, p2);
+        if (s < -128 or s > 127)
+            return false;
+        out[2 * i] = fromSigned(s, format);
+        p2 = p1;
+        p1 = s;
+    }
+    h1 = p1;
+    h2 = p2;
+    return br.valid();
+}
+
+static void compressBlock(const uint8_t *iq, uint32_t samples,
+        IQContainerFormat format, std::vector<uint8_t>& payload)
+{
+    payload.clear();
+    payload.push_back(methodRice);
+
+    BitWriter bw(payload);
+    std::vector<int32_t> channel(partitionSize);
+    std::vector<uint32_t> residual(partitionSize);
+    int32_t h1[2] = {0, 0};
+    int32_t h2[2] = {0, 0};
+
+    for (uint32_t start = 0; start < samples; start += partitionSize) {
+        const uint32_t n = std::min(partitionSize, samples - start);
+        for (int c = 0; c < 2; c++) {
+            for (uint32_t i = 0; i < n; i++)
+                channel[i] = toSigned(iq[2 * (start + i) + c], format);
+            encodeChannel(bw, channel.data(), n, h1[c], h2[c], residual);
+        }
+    }
+    bw.flush();
+
+    if (payload.size() > 1 + 2 * (size_t)samples) {
+        payload.assign(1, methodVerbatim);
+        payload.insert(payload.end(), iq, iq + 2 * samples);
+    }
+}
+
+static bool decompressBlock(const std::vector<uint8_t>& payload,
+        uint32_t samples, IQContainerFormat format,
+        std::vector<uint8_t>& iq)
+{
+    iq.resize(2 * samples);
+
+    if (payload.empty())
+        return false;
+
+    if (payload[0] == methodVerbatim) {
+        if (payload.size() != 1 + iq.size())
+            return false;
+        std::copy(payload.begin() + 1, payload.end(), iq.begin());
+        return true;
+    }
+    else if (payload[0] != methodRice) {
+        return false;
+    }
+
+    BitReader br(payload.data() + 1, payload.size() - 1);
+    int32_t h1[2] = {0, 0};
+    int32_t h2[2] = {0, 0};
+
+    for (uint32_t start = 0; start < samples; start += partitionSize) {
+        const uint32_t n = std::min(partitionSize, samples - start);
+        for (int c = 0; c < 2; c++) {
+            if (not decodeChannel(br, &iq[2 * start + c], n,
+                        h1[c], h2[c], format)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool parseIQContainerFormat(const std::string& name, IQContainerFormat& format)
+{
+    if (name == "u8") {
+        format = IQContainerFormat::U8;
+        return true;
+    }
+    else if (name == "s8") {
+        format = IQContainerFormat::S8;
+        return true;
+    }
+    return false;
+}
+
+IQContainerWriter::~IQContainerWriter()
+{
+    close();
+}
+
+bool IQContainerWriter::open(const std::string& fileName,
+        const IQContainerInfo& info)
+{
+    close();
+
+    file = fopen(fileName.c_str(), "wb");
+    if (file == nullptr) {
+        std::clog << "IQContainer: Cannot create file: " << fileName << std::endl;
+        return false;
+    }
+
+    this->info = info;
+    pending.clear();
+    blockOffsets.clear();
+    numSamples = 0;
+
+    // The number of samples and the index offset stay zero until close()
+    uint8_t header[headerSize] = {0};
+    std::copy(headerMagic, headerMagic + 4, header);
+    put16(header + 4, containerVersion);
+    put16(header + 6, headerSize);
+    header[8] = static_cast<uint8_t>(info.format);
+    put32(header + 12, info.sampleRate);
+    put32(header + 16, info.centreFrequency);
+    put32(header + 20, defaultSamplesPerBlock);
+    put64(header + 24, info.captureTime);
+
+    if (fwrite(header, sizeof(header), 1, file) != 1) {
+        std::clog << "IQContainer: Cannot write header" << std::endl;
+        fclose(file);
+        file = nullptr;
+        return false;
+    }
+
+    fileOffset = headerSize;
+    return true;
+}
+
+bool IQContainerWriter::write(const uint8_t *data, size_t length)
+{
+    if (file == nullptr)
+        return false;
+
+    pending.insert(pending.end(), data, data + length);
+
+    const size_t blockBytes = 2 * (size_t)defaultSamplesPerBlock;
+    size_t done = 0;
+    bool ok = true;
+    while (ok and pending.size() - done >= blockBytes) {
+        ok = writeBlock(pending.data() + done, defaultSamplesPerBlock);
+        done += blockBytes;
+    }
+    pending.erase(pending.begin(), pending.begin() + done);
+
+    return ok;
+}
+
+bool IQContainerWriter::writeBlock(const uint8_t *iq, uint32_t samples)
+{
+    compressBlock(iq, samples, info.format, payload);
+
+    uint8_t blockHeader[blockHeaderSize];
+    put32(blockHeader, payload.size());
+    put32(blockHeader + 4, samples);
+
+    if (fwrite(blockHeader, sizeof(blockHeader), 1, file) != 1 or
+            fwrite(payload.data(), payload.size(), 1, file) != 1) {
+        std::clog << "IQContainer: Write error" << std::endl;
+        return false;
+    }
+
+    blockOffsets.push_back(fileOffset);
+    fileOffset += blockHeaderSize + payload.size();
+    numSamples += samples;
+    return true;
+}
+
+bool IQContainerWriter::close()
+{
+    if (file == nullptr)
+        return false;
+
+    // A trailing incomplete IQ sample is dropped
+    bool ok = true;
+    if (pending.size() >= 2)
+        ok = writeBlock(pending.data(), pending.size() / 2);
+    pending.clear();
+
+    const uint64_t indexOffset = fileOffset;
+    std::vector<uint8_t> index(8 + 8 * blockOffsets.size());
+    std::copy(indexMagic, indexMagic + 4, index.begin());
+    put32(&index[4], blockOffsets.size());
+    for (size_t i = 0; i < blockOffsets.size(); i++)
+        put64(&index[8 + 8 * i], blockOffsets[i]);
+
+    uint8_t tail[16];
+    put64(tail, numSamples);
+    put64(tail + 8, indexOffset);
+
+    ok = ok and fwrite(index.data(), index.size(), 1, file) == 1 and
+        fseeko(file, numSamplesOffset, SEEK_SET) == 0 and
+        fwrite(tail, sizeof(tail), 1, file) == 1;
+    fileOffset += index.size();
+
+    if (fclose(file) != 0)
+        ok = false;
+    file = nullptr;
+
+    if (not ok)
+        std::clog << "IQContainer: Could not complete the file" << std::endl;
+    return ok;
+}
+
+bool IQContainerReader::open(FILE *file)
+{
+    this->file = file;
+    blockOffsets.clear();
+    blockLoaded = false;
+
+    uint8_t header[headerSize];
+    if (fseeko(file, 0, SEEK_SET) != 0 or
+            fread(header, sizeof(header), 1, file) != 1 or
+            not std::equal(headerMagic, headerMagic + 4, header)) {
+        return false;
+    }
+
+    if (get16(header + 4) > containerVersion) {
+        std::clog << "IQContainer: Unsupported version " <<
+            get16(header + 4) << std::endl;
+        return false;
+    }
+
+    info.format = static_cast<IQContainerFormat>(header[8]);
+    if (info.format != IQContainerFormat::U8 and
+            info.format != IQContainerFormat::S8) {
+        std::clog << "IQContainer: Unknown sample format" << std::endl;
+        return false;
+    }
+
+    info.sampleRate = get32(header + 12);
+    info.centreFrequency = get32(header + 16);
+    samplesPerBlock = get32(header + 20);
+    info.captureTime = get64(header + 24);
+    info.numSamples = get64(header + numSamplesOffset);
+    const uint64_t indexOffset = get64(header + indexOffsetOffset);
+
+    if (samplesPerBlock == 0)
+        return false;
+
+    if (indexOffset == 0 or not loadIndex(indexOffset)) {
+        std::clog << "IQContainer: No index, the recording was not " <<
+            "closed properly. Rebuilding it." << std::endl;
+        if (not rebuildIndex())
+            return false;
+    }
+
+    return seek(0);
+}
+
+bool IQContainerReader::loadIndex(uint64_t indexOffset)
+{
+    uint8_t indexHeader[8];
+    if (fseeko(file, indexOffset, SEEK_SET) != 0 or
+            fread(indexHeader, sizeof(indexHeader), 1, file) != 1 or
+            not std::equal(indexMagic, indexMagic + 4, indexHeader)) {
+        return false;
+    }
+
+    const uint32_t count = get32(indexHeader + 4);
+    if (count != (info.numSamples + samplesPerBlock - 1) / samplesPerBlock)
+        return false;
+
+    std::vector<uint8_t> index(8 * (size_t)count);
+    if (count > 0 and fread(index.data(), index.size(), 1, file) != 1)
+        return false;
+
+    blockOffsets.resize(count);
+    for (size_t i = 0; i < count; i++)
+        blockOffsets[i] = get64(&index[8 * i]);
+
+    return true;
+}
+
+bool IQContainerReader::rebuildIndex()
+{
+    if (fseeko(file, 0, SEEK_END) != 0)
+        return false;
+    const uint64_t fileSize = ftello(file);
+
+    blockOffsets.clear();
+    info.numSamples = 0;
+
+    // Stop at the first incomplete or implausible block
+    uint64_t offset = headerSize;
+    for (;;) {
+        uint8_t blockHeader[blockHeaderSize];
+        if (fseeko(file, offset, SEEK_SET) != 0 or
+                fread(blockHeader, sizeof(blockHeader), 1, file) != 1) {
+            break;
+        }
+
+        const uint32_t size = get32(blockHeader);
+        const uint32_t samples = get32(blockHeader + 4);
+        if (samples == 0 or samples > samplesPerBlock or
+                offset + blockHeaderSize + size > fileSize) {
+            break;
+        }
+
+        blockOffsets.push_back(offset);
+        info.numSamples += samples;
+        offset += blockHeaderSize + size;
+
+        if (samples < samplesPerBlock)
+            break;
+    }
+
+    return true;
+}
+
+bool IQContainerReader::loadBlock(size_t block)
+{
+    uint8_t blockHeader[blockHeaderSize];
+    if (fseeko(file, blockOffsets[block], SEEK_SET) != 0 or
+            fread(blockHeader, sizeof(blockHeader), 1, file) != 1) {
+        std::clog << "IQContainer: Cannot read block " << block << std::endl;
+        return false;
+    }
+
+    const uint32_t size = get32(blockHeader);
+    const uint32_t samples = get32(blockHeader + 4);
+    if (samples > samplesPerBlock) {
+        std::clog << "IQContainer: Corrupt block " << block << std::endl;
+        return false;
+    }
+
+    payload.resize(size);
+    if (size > 0 and fread(payload.data(), size, 1, file) != 1) {
+        std::clog << "IQContainer: Cannot read block " << block << std::endl;
+        return false;
+    }
+
+    if (not decompressBlock(payload, samples, info.format, decoded)) {
+        std::clog << "IQContainer: Corrupt block " << block << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+size_t IQContainerReader::read(uint8_t *data, size_t length)
+{
+    size_t done = 0;
+
+    while (done < length) {
+        if (not blockLoaded) {
+            if (currentBlock >= blockOffsets.size() or
+                    not loadBlock(currentBlock)) {
+                break;
+            }
+            blockLoaded = true;
+        }
+
+        if (decodedPos >= decoded.size()) {
+            currentBlock++;
+            blockLoaded = false;
+            decodedPos = 0;
+            continue;
+        }
+
+        const size_t n = std::min(length - done, decoded.size() - decodedPos);
+        std::copy(decoded.begin() + decodedPos,
+                decoded.begin() + decodedPos + n, data + done);
+        decodedPos += n;
+        done += n;
+    }
+
+    return done;
+}
+
+bool IQContainerReader::seek(int64_t samplePosition)
+{
+    if (file == nullptr or samplePosition < 0)
+        return false;
+
+    samplePosition = std::min(samplePosition, info.numSamples);
+    currentBlock = samplePosition / samplesPerBlock;
+    decodedPos = 2 * (samplePosition % samplesPerBlock);
+    blockLoaded = false;
+    return true;
+}
+
+int64_t IQContainerReader::getSamplePosition() const
+{
+    return (int64_t)currentBlock * samplesPerBlock + decodedPos / 2;
+}
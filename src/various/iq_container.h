@@ -0,0 +1,137 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef IQ_CONTAINER_H
+#define IQ_CONTAINER_H
+
+// Chunked, losslessly compressed container for 8-bit I/Q recordings,
+// usually with the extension .wiq.
+//
+// File layout, all integers are little endian:
+//
+//   header   64 bytes: magic "WIQ1", version, sample format, sample
+//            rate, centre frequency, samples per block, capture time,
+//            number of samples and offset of the index
+//   blocks   uint32 payload size, uint32 number of samples, payload
+//   index    magic "WIQX", uint32 number of blocks, uint64 offset of
+//            every block
+//
+// All blocks but the last hold the same number of samples and are
+// compressed independently, so seeking to a sample only needs one
+// lookup in the index. A recording that was not closed properly has
+// no index, it is rebuilt from the block headers when reading.
+//
+// I and Q are compressed separately in the style of FLAC: every
+// partition of a block selects the fixed predictor of order 0, 1 or 2
+// that gives the smallest residual, and Rice codes the residual with
+// the best parameter for the partition. Blocks that do not compress
+// are stored verbatim.
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+enum class IQContainerFormat : uint8_t { U8 = 1, S8 = 2 };
+
+struct IQContainerInfo {
+    IQContainerFormat format = IQContainerFormat::U8;
+    uint32_t sampleRate = 2048000;
+    uint32_t centreFrequency = 0;   // Hz, 0 if unknown
+    int64_t captureTime = 0;        // Microseconds since the Unix epoch
+    int64_t numSamples = 0;         // Set by the reader
+};
+
+// Parse "u8" or "s8", the formats the container can hold
+bool parseIQContainerFormat(const std::string& name, IQContainerFormat& format);
+
+class IQContainerWriter {
+public:
+    IQContainerWriter() = default;
+    ~IQContainerWriter();
+    IQContainerWriter(const IQContainerWriter&) = delete;
+    IQContainerWriter& operator=(const IQContainerWriter&) = delete;
+
+    bool open(const std::string& fileName, const IQContainerInfo& info);
+    bool isOpen(void) const { return file != nullptr; }
+
+    // Append interleaved 8-bit I/Q, length is in bytes. Complete blocks
+    // are compressed and written to the file right away.
+    bool write(const uint8_t *data, size_t length);
+
+    // Write the last block and the index, and complete the header
+    bool close(void);
+
+    int64_t getNumSamples(void) const { return numSamples; }
+    uint64_t getFileSize(void) const { return fileOffset; }
+
+private:
+    bool writeBlock(const uint8_t *iq, uint32_t samples);
+
+    FILE *file = nullptr;
+    IQContainerInfo info;
+    std::vector<uint8_t> pending;
+    std::vector<uint8_t> payload;
+    std::vector<uint64_t> blockOffsets;
+    uint64_t fileOffset = 0;
+    int64_t numSamples = 0;
+};
+
+class IQContainerReader {
+public:
+    // Check the header of file and load the index. The file stays
+    // owned by the caller. Returns false if this is not a container;
+    // the file position is undefined in that case.
+    bool open(FILE *file);
+
+    const IQContainerInfo& getInfo(void) const { return info; }
+
+    // Decode up to length bytes of interleaved I/Q. Returns the number
+    // of bytes, which is smaller than length only at the end of the
+    // file or if a block is corrupt.
+    size_t read(uint8_t *data, size_t length);
+
+    bool seek(int64_t samplePosition);
+    int64_t getSamplePosition(void) const;
+
+private:
+    bool loadIndex(uint64_t indexOffset);
+    bool rebuildIndex(void);
+    bool loadBlock(size_t block);
+
+    FILE *file = nullptr;
+    IQContainerInfo info;
+    uint32_t samplesPerBlock = 0;
+    std::vector<uint64_t> blockOffsets;
+
+    // The block currently decoded and the read position within it
+    size_t currentBlock = 0;
+    bool blockLoaded = false;
+    std::vector<uint8_t> payload;
+    std::vector<uint8_t> decoded;
+    size_t decodedPos = 0;
+};
+
+#endif // IQ_CONTAINER_H
@@ -0,0 +1,617 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "iq_convert.h"
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+// AVX2 is not part of the baseline ABI, so the AVX2 kernels are compiled
+// for that target separately and only used if the CPU supports them.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define IQ_CONVERT_AVX2 1
+#  include <immintrin.h>
+#  define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#if defined(__ARM_NEON) && !defined(__ARM_BIG_ENDIAN)
+#  define IQ_CONVERT_NEON 1
+#  include <arm_neon.h>
+#endif
+
+namespace iqconvert {
+
+namespace {
+
+// I' = I * aI + bI
+// Q' = Q * aQ + I * d + bQ
+// The raw values are normalised and corrected in one step.
+struct Coeffs {
+    float aI;
+    float aQ;
+    float d;
+    float bI;
+    float bQ;
+};
+
+Coeffs makeCoeffs(float normalisation, float bias, const Correction& correction)
+{
+    const float s = correction.scale;
+    const float offsetI = bias - correction.dcOffset.real();
+    const float offsetQ = bias - correction.dcOffset.imag();
+
+    Coeffs c;
+    c.aI = normalisation * s;
+    c.aQ = normalisation * s * correction.qGain;
+    c.d = normalisation * s * correction.qFromI;
+    c.bI = offsetI * s;
+    c.bQ = (offsetQ * correction.qGain + offsetI * correction.qFromI) * s;
+    return c;
+}
+
+Correction plainCorrection(DSPCOMPLEX dcOffset, float scale)
+{
+    Correction correction;
+    correction.dcOffset = dcOffset;
+    correction.scale = scale;
+    return correction;
+}
+
+// Scalar conversion of one sample, for what the vector kernels leave
+inline DSPCOMPLEX convertOne(float I, float Q, const Coeffs& c, Statistics *stats)
+{
+    const DSPCOMPLEX out(I * c.aI + c.bI, Q * c.aQ + I * c.d + c.bQ);
+    if (stats) {
+        stats->sumI += out.real();
+        stats->sumQ += out.imag();
+        stats->sumII += out.real() * out.real();
+        stats->sumQQ += out.imag() * out.imag();
+        stats->sumIQ += out.real() * out.imag();
+    }
+    return out;
+}
+
+#if defined(IQ_CONVERT_AVX2)
+bool haveAVX2()
+{
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+#endif
+
+// Each vector kernel converts as many samples as fit its vector width,
+// and returns how many that were. The scalar loop does the rest.
+//
+// The kernels hand their vectors of interleaved I/Q to a Store. With
+// correct set, it also adds the I term to Q and sums up the output for
+// the Statistics, all in registers.
+
+#if defined(__SSE2__)
+template<bool correct>
+struct StoreSSE {
+    __m128 a, d, b;
+    __m128 sum = _mm_setzero_ps();
+    __m128 sumSq = _mm_setzero_ps();
+    __m128 sumCross = _mm_setzero_ps();
+
+    explicit StoreSSE(const Coeffs& c) :
+        a(_mm_setr_ps(c.aI, c.aQ, c.aI, c.aQ)),
+        d(_mm_setr_ps(0, c.d, 0, c.d)),
+        b(_mm_setr_ps(c.bI, c.bQ, c.bI, c.bQ)) {}
+
+    void operator()(float *out, __m128 v)
+    {
+        __m128 y = _mm_add_ps(_mm_mul_ps(v, a), b);
+        if (correct) {
+            // I in both lanes of a sample
+            const __m128 i = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 0, 0));
+            y = _mm_add_ps(y, _mm_mul_ps(i, d));
+            sum = _mm_add_ps(sum, y);
+            sumSq = _mm_add_ps(sumSq, _mm_mul_ps(y, y));
+            sumCross = _mm_add_ps(sumCross, _mm_mul_ps(y,
+                        _mm_shuffle_ps(y, y, _MM_SHUFFLE(2, 2, 0, 0))));
+        }
+        _mm_storeu_ps(out, y);
+    }
+
+    void finish(Statistics *stats)
+    {
+        if (correct) {
+            float s[4], sq[4], cross[4];
+            _mm_storeu_ps(s, sum);
+            _mm_storeu_ps(sq, sumSq);
+            _mm_storeu_ps(cross, sumCross);
+            stats->sumI += s[0] + s[2];
+            stats->sumQ += s[1] + s[3];
+            stats->sumII += sq[0] + sq[2];
+            stats->sumQQ += sq[1] + sq[3];
+            stats->sumIQ += cross[1] + cross[3];
+        }
+    }
+};
+
+template<bool correct>
+size_t u8SSE2(const uint8_t *in, float *out, size_t count, const Coeffs& c,
+        Statistics *stats)
+{
+    StoreSSE<correct> store(c);
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8, in += 16, out += 16) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+        const __m128i lo = _mm_unpacklo_epi8(x, zero);
+        const __m128i hi = _mm_unpackhi_epi8(x, zero);
+        store(out, _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)));
+        store(out + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)));
+        store(out + 8, _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)));
+        store(out + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)));
+    }
+    store.finish(stats);
+    return i;
+}
+
+template<bool correct>
+size_t s8SSE2(const uint8_t *in, float *out, size_t count, const Coeffs& c,
+        Statistics *stats)
+{
+    StoreSSE<correct> store(c);
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8, in += 16, out += 16) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+        // Sign extension: move to the upper half, shift back arithmetically
+        const __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(zero, x), 8);
+        const __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(zero, x), 8);
+        store(out, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(zero, lo), 16)));
+        store(out + 4, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(zero, lo), 16)));
+        store(out + 8, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(zero, hi), 16)));
+        store(out + 12, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(zero, hi), 16)));
+    }
+    store.finish(stats);
+    return i;
+}
+
+template<bool correct>
+size_t s16SSE2(const uint8_t *in, float *out, size_t count, const Coeffs& c,
+        bool bigEndian, Statistics *stats)
+{
+    StoreSSE<correct> store(c);
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4, in += 16, out += 8) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+        if (bigEndian) {
+            x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+        }
+        store(out, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(zero, x), 16)));
+        store(out + 4, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(zero, x), 16)));
+    }
+    store.finish(stats);
+    return i;
+}
+#endif // defined(__SSE2__)
+
+#if defined(IQ_CONVERT_AVX2)
+template<bool correct>
+struct StoreAVX2 {
+    __m256 a, d, b;
+    __m256 sum, sumSq, sumCross;
+
+    TARGET_AVX2 explicit StoreAVX2(const Coeffs& c) :
+        a(_mm256_setr_ps(c.aI, c.aQ, c.aI, c.aQ, c.aI, c.aQ, c.aI, c.aQ)),
+        d(_mm256_setr_ps(0, c.d, 0, c.d, 0, c.d, 0, c.d)),
+        b(_mm256_setr_ps(c.bI, c.bQ, c.bI, c.bQ, c.bI, c.bQ, c.bI, c.bQ)),
+        sum(_mm256_setzero_ps()),
+        sumSq(_mm256_setzero_ps()),
+        sumCross(_mm256_setzero_ps()) {}
+
+    TARGET_AVX2 void operator()(float *out, __m256 v)
+    {
+        __m256 y = _mm256_add_ps(_mm256_mul_ps(v, a), b);
+        if (correct) {
+            const __m256 i = _mm256_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 0, 0));
+            y = _mm256_add_ps(y, _mm256_mul_ps(i, d));
+            sum = _mm256_add_ps(sum, y);
+            sumSq = _mm256_add_ps(sumSq, _mm256_mul_ps(y, y));
+            sumCross = _mm256_add_ps(sumCross, _mm256_mul_ps(y,
+                        _mm256_shuffle_ps(y, y, _MM_SHUFFLE(2, 2, 0, 0))));
+        }
+        _mm256_storeu_ps(out, y);
+    }
+
+    TARGET_AVX2 void finish(Statistics *stats)
+    {
+        if (correct) {
+            float s[8], sq[8], cross[8];
+            _mm256_storeu_ps(s, sum);
+            _mm256_storeu_ps(sq, sumSq);
+            _mm256_storeu_ps(cross, sumCross);
+            for (int k = 0; k < 8; k += 2) {
+                stats->sumI += s[k];
+                stats->sumQ += s[k + 1];
+                stats->sumII += sq[k];
+                stats->sumQQ += sq[k + 1];
+                stats->sumIQ += cross[k + 1];
+            }
+        }
+    }
+};
+
+template<bool correct>
+TARGET_AVX2 size_t u8AVX2(const uint8_t *in, float *out, size_t count, const Coeffs& c,
+        Statistics *stats)
+{
+    StoreAVX2<correct> store(c);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16, in += 32, out += 32) {
+        for (int k = 0; k < 4; k++) {
+            const __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + 8 * k));
+            store(out + 8 * k, _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(x)));
+        }
+    }
+    store.finish(stats);
+    return i;
+}
+
+template<bool correct>
+TARGET_AVX2 size_t s8AVX2(const uint8_t *in, float *out, size_t count, const Coeffs& c,
+        Statistics *stats)
+{
+    StoreAVX2<correct> store(c);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16, in += 32, out += 32) {
+        for (int k = 0; k < 4; k++) {
+            const __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + 8 * k));
+            store(out + 8 * k, _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(x)));
+        }
+    }
+    store.finish(stats);
+    return i;
+}
+
+template<bool correct>
+TARGET_AVX2 size_t s16AVX2(const uint8_t *in, float *out, size_t count, const Coeffs& c,
+        bool bigEndian, Statistics *stats)
+{
+    StoreAVX2<correct> store(c);
+    const __m128i swap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8, in += 32, out += 16) {
+        for (int k = 0; k < 2; k++) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16 * k));
+            if (bigEndian) {
+                x = _mm_shuffle_epi8(x, swap);
+            }
+            store(out + 8 * k, _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(x)));
+        }
+    }
+    store.finish(stats);
+    return i;
+}
+#endif // defined(IQ_CONVERT_AVX2)
+
+#if defined(IQ_CONVERT_NEON)
+template<bool correct>
+struct StoreNEON {
+    float32x4_t a, d, b;
+    float32x4_t sum = vdupq_n_f32(0);
+    float32x4_t sumSq = vdupq_n_f32(0);
+    float32x4_t sumCross = vdupq_n_f32(0);
+
+    explicit StoreNEON(const Coeffs& c)
+    {
+        const float av[4] = {c.aI, c.aQ, c.aI, c.aQ};
+        const float dv[4] = {0, c.d, 0, c.d};
+        const float bv[4] = {c.bI, c.bQ, c.bI, c.bQ};
+        a = vld1q_f32(av);
+        d = vld1q_f32(dv);
+        b = vld1q_f32(bv);
+    }
+
+    void operator()(float *out, float32x4_t v)
+    {
+        float32x4_t y = vmlaq_f32(b, v, a);
+        if (correct) {
+            y = vmlaq_f32(y, vtrnq_f32(v, v).val[0], d);
+            sum = vaddq_f32(sum, y);
+            sumSq = vmlaq_f32(sumSq, y, y);
+            sumCross = vmlaq_f32(sumCross, y, vtrnq_f32(y, y).val[0]);
+        }
+        vst1q_f32(out, y);
+    }
+
+    void finish(Statistics *stats)
+    {
+        if (correct) {
+            float s[4], sq[4], cross[4];
+            vst1q_f32(s, sum);
+            vst1q_f32(sq, sumSq);
+            vst1q_f32(cross, sumCross);
+            stats->sumI += s[0] + s[2];
+            stats->sumQ += s[1] + s[3];
+            stats->sumII += sq[0] + sq[2];
+            stats->sumQQ += sq[1] + sq[3];
+            stats->sumIQ += cross[1] + cross[3];
+        }
+    }
+};
+
+template<bool correct>
+size_t u8NEON(const uint8_t *in, float *out, size_t count, const Coeffs& c,
+        Statistics *stats)
+{
+    StoreNEON<correct> store(c);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8, in += 16, out += 16) {
+        const uint8x16_t x = vld1q_u8(in);
+        const uint16x8_t lo = vmovl_u8(vget_low_u8(x));
+        const uint16x8_t hi = vmovl_u8(vget_high_u8(x));
+        store(out,      vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))));
+        store(out + 4,  vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))));
+        store(out + 8,  vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))));
+        store(out + 12, vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))));
+    }
+    store.finish(stats);
+    return i;
+}
+
+template<bool correct>
+size_t s8NEON(const uint8_t *in, float *out, size_t count, const Coeffs& c,
+        Statistics *stats)
+{
+    StoreNEON<correct> store(c);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8, in += 16, out += 16) {
+        const int8x16_t x = vreinterpretq_s8_u8(vld1q_u8(in));
+        const int16x8_t lo = vmovl_s8(vget_low_s8(x));
+        const int16x8_t hi = vmovl_s8(vget_high_s8(x));
+        store(out,      vcvtq_f32_s32(vmovl_s16(vget_low_s16(lo))));
+        store(out + 4,  vcvtq_f32_s32(vmovl_s16(vget_high_s16(lo))));
+        store(out + 8,  vcvtq_f32_s32(vmovl_s16(vget_low_s16(hi))));
+        store(out + 12, vcvtq_f32_s32(vmovl_s16(vget_high_s16(hi))));
+    }
+    store.finish(stats);
+    return i;
+}
+
+template<bool correct>
+size_t s16NEON(const uint8_t *in, float *out, size_t count, const Coeffs& c,
+        bool bigEndian, Statistics *stats)
+{
+    StoreNEON<correct> store(c);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4, in += 16, out += 8) {
+        uint8x16_t raw = vld1q_u8(in);
+        if (bigEndian) {
+            raw = vrev16q_u8(raw);
+        }
+        const int16x8_t x = vreinterpretq_s16_u8(raw);
+        store(out,     vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))));
+        store(out + 4, vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))));
+    }
+    store.finish(stats);
+    return i;
+}
+#endif // defined(IQ_CONVERT_NEON)
+
+// Without stats, the kernels leave the cross term and the sums out
+template<bool correct>
+size_t u8Vector(const uint8_t *in, float *out, size_t count, const Coeffs& c,
+        Statistics *stats)
+{
+#if defined(IQ_CONVERT_AVX2)
+    if (haveAVX2()) {
+        return u8AVX2<correct>(in, out, count, c, stats);
+    }
+#endif
+#if defined(__SSE2__)
+    return u8SSE2<correct>(in, out, count, c, stats);
+#elif defined(IQ_CONVERT_NEON)
+    return u8NEON<correct>(in, out, count, c, stats);
+#else
+    (void)in; (void)out; (void)count; (void)c; (void)stats;
+    return 0;
+#endif
+}
+
+template<bool correct>
+size_t s8Vector(const uint8_t *in, float *out, size_t count, const Coeffs& c,
+        Statistics *stats)
+{
+#if defined(IQ_CONVERT_AVX2)
+    if (haveAVX2()) {
+        return s8AVX2<correct>(in, out, count, c, stats);
+    }
+#endif
+#if defined(__SSE2__)
+    return s8SSE2<correct>(in, out, count, c, stats);
+#elif defined(IQ_CONVERT_NEON)
+    return s8NEON<correct>(in, out, count, c, stats);
+#else
+    (void)in; (void)out; (void)count; (void)c; (void)stats;
+    return 0;
+#endif
+}
+
+template<bool correct>
+size_t s16Vector(const uint8_t *in, float *out, size_t count, const Coeffs& c,
+        bool bigEndian, Statistics *stats)
+{
+#if defined(IQ_CONVERT_AVX2)
+    if (haveAVX2()) {
+        return s16AVX2<correct>(in, out, count, c, bigEndian, stats);
+    }
+#endif
+#if defined(__SSE2__)
+    return s16SSE2<correct>(in, out, count, c, bigEndian, stats);
+#elif defined(IQ_CONVERT_NEON)
+    return s16NEON<correct>(in, out, count, c, bigEndian, stats);
+#else
+    (void)in; (void)out; (void)count; (void)c; (void)bigEndian; (void)stats;
+    return 0;
+#endif
+}
+
+// The formats, for the plain and the correcting variant. stats is
+// nullptr for the plain one.
+template<bool correct>
+void convertU8(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        const Correction& correction, Statistics *stats)
+{
+    const Coeffs c = makeCoeffs(1.0f / 128.0f, -1.0f, correction);
+    size_t i = u8Vector<correct>(in, reinterpret_cast<float*>(out), count, c, stats);
+
+    for (; i < count; i++) {
+        out[i] = convertOne(in[2 * i], in[2 * i + 1], c, stats);
+    }
+}
+
+template<bool correct>
+void convertS8(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        const Correction& correction, Statistics *stats)
+{
+    const Coeffs c = makeCoeffs(1.0f / 128.0f, 0.0f, correction);
+    size_t i = s8Vector<correct>(in, reinterpret_cast<float*>(out), count, c, stats);
+
+    for (; i < count; i++) {
+        out[i] = convertOne((int8_t)in[2 * i], (int8_t)in[2 * i + 1], c, stats);
+    }
+}
+
+template<bool correct>
+void convertS16(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        bool bigEndian, const Correction& correction, Statistics *stats)
+{
+    const Coeffs c = makeCoeffs(1.0f / 32768.0f, 0.0f, correction);
+    size_t i = s16Vector<correct>(in, reinterpret_cast<float*>(out), count, c,
+            bigEndian, stats);
+
+    for (; i < count; i++) {
+        const uint8_t *p = in + 4 * i;
+        int16_t I, Q;
+        if (bigEndian) {
+            I = (int16_t)((p[0] << 8) | p[1]);
+            Q = (int16_t)((p[2] << 8) | p[3]);
+        }
+        else {
+            I = (int16_t)(p[0] | (p[1] << 8));
+            Q = (int16_t)(p[2] | (p[3] << 8));
+        }
+        out[i] = convertOne(I, Q, c, stats);
+    }
+}
+
+void convertCS12(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        const Correction& correction, Statistics *stats)
+{
+    // The values are moved to the top of 16 bits, so that they are
+    // normalised like S16
+    const Coeffs c = makeCoeffs(1.0f / 32768.0f, 0.0f, correction);
+
+    for (size_t i = 0; i < count; i++, in += 3) {
+        const int16_t I = (int16_t)((in[1] << 12) | (in[0] << 4));
+        const int16_t Q = (int16_t)((in[2] << 8) | (in[1] & 0xf0));
+        out[i] = convertOne(I, Q, c, stats);
+    }
+}
+
+} // namespace
+
+void fromU8(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        DSPCOMPLEX dcOffset, float scale)
+{
+    convertU8<false>(in, out, count, plainCorrection(dcOffset, scale), nullptr);
+}
+
+void fromS8(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        DSPCOMPLEX dcOffset, float scale)
+{
+    convertS8<false>(in, out, count, plainCorrection(dcOffset, scale), nullptr);
+}
+
+void fromS16LE(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        DSPCOMPLEX dcOffset, float scale)
+{
+    convertS16<false>(in, out, count, false, plainCorrection(dcOffset, scale), nullptr);
+}
+
+void fromS16BE(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        DSPCOMPLEX dcOffset, float scale)
+{
+    convertS16<false>(in, out, count, true, plainCorrection(dcOffset, scale), nullptr);
+}
+
+void fromCS12(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        DSPCOMPLEX dcOffset, float scale)
+{
+    convertCS12(in, out, count, plainCorrection(dcOffset, scale), nullptr);
+}
+
+void fromU8(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        const Correction& correction, Statistics& stats)
+{
+    convertU8<true>(in, out, count, correction, &stats);
+    stats.count += count;
+}
+
+void fromS8(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        const Correction& correction, Statistics& stats)
+{
+    convertS8<true>(in, out, count, correction, &stats);
+    stats.count += count;
+}
+
+void fromS16LE(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        const Correction& correction, Statistics& stats)
+{
+    convertS16<true>(in, out, count, false, correction, &stats);
+    stats.count += count;
+}
+
+void fromS16BE(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        const Correction& correction, Statistics& stats)
+{
+    convertS16<true>(in, out, count, true, correction, &stats);
+    stats.count += count;
+}
+
+void fromCS12(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        const Correction& correction, Statistics& stats)
+{
+    convertCS12(in, out, count, correction, &stats);
+    stats.count += count;
+}
+
+}
@@ -0,0 +1,182 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef IQ_CONVERT_H
+#define IQ_CONVERT_H
+
+// Conversion of the raw I/Q sample formats delivered by the input
+// devices to DSPCOMPLEX. The kernels use SSE2, AVX2 or NEON when
+// available and write directly to the output buffer.
+//
+// All integer formats are normalised to [-1, 1[. After normalisation,
+// every sample is corrected with
+//      out = (in - dcOffset) * scale
+//
+// The overloads taking a Correction also remove an IQ imbalance and
+// sum up the statistics of their output, in the same pass. IQCorrector
+// estimates the correction from these.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include "dab-constants.h"
+#include "ringbuffer.h"
+
+namespace iqconvert {
+
+// With I and Q free of their DC offset:
+//      I' = I * scale
+//      Q' = (Q * qGain + I * qFromI) * scale
+struct Correction {
+    DSPCOMPLEX dcOffset = DSPCOMPLEX(0, 0);
+    float scale = 1.0f;
+    float qGain = 1.0f;
+    float qFromI = 0.0f;
+};
+
+// Sums over the corrected output, added to by every conversion
+struct Statistics {
+    double sumI = 0;
+    double sumQ = 0;
+    double sumII = 0;
+    double sumQQ = 0;
+    double sumIQ = 0;
+    size_t count = 0;
+};
+
+// Interleaved unsigned 8-bit I/Q, as delivered by RTL-SDR and rtl_tcp
+void fromU8(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        DSPCOMPLEX dcOffset = DSPCOMPLEX(0, 0), float scale = 1.0f);
+
+// Interleaved signed 8-bit I/Q
+void fromS8(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        DSPCOMPLEX dcOffset = DSPCOMPLEX(0, 0), float scale = 1.0f);
+
+// Interleaved signed 16-bit I/Q, little and big endian. The input does
+// not need to be aligned.
+void fromS16LE(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        DSPCOMPLEX dcOffset = DSPCOMPLEX(0, 0), float scale = 1.0f);
+void fromS16BE(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        DSPCOMPLEX dcOffset = DSPCOMPLEX(0, 0), float scale = 1.0f);
+
+// Packed 12-bit I/Q in three bytes, as the CS12 format of SoapySDR:
+// I[7:0], Q[3:0] I[11:8], Q[11:4]
+void fromCS12(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        DSPCOMPLEX dcOffset = DSPCOMPLEX(0, 0), float scale = 1.0f);
+
+void fromU8(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        const Correction& correction, Statistics& stats);
+void fromS8(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        const Correction& correction, Statistics& stats);
+void fromS16LE(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        const Correction& correction, Statistics& stats);
+void fromS16BE(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        const Correction& correction, Statistics& stats);
+void fromCS12(const uint8_t *in, DSPCOMPLEX *out, size_t count,
+        const Correction& correction, Statistics& stats);
+
+using ConvertFunction = void (*)(const uint8_t*, DSPCOMPLEX*, size_t,
+        DSPCOMPLEX, float);
+using CorrectedConvertFunction = void (*)(const uint8_t*, DSPCOMPLEX*, size_t,
+        const Correction&, Statistics&);
+
+// Take up to count samples of bytesPerSample bytes each out of a byte
+// ring buffer and convert them in place, without intermediate copy.
+// convert(in, out, n) is called for every run of whole samples.
+// Returns the number of samples converted.
+template<typename Convert>
+int32_t fromRingBuffer(RingBuffer<uint8_t>& buffer,
+        DSPCOMPLEX *out, int32_t count, int32_t bytesPerSample,
+        Convert convert)
+{
+    const auto regions = buffer.acquireRead(count * bytesPerSample);
+    const int32_t samples = regions.size() / bytesPerSample;
+
+    const uint8_t *p1 = regions.first.data;
+    const uint8_t *p2 = regions.second.data;
+    const int32_t size1 = regions.first.size;
+    const int32_t whole1 = std::min(size1 / bytesPerSample, samples);
+    convert(p1, out, whole1);
+
+    int32_t done = whole1;
+    if (done < samples) {
+        // A sample may straddle the end of the buffer
+        const int32_t split = size1 - whole1 * bytesPerSample;
+        int32_t offset = 0;
+        if (split > 0) {
+            uint8_t straddle[8];
+            std::copy(p1 + whole1 * bytesPerSample, p1 + size1, straddle);
+            std::copy(p2, p2 + bytesPerSample - split, straddle + split);
+            convert(straddle, out + done, 1);
+            offset = bytesPerSample - split;
+            done++;
+        }
+        convert(p2 + offset, out + done, samples - done);
+    }
+
+    buffer.release(samples * bytesPerSample);
+    return samples;
+}
+
+inline int32_t fromRingBuffer(RingBuffer<uint8_t>& buffer,
+        DSPCOMPLEX *out, int32_t count, int32_t bytesPerSample,
+        ConvertFunction convert,
+        DSPCOMPLEX dcOffset = DSPCOMPLEX(0, 0), float scale = 1.0f)
+{
+    return fromRingBuffer(buffer, out, count, bytesPerSample,
+            [=](const uint8_t *in, DSPCOMPLEX *o, size_t n) {
+                convert(in, o, n, dcOffset, scale);
+            });
+}
+
+// Convert up to count samples straight into the free space of a sample
+// ring buffer; samples that do not fit are dropped. inStride is the
+// amount of input, in units of In, that makes up one output sample.
+// written(ptr, n) is called for every converted region before the
+// samples are published to the reader. Returns the number of samples
+// converted.
+template<typename In, typename Convert, typename Written>
+int32_t toRingBuffer(RingBuffer<DSPCOMPLEX>& buffer,
+        const In *in, int32_t count, int32_t inStride,
+        Convert convert, Written written)
+{
+    const auto regions = buffer.acquireWrite(count);
+
+    convert(in, regions.first.data, regions.first.size);
+    written(regions.first.data, regions.first.size);
+
+    if (regions.second.size > 0) {
+        convert(in + regions.first.size * inStride,
+                regions.second.data, regions.second.size);
+        written(regions.second.data, regions.second.size);
+    }
+
+    buffer.commitWrite(regions.size());
+    return regions.size();
+}
+
+}
+
+#endif // IQ_CONVERT_H
@@ -0,0 +1,116 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <cmath>
+#include "iq_corrector.h"
+
+// Below this power, there is no signal to estimate the imbalance from
+static const double minPower = 1e-8;
+
+IQCorrector::IQCorrector(size_t interval, float stepSize) :
+    interval(interval),
+    stepSize(stepSize)
+{
+}
+
+void IQCorrector::setEnabled(bool enabled)
+{
+    this->enabled = enabled;
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.enabled = enabled;
+}
+
+void IQCorrector::convert(iqconvert::CorrectedConvertFunction convert,
+        const uint8_t *in, DSPCOMPLEX *out, size_t count)
+{
+    convert(in, out, count, correction, statistics);
+
+    if (statistics.count >= interval) {
+        update();
+    }
+}
+
+int32_t IQCorrector::fromRingBuffer(RingBuffer<uint8_t>& buffer,
+        DSPCOMPLEX *out, int32_t count, int32_t bytesPerSample,
+        iqconvert::CorrectedConvertFunction convert)
+{
+    const int32_t samples = iqconvert::fromRingBuffer(buffer, out, count,
+            bytesPerSample, [&](const uint8_t *in, DSPCOMPLEX *o, size_t n) {
+                convert(in, o, n, correction, statistics);
+            });
+
+    if (statistics.count >= interval) {
+        update();
+    }
+    return samples;
+}
+
+IQCorrectionStats IQCorrector::getStats() const
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+void IQCorrector::update()
+{
+    const double n = statistics.count;
+    const double meanI = statistics.sumI / n;
+    const double meanQ = statistics.sumQ / n;
+    const double powerI = statistics.sumII / n - meanI * meanI;
+    const double powerQ = statistics.sumQQ / n - meanQ * meanQ;
+    const double crossIQ = statistics.sumIQ / n - meanI * meanQ;
+    statistics = iqconvert::Statistics();
+
+    // The DC offset that is left in the output, referred back to the
+    // input of the correction
+    const double residualI = meanI / correction.scale;
+    const double residualQ = (meanQ / correction.scale -
+            correction.qFromI * residualI) / correction.qGain;
+    correction.dcOffset += stepSize * DSPCOMPLEX(residualI, residualQ);
+
+    if (powerI > minPower and powerQ > minPower) {
+        // Q'' = c * Q' + d * I' has the power of I and is uncorrelated with it
+        const double rho = crossIQ / std::sqrt(powerI * powerQ);
+        if (std::abs(rho) < 0.9) {
+            const double norm = std::sqrt(1 - rho * rho);
+            const double c = 1 + stepSize * (std::sqrt(powerI / powerQ) / norm - 1);
+            const double d = -stepSize * rho / norm;
+            correction.qFromI = c * correction.qFromI + d;
+            correction.qGain *= c;
+        }
+    }
+
+    // The correction undoes Q = g * (cos(phi) * Q0 - sin(phi) * I0), as
+    // ChannelImpairments applies it, with qFromI = tan(phi) and
+    // qGain = 1 / (g * cos(phi))
+    const float phi = std::atan(correction.qFromI);
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.dcOffsetI = correction.dcOffset.real();
+    stats.dcOffsetQ = correction.dcOffset.imag();
+    stats.gainImbalance = 20 * std::log10(correction.qGain * std::cos(phi));
+    stats.phaseImbalance = phi * 180 / (float)M_PI;
+}
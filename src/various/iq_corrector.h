@@ -0,0 +1,89 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef IQ_CORRECTOR_H
+#define IQ_CORRECTOR_H
+
+// Adaptive removal of the DC offset and the IQ imbalance of a tuner,
+// as the zero-IF tuners of the RTL-SDR sticks have them. The drivers
+// convert their samples through the corrector instead of iqconvert
+// directly. The conversion applies the current correction and sums up
+// the statistics of its output at the same time; once per interval,
+// the correction is updated from these:
+//
+//  - the mean of the output is the remaining DC offset
+//  - Q is scaled to the power of I and the part of Q that correlates
+//    with I is removed (Gram-Schmidt orthogonalisation)
+//
+// Every update goes stepSize of the way, which averages out the noise
+// of the estimates.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include "dab-constants.h"
+#include "iq_convert.h"
+#include "radio-controller.h"
+#include "ringbuffer.h"
+
+class IQCorrector {
+public:
+    explicit IQCorrector(size_t interval = INPUT_RATE / 10,
+            float stepSize = 0.25f);
+
+    // May be called from any thread. The estimate is kept while the
+    // correction is disabled.
+    void setEnabled(bool enabled);
+    bool isEnabled(void) const { return enabled; }
+
+    // Converts count samples with the current correction
+    void convert(iqconvert::CorrectedConvertFunction convert,
+            const uint8_t *in, DSPCOMPLEX *out, size_t count);
+
+    // Like iqconvert::fromRingBuffer, with the correction
+    int32_t fromRingBuffer(RingBuffer<uint8_t>& buffer,
+            DSPCOMPLEX *out, int32_t count, int32_t bytesPerSample,
+            iqconvert::CorrectedConvertFunction convert);
+
+    // May be called from any thread
+    IQCorrectionStats getStats(void) const;
+
+private:
+    void update(void);
+
+    const size_t interval;
+    const float stepSize;
+    std::atomic<bool> enabled = ATOMIC_VAR_INIT(false);
+
+    // Only used by the thread that converts
+    iqconvert::Correction correction;
+    iqconvert::Statistics statistics;
+
+    mutable std::mutex statsMutex;
+    IQCorrectionStats stats;
+};
+
+#endif // IQ_CORRECTOR_H
@@ -0,0 +1,167 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "iq_multicast.h"
+#include "iq_convert.h"
+
+namespace iqmulticast {
+
+static const uint8_t magic[4] = {'W', 'I', 'Q', 'M'};
+static const uint8_t version = 1;
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+        ((uint32_t)p[2] << 8) | p[3];
+}
+
+static size_t bytesPerSample(Format format)
+{
+    return format == Format::CS8 ? 2 : 2 * sizeof(float);
+}
+
+bool parseFormat(const std::string& name, Format& format)
+{
+    if (name == "cf32") {
+        format = Format::CF32;
+    }
+    else if (name == "cs8") {
+        format = Format::CS8;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+const char *formatName(Format format)
+{
+    return format == Format::CS8 ? "cs8" : "cf32";
+}
+
+size_t samplesPerDatagram(Format format)
+{
+    return (maxDatagramSize - headerSize) / bytesPerSample(format);
+}
+
+void writeHeader(const Header& header, uint8_t *datagram)
+{
+    std::memcpy(datagram, magic, sizeof(magic));
+    datagram[4] = version;
+    datagram[5] = static_cast<uint8_t>(header.format);
+    datagram[6] = header.stream >> 8;
+    datagram[7] = header.stream;
+    put32(datagram + 8, header.sequence >> 32);
+    put32(datagram + 12, header.sequence);
+    put32(datagram + 16, header.centreFrequency);
+}
+
+bool readHeader(const uint8_t *datagram, size_t length, Header& header)
+{
+    if (length < headerSize or
+            std::memcmp(datagram, magic, sizeof(magic)) != 0 or
+            datagram[4] != version) {
+        return false;
+    }
+
+    const Format format = static_cast<Format>(datagram[5]);
+    if (format != Format::CF32 and format != Format::CS8) {
+        return false;
+    }
+
+    header.format = format;
+    header.stream = (datagram[6] << 8) | datagram[7];
+    header.sequence = ((uint64_t)get32(datagram + 8) << 32) | get32(datagram + 12);
+    header.centreFrequency = get32(datagram + 16);
+    return true;
+}
+
+void pack(const DSPCOMPLEX *samples, size_t count, Format format, uint8_t *payload)
+{
+    if (format == Format::CF32) {
+        std::memcpy(payload, samples, count * sizeof(DSPCOMPLEX));
+        return;
+    }
+
+    const float *in = reinterpret_cast<const float*>(samples);
+    int8_t *out = reinterpret_cast<int8_t*>(payload);
+    for (size_t i = 0; i < 2 * count; i++) {
+        out[i] = (int8_t)std::lrint(std::min(std::max(in[i] * 128.0f, -128.0f), 127.0f));
+    }
+}
+
+size_t unpack(const uint8_t *payload, size_t length, Format format, DSPCOMPLEX *out)
+{
+    const size_t count = std::min(length / bytesPerSample(format),
+            samplesPerDatagram(format));
+
+    if (format == Format::CF32) {
+        std::memcpy(out, payload, count * sizeof(DSPCOMPLEX));
+    }
+    else {
+        iqconvert::fromS8(payload, out, count);
+    }
+    return count;
+}
+
+bool parseAddress(const std::string& address, std::string& group, int& port,
+        std::string& interfaceAddress)
+{
+    const size_t colon = address.find(':');
+    if (colon == std::string::npos) {
+        return false;
+    }
+
+    const size_t secondColon = address.find(':', colon + 1);
+    const std::string portString = address.substr(colon + 1,
+            secondColon == std::string::npos ? std::string::npos : secondColon - colon - 1);
+
+    char *end = nullptr;
+    const long parsedPort = std::strtol(portString.c_str(), &end, 10);
+    if (portString.empty() or *end != '\0' or parsedPort <= 0 or parsedPort > 65535) {
+        return false;
+    }
+
+    group = address.substr(0, colon);
+    port = parsedPort;
+    interfaceAddress = secondColon == std::string::npos ?
+        "" : address.substr(secondColon + 1);
+    return not group.empty();
+}
+
+}
@@ -0,0 +1,94 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef IQ_MULTICAST_H
+#define IQ_MULTICAST_H
+
+// IQ samples distributed as UDP multicast, so that the host that owns a
+// tuner can feed the receivers of many others without a connection per
+// receiver.
+//
+// Every datagram holds a header and a fixed number of samples:
+//
+//   offset  size
+//        0     4  magic "WIQM"
+//        4     1  version, 1
+//        5     1  sample format
+//        6     2  stream, chosen at random whenever the publisher starts
+//        8     8  sequence number, incremented for every datagram
+//       16     4  centre frequency in Hz, 0 if unknown
+//       20        samples
+//
+// The integers of the header are in network byte order. cf32 samples are
+// little-endian floats, like in IQ files; cs8 samples are signed 8-bit,
+// normalised like the s8 files. A datagram carries at most 1452 bytes of
+// samples, so that it fits into an Ethernet frame without fragmentation.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "dab-constants.h"
+
+namespace iqmulticast {
+
+enum class Format : uint8_t { CF32 = 1, CS8 = 2 };
+
+struct Header {
+    Format format = Format::CF32;
+    uint16_t stream = 0;
+    uint64_t sequence = 0;
+    uint32_t centreFrequency = 0;
+};
+
+const size_t headerSize = 20;
+const size_t maxDatagramSize = 1472;
+
+// Parse "cf32" or "cs8"
+bool parseFormat(const std::string& name, Format& format);
+const char *formatName(Format format);
+
+size_t samplesPerDatagram(Format format);
+
+void writeHeader(const Header& header, uint8_t *datagram);
+
+// Returns false if the datagram is too short, is not ours, or uses a
+// version or format we do not know
+bool readHeader(const uint8_t *datagram, size_t length, Header& header);
+
+// Write count samples to the payload, which must have room for them.
+// cs8 clips everything outside of [-1, 1[.
+void pack(const DSPCOMPLEX *samples, size_t count, Format format, uint8_t *payload);
+
+// Returns the number of samples written to out, which must have room
+// for samplesPerDatagram()
+size_t unpack(const uint8_t *payload, size_t length, Format format, DSPCOMPLEX *out);
+
+// Parse "<group>:<port>[:<interface address>]"
+bool parseAddress(const std::string& address, std::string& group, int& port,
+        std::string& interfaceAddress);
+
+}
+
+#endif // IQ_MULTICAST_H
@@ -0,0 +1,165 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "nco.h"
+
+// Samples rotated with the same phasor at the start, 2 KiB of table
+static const size_t block = 256;
+
+// The sums are kept per lane, so that they vectorise without
+// reassociating floating point additions
+static const size_t lanes = 8;
+
+NCO::NCO(float sampleRate) :
+    sampleRate(sampleRate),
+    table(block, DSPCOMPLEX(1, 0))
+{
+}
+
+void NCO::setFrequency(double frequency)
+{
+    if (frequency == this->frequency) {
+        return;
+    }
+
+    this->frequency = frequency;
+    const double omega = 2 * M_PI * frequency / sampleRate;
+    for (size_t i = 0; i < block; i++) {
+        table[i] = DSPCOMPLEX(std::polar(1.0, omega * i));
+    }
+    blockStep = std::polar(1.0, omega * block);
+}
+
+void NCO::reset()
+{
+    phase = 1;
+}
+
+// Rotates the samples of one block in out by the phasor p times the
+// table, adds their L1 norms to level and, if correlate is set, their
+// correlation with prev to corrRe and corrIm
+template<bool correlate>
+static inline void rotateBlock(float *out, const float *prev, const float *table,
+        float pr, float pi, size_t length,
+        float *level, float *corrRe, float *corrIm)
+{
+    auto rotateOne = [&](size_t j, size_t k) {
+        const float tr = pr * table[2 * j] - pi * table[2 * j + 1];
+        const float ti = pr * table[2 * j + 1] + pi * table[2 * j];
+        const float re = out[2 * j];
+        const float im = out[2 * j + 1];
+        const float outRe = re * tr - im * ti;
+        const float outIm = re * ti + im * tr;
+        out[2 * j] = outRe;
+        out[2 * j + 1] = outIm;
+        level[k] += std::fabs(outRe) + std::fabs(outIm);
+        if (correlate) {
+            const float prevRe = prev[2 * j];
+            const float prevIm = prev[2 * j + 1];
+            corrRe[k] += outRe * prevRe + outIm * prevIm;
+            corrIm[k] += outIm * prevRe - outRe * prevIm;
+        }
+    };
+
+    size_t i = 0;
+    for (; i + lanes <= length; i += lanes) {
+        for (size_t k = 0; k < lanes; k++) {
+            rotateOne(i + k, k);
+        }
+    }
+    for (; i < length; i++) {
+        rotateOne(i, 0);
+    }
+}
+
+template<bool correlate>
+float NCO::rotate(DSPCOMPLEX *samples, size_t n, size_t lag, DSPCOMPLEX *correlation)
+{
+    float *s = reinterpret_cast<float*>(samples);
+    const float *t = reinterpret_cast<const float*>(table.data());
+
+    float level[lanes] = {};
+    float corrRe[lanes] = {};
+    float corrIm[lanes] = {};
+
+    size_t b = 0;
+    while (b < n) {
+        // Blocks do not straddle the lag, and do not overlap the samples
+        // they correlate with, which are rotated already
+        size_t length = std::min(block, n - b);
+        const bool correlateBlock = correlate and b >= lag;
+        if (correlate and b < lag) {
+            length = std::min(length, lag - b);
+        }
+        else if (correlateBlock) {
+            length = std::min(length, lag);
+        }
+
+        const float pr = phase.real();
+        const float pi = phase.imag();
+        if (correlateBlock) {
+            rotateBlock<true>(s + 2 * b, s + 2 * (b - lag), t, pr, pi, length,
+                    level, corrRe, corrIm);
+        }
+        else {
+            rotateBlock<false>(s + 2 * b, nullptr, t, pr, pi, length,
+                    level, corrRe, corrIm);
+        }
+
+        if (length == block) {
+            phase *= blockStep;
+        }
+        else {
+            phase *= std::polar(1.0, 2 * M_PI * frequency / sampleRate * length);
+        }
+        phase /= std::abs(phase);
+        b += length;
+    }
+
+    float levelSum = 0;
+    DSPCOMPLEX corrSum = 0;
+    for (size_t k = 0; k < lanes; k++) {
+        levelSum += level[k];
+        corrSum += DSPCOMPLEX(corrRe[k], corrIm[k]);
+    }
+
+    if (correlate) {
+        *correlation += corrSum;
+    }
+    return levelSum;
+}
+
+float NCO::process(DSPCOMPLEX *samples, size_t n)
+{
+    return rotate<false>(samples, n, 0, nullptr);
+}
+
+float NCO::process(DSPCOMPLEX *samples, size_t n, size_t lag, DSPCOMPLEX& correlation)
+{
+    return rotate<true>(samples, n, lag, &correlation);
+}
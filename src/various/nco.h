@@ -0,0 +1,81 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef NCO_H
+#define NCO_H
+
+// Numerically controlled oscillator that shifts a signal in frequency.
+//
+// Instead of one table entry per sample, the samples are rotated in
+// blocks: every sample of a block is multiplied by the phasor at the
+// start of the block and by a short table of the rotation within the
+// block. Both loops are written so that the compiler vectorises them.
+// The phasor at the start of a block is kept in double precision and
+// renormalised after every block, so that neither its amplitude nor the
+// frequency drift over time.
+//
+// The rotation can be fused with the measurements that follow it in
+// the receiver: the L1 norm of the output, and its correlation with
+// itself one lag earlier, e.g. of the cyclic prefix of OFDM symbols.
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+#include "dab-constants.h"
+
+class NCO {
+public:
+    explicit NCO(float sampleRate = INPUT_RATE);
+
+    // Takes effect at the next sample, without a phase discontinuity
+    void setFrequency(double frequency);
+    double getFrequency(void) const { return frequency; }
+
+    // Restart at phase 0
+    void reset(void);
+
+    // Rotates n samples in place, continuing where the previous call
+    // stopped. Returns the sum of the L1 norms of the output.
+    float process(DSPCOMPLEX *samples, size_t n);
+
+    // The same, and adds the sum of out[i] * conj(out[i - lag]) over
+    // lag <= i < n to correlation
+    float process(DSPCOMPLEX *samples, size_t n, size_t lag, DSPCOMPLEX& correlation);
+
+private:
+    template<bool correlate>
+    float rotate(DSPCOMPLEX *samples, size_t n, size_t lag, DSPCOMPLEX *correlation);
+
+    const float sampleRate;
+    double frequency = 0;
+
+    // Rotation of the samples within a block, and over a whole block
+    std::vector<DSPCOMPLEX> table;
+    std::complex<double> blockStep = 1;
+
+    std::complex<double> phase = 1;
+};
+
+#endif // NCO_H
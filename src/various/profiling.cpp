@@ -65,6 +65,9 @@ const char* mark_to_cstr(const ProfilingMark& m) {
         MARK_TO_CSTR_CASE(DADispersal)
         MARK_TO_CSTR_CASE(DADecode)
         MARK_TO_CSTR_CASE(DADone)
+
+        MARK_TO_CSTR_CASE(Resample)
+        MARK_TO_CSTR_CASE(ResampleDone)
     }
 
     return "unknown";
@@ -59,6 +59,9 @@ enum class ProfilingMark {
     DADispersal,
     DADecode,
     DADone,
+
+    Resample,
+    ResampleDone,
 };
 
 struct ProfilingTimepoint {
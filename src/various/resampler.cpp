@@ -0,0 +1,346 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include "resampler.h"
+#include "profiling.h"
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define RESAMPLER_AVX2 1
+#  include <immintrin.h>
+#  define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+#if defined(__ARM_NEON)
+#  define RESAMPLER_NEON 1
+#  include <arm_neon.h>
+#endif
+
+// Half the bandwidth of a DAB ensemble, with a bit of margin
+static const double passbandEdge = 770e3;
+static const double stopbandAttenuation = 60.0;
+static const uint32_t maxPhases = 2048;
+
+namespace {
+
+uint32_t gcd(uint32_t a, uint32_t b)
+{
+    while (b != 0) {
+        const uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Zeroth order modified Bessel function of the first kind, for the
+// Kaiser window
+double besselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+#if !defined(__SSE2__) && !defined(RESAMPLER_NEON)
+// x and c hold length floats, length is a multiple of 8. Returns the
+// sum of the products of the even and of the odd elements.
+DSPCOMPLEX dotScalar(const float *x, const float *c, size_t length)
+{
+    float re = 0;
+    float im = 0;
+    for (size_t i = 0; i < length; i += 2) {
+        re += x[i] * c[i];
+        im += x[i + 1] * c[i + 1];
+    }
+    return DSPCOMPLEX(re, im);
+}
+#endif
+
+#if defined(__SSE2__)
+inline DSPCOMPLEX reduceSSE(__m128 acc)
+{
+    // re0 im0 re1 im1 -> re0 + re1, im0 + im1
+    const __m128 sum = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    float r[4];
+    _mm_storeu_ps(r, sum);
+    return DSPCOMPLEX(r[0], r[1]);
+}
+
+DSPCOMPLEX dotSSE2(const float *x, const float *c, size_t length)
+{
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (size_t i = 0; i < length; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(c + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(x + i + 4), _mm_loadu_ps(c + i + 4)));
+    }
+    return reduceSSE(_mm_add_ps(acc0, acc1));
+}
+#endif
+
+#if defined(RESAMPLER_AVX2)
+bool haveAVX2()
+{
+    static const bool avx2 = __builtin_cpu_supports("avx2") and
+        __builtin_cpu_supports("fma");
+    return avx2;
+}
+
+TARGET_AVX2 DSPCOMPLEX dotAVX2(const float *x, const float *c, size_t length)
+{
+    __m256 acc = _mm256_setzero_ps();
+    for (size_t i = 0; i < length; i += 8) {
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(c + i), acc);
+    }
+    const __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc),
+            _mm256_extractf128_ps(acc, 1));
+    const __m128 pairs = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    float r[4];
+    _mm_storeu_ps(r, pairs);
+    return DSPCOMPLEX(r[0], r[1]);
+}
+#endif
+
+#if defined(RESAMPLER_NEON)
+DSPCOMPLEX dotNEON(const float *x, const float *c, size_t length)
+{
+    float32x4_t acc0 = vdupq_n_f32(0);
+    float32x4_t acc1 = vdupq_n_f32(0);
+    for (size_t i = 0; i < length; i += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(x + i), vld1q_f32(c + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(x + i + 4), vld1q_f32(c + i + 4));
+    }
+    const float32x4_t acc = vaddq_f32(acc0, acc1);
+    const float32x2_t sum = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    return DSPCOMPLEX(vget_lane_f32(sum, 0), vget_lane_f32(sum, 1));
+}
+#endif
+
+Resampler::DotFunction selectDot()
+{
+#if defined(RESAMPLER_AVX2)
+    if (haveAVX2()) {
+        return dotAVX2;
+    }
+#endif
+#if defined(__SSE2__)
+    return dotSSE2;
+#elif defined(RESAMPLER_NEON)
+    return dotNEON;
+#else
+    return dotScalar;
+#endif
+}
+
+}
+
+Resampler::Resampler(uint32_t inputRate, uint32_t outputRate) :
+    dot(selectDot())
+{
+    uint32_t divisor = gcd(inputRate, outputRate);
+    if (outputRate / divisor > maxPhases) {
+        const uint32_t rounded = (inputRate + 500) / 1000 * 1000;
+        std::clog << "Resampler: Rounding input rate " << inputRate <<
+            " to " << rounded << std::endl;
+        inputRate = rounded;
+        divisor = gcd(inputRate, outputRate);
+    }
+    interpolation = outputRate / divisor;
+    decimation = inputRate / divisor;
+
+    // Aliases and images may fall anywhere outside of the ensemble
+    const double stopbandEdge = std::max(
+            std::min(inputRate, outputRate) - passbandEdge,
+            passbandEdge + 100e3);
+    const double cutoff = (passbandEdge + stopbandEdge) / 2;
+    const double transition = stopbandEdge - passbandEdge;
+
+    // The prototype filter runs at the upsampled rate
+    const double rate = (double)inputRate * interpolation;
+    const double beta = 0.1102 * (stopbandAttenuation - 8.7);
+    const size_t length = std::ceil((stopbandAttenuation - 8) /
+            (2.285 * 2 * M_PI * transition / rate)) + 1;
+    tapsPerPhase = (length + interpolation - 1) / interpolation;
+    tapsPerPhase = (tapsPerPhase + 3) / 4 * 4;
+
+    const size_t taps = tapsPerPhase * interpolation;
+    std::vector<double> prototype(taps);
+    const double centre = (taps - 1) / 2.0;
+    const double wc = 2 * cutoff / rate;
+    for (size_t k = 0; k < taps; k++) {
+        const double t = k - centre;
+        const double sinc = (t == 0) ? 1.0 : std::sin(M_PI * wc * t) / (M_PI * wc * t);
+        const double r = t / centre;
+        const double window = besselI0(beta * std::sqrt(std::max(0.0, 1 - r * r))) /
+            besselI0(beta);
+        prototype[k] = sinc * window;
+    }
+
+    // Output sample n is the sum of h[phase + j * L] * x[i - j]. Store
+    // the coefficients of every phase in the order of x so that the
+    // dot product can walk both forward, and normalise every phase to
+    // unity gain at DC.
+    coefficients.resize(2 * taps);
+    for (uint32_t p = 0; p < interpolation; p++) {
+        double sum = 0;
+        for (size_t j = 0; j < tapsPerPhase; j++) {
+            sum += prototype[p + j * interpolation];
+        }
+
+        float *c = &coefficients[2 * p * tapsPerPhase];
+        for (size_t j = 0; j < tapsPerPhase; j++) {
+            const float h = prototype[p + (tapsPerPhase - 1 - j) * interpolation] / sum;
+            c[2 * j] = h;
+            c[2 * j + 1] = h;
+        }
+    }
+
+    std::clog << "Resampler: " << inputRate << " to " << outputRate <<
+        " S/s, L=" << interpolation << " M=" << decimation << ", " <<
+        tapsPerPhase << " taps per phase" << std::endl;
+
+    reset();
+}
+
+size_t Resampler::maxOutput(size_t count) const
+{
+    const size_t pending = history.size() > inputIndex ?
+        history.size() - inputIndex : 0;
+    return (uint64_t)(pending + count) * interpolation / decimation + 1;
+}
+
+size_t Resampler::process(const DSPCOMPLEX *in, size_t count, DSPCOMPLEX *out)
+{
+    PROFILE(Resample);
+    history.insert(history.end(), in, in + count);
+
+    const size_t available = history.size();
+    const size_t length = 2 * tapsPerPhase;
+    size_t n = 0;
+    while (inputIndex < available) {
+        const float *x = reinterpret_cast<const float*>(
+                &history[inputIndex + 1 - tapsPerPhase]);
+        out[n++] = dot(x, &coefficients[phase * length], length);
+
+        phase += decimation;
+        inputIndex += phase / interpolation;
+        phase %= interpolation;
+    }
+
+    // Keep the samples the next outputs need
+    const size_t consumed = std::min(inputIndex + 1 - tapsPerPhase, available);
+    history.erase(history.begin(), history.begin() + consumed);
+    inputIndex -= consumed;
+
+    PROFILE(ResampleDone);
+    return n;
+}
+
+void Resampler::reset()
+{
+    history.assign(tapsPerPhase - 1, DSPCOMPLEX(0, 0));
+    inputIndex = tapsPerPhase - 1;
+    phase = 0;
+}
+
+HalfBandDecimator::HalfBandDecimator() :
+    dot(selectDot()),
+    even(taps - 1 + chunkSize),
+    odd(taps / 2 + chunkSize)
+{
+    // Kaiser windowed prototype of 2 * taps - 1 taps. The even ones
+    // are the non-zero taps, its centre is odd.
+    const double beta = 0.1102 * (75.0 - 8.7);
+    const double middle = taps - 1;
+    std::vector<double> h(taps);
+    double sum = 0;
+    for (size_t j = 0; j < taps; j++) {
+        const double t = 2.0 * j - middle;
+        const double r = t / middle;
+        const double window = besselI0(beta * std::sqrt(std::max(0.0, 1 - r * r))) /
+            besselI0(beta);
+        h[j] = std::sin(M_PI * t / 2) / (M_PI * t) * window;
+        sum += h[j];
+    }
+
+    // Unity gain at DC, including the normalisation of the input. The
+    // filter is symmetric, so the order of the taps doesn't matter.
+    const double normalisation = 1.0 / 32768.0;
+    coefficients.resize(2 * taps);
+    for (size_t j = 0; j < taps; j++) {
+        coefficients[2 * j] = coefficients[2 * j + 1] =
+            h[j] * 0.5 / sum * normalisation;
+    }
+    centre = 0.5 * normalisation;
+
+    reset();
+}
+
+void HalfBandDecimator::processS16(const int16_t *in, DSPCOMPLEX *out, size_t count)
+{
+    const size_t evenHistory = taps - 1;
+    const size_t oddHistory = taps / 2;
+
+    while (count > 0) {
+        const size_t n = std::min(count, chunkSize);
+
+        DSPCOMPLEX *e = &even[evenHistory];
+        DSPCOMPLEX *o = &odd[oddHistory];
+        for (size_t i = 0; i < n; i++, in += 4) {
+            e[i] = DSPCOMPLEX(in[0], in[1]);
+            o[i] = DSPCOMPLEX(in[2], in[3]);
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            out[i] = dot(reinterpret_cast<const float*>(&even[i]),
+                    coefficients.data(), 2 * taps) + centre * odd[i];
+        }
+
+        std::copy(even.begin() + n, even.begin() + n + evenHistory, even.begin());
+        std::copy(odd.begin() + n, odd.begin() + n + oddHistory, odd.begin());
+        out += n;
+        count -= n;
+    }
+}
+
+void HalfBandDecimator::reset()
+{
+    std::fill(even.begin(), even.end(), DSPCOMPLEX(0, 0));
+    std::fill(odd.begin(), odd.end(), DSPCOMPLEX(0, 0));
+}
@@ -0,0 +1,116 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+// Rational polyphase resampler, which lets input devices run at their
+// native sample rate and still deliver INPUT_RATE to the receiver.
+//
+// The rates are reduced to L/M. Every output sample is the dot product
+// of the last input samples with one of the L phases of a low-pass
+// prototype filter, so nothing is computed for the zeros that a plain
+// upsampler would insert. The filter passes the 1.536 MHz of a DAB
+// ensemble and only lets aliases fall outside of it, which keeps it
+// short: 2.4 MS/s needs 20 taps per output sample, 10 MS/s 72.
+//
+// Decimation by exactly two is done by HalfBandDecimator instead, which
+// makes use of the taps of a half-band filter that are zero.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "dab-constants.h"
+
+class Resampler {
+public:
+    // Rates in samples per second. If the ratio can't be expressed
+    // with a reasonable number of phases, the input rate is rounded to
+    // the kHz.
+    Resampler(uint32_t inputRate, uint32_t outputRate = INPUT_RATE);
+
+    uint32_t getInterpolation(void) const { return interpolation; }
+    uint32_t getDecimation(void) const { return decimation; }
+    size_t getTapsPerPhase(void) const { return tapsPerPhase; }
+
+    // Upper bound of the output of process() for count input samples
+    size_t maxOutput(size_t count) const;
+
+    // Resample count input samples into out, which must have room for
+    // maxOutput(count) samples. Returns the number of output samples.
+    size_t process(const DSPCOMPLEX *in, size_t count, DSPCOMPLEX *out);
+
+    // Forget the filter history, e.g. after retuning
+    void reset(void);
+
+    using DotFunction = DSPCOMPLEX (*)(const float*, const float*, size_t);
+
+private:
+    uint32_t interpolation = 1;
+    uint32_t decimation = 1;
+    size_t tapsPerPhase = 0;
+
+    // Coefficients of every phase in the order of the input samples,
+    // each one twice to match interleaved I and Q
+    std::vector<float> coefficients;
+    DotFunction dot;
+
+    // The last tapsPerPhase - 1 input samples, followed by the new ones
+    std::vector<DSPCOMPLEX> history;
+    size_t inputIndex = 0;
+    uint32_t phase = 0;
+};
+
+// Decimates by two with a half-band filter, for devices that run at
+// twice INPUT_RATE. Apart from the centre tap, every other tap of the
+// filter is zero: the odd input samples are only delayed and halved,
+// only the even ones go through the dot product. 20 taps reject the
+// aliases of a DAB ensemble at 4.096 MS/s by more than 85 dB.
+class HalfBandDecimator {
+public:
+    HalfBandDecimator();
+
+    // Filter 2 * count interleaved signed 16-bit I/Q samples into count
+    // samples, normalised to [-1, 1[. Doesn't allocate.
+    void processS16(const int16_t *in, DSPCOMPLEX *out, size_t count);
+
+    void reset(void);
+
+private:
+    // Non-zero taps, apart from the centre
+    static const size_t taps = 20;
+    static const size_t chunkSize = 2048;
+
+    std::vector<float> coefficients;
+    float centre = 0.5f;
+    Resampler::DotFunction dot;
+
+    // The even input samples, after the last taps - 1 of the previous
+    // chunk, and the odd ones after the last taps / 2
+    std::vector<DSPCOMPLEX> even;
+    std::vector<DSPCOMPLEX> odd;
+};
+
+#endif // RESAMPLER_H
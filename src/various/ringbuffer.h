@@ -75,70 +75,93 @@
 #include    <string.h>
 #include    <stdint.h>
 #include    <iostream>
+#include    <atomic>
 
 /*
  *  a simple ringbuffer, lockfree, however only for a
  *  single reader and a single writer.
  *  Mostly used for getting samples from or to the soundcard
+ *
+ *  The read and write indices are C++11 atomics: each side publishes
+ *  its progress with a release store on its own index and loads the
+ *  other side's index with acquire.
+ *  Both indices, together with the copy of the opposite index that
+ *  each side keeps, sit on their own cache line so that producer and
+ *  consumer do not keep stealing the line from each other.
+ *
+ *  Besides the copying putDataIntoBuffer/getDataFromBuffer, the buffer
+ *  hands out the free or filled space as at most two contiguous spans:
+ *
+ *      auto w = buffer.acquireWrite(n);    // writer
+ *      ... fill w.first and w.second ...
+ *      buffer.commitWrite(w.size());
+ *
+ *      auto r = buffer.acquireRead(n);     // reader
+ *      ... use r.first and r.second ...
+ *      buffer.release(r.size());
  */
-#if defined(__APPLE__)
-#   include <libkern/OSAtomic.h>
-    /* Here are the memory barrier functions. Mac OS X only provides
-       full memory barriers, so the three types of barriers are the same,
-       however, these barriers are superior to compiler-based ones. */
-#   define PaUtil_FullMemoryBarrier()  OSMemoryBarrier()
-#   define PaUtil_ReadMemoryBarrier()  OSMemoryBarrier()
-#   define PaUtil_WriteMemoryBarrier() OSMemoryBarrier()
-#elif defined(__GNUC__)
-    /* GCC >= 4.1 has built-in intrinsics. We'll use those */
-#   if (__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1)
-# define PaUtil_FullMemoryBarrier()  __sync_synchronize()
-# define PaUtil_ReadMemoryBarrier()  __sync_synchronize()
-# define PaUtil_WriteMemoryBarrier() __sync_synchronize()
-    /* as a fallback, GCC understands volatile asm and "memory" to mean it
-     * should not reorder memory read/writes */
-#   elif defined( __PPC__ )
-#      define PaUtil_FullMemoryBarrier()  asm volatile("sync":::"memory")
-#      define PaUtil_ReadMemoryBarrier()  asm volatile("sync":::"memory")
-#      define PaUtil_WriteMemoryBarrier() asm volatile("sync":::"memory")
-#   elif defined( __i386__ ) || defined( __i486__ ) || defined( __i586__ ) || defined( __i686__ ) || defined( __x86_64__ )
-#      define PaUtil_FullMemoryBarrier()  asm volatile("mfence":::"memory")
-#      define PaUtil_ReadMemoryBarrier()  asm volatile("lfence":::"memory")
-#      define PaUtil_WriteMemoryBarrier() asm volatile("sfence":::"memory")
-#   else
-#      ifdef ALLOW_SMP_DANGERS
-#         warning Memory barriers not defined on this system or system unknown
-#         warning For SMP safety, you should fix this.
-#         define PaUtil_FullMemoryBarrier()
-#         define PaUtil_ReadMemoryBarrier()
-#         define PaUtil_WriteMemoryBarrier()
-#      else
-#         error Memory barriers are not defined on this system. You can still compile by defining ALLOW_SMP_DANGERS, but SMP safety will not be guaranteed.
-#      endif
-#   endif
-#else
-#   ifdef ALLOW_SMP_DANGERS
-#      warning Memory barriers not defined on this system or system unknown
-#      warning For SMP safety, you should fix this.
-#      define PaUtil_FullMemoryBarrier()
-#      define PaUtil_ReadMemoryBarrier()
-#      define PaUtil_WriteMemoryBarrier()
-#   else
-#      error Memory barriers are not defined on this system. You can still compile by defining ALLOW_SMP_DANGERS, but SMP safety will not be guaranteed.
-#   endif
-#endif
+
+template <class T>
+struct RingBufferSpan {
+    T       *data = nullptr;
+    int32_t size = 0;
+};
+
+template <class T>
+struct RingBufferRegions {
+    RingBufferSpan<T> first;
+    RingBufferSpan<T> second;
+
+    int32_t size(void) const {
+        return first.size + second.size;
+    }
+};
 
 // Base implementation
 template <class elementtype>
 class RingBuffer
 {
+    public:
+        using WriteRegions = RingBufferRegions<elementtype>;
+        using ReadRegions = RingBufferRegions<const elementtype>;
+
     private:
+        static constexpr size_t cacheLineSize = 64;
+
+        // The index owned by one side and its copy of the other side's
+        // index, padded so that writer and reader never share a line
+        struct IndexState {
+            char        paddingBefore[cacheLineSize];
+            std::atomic<uint32_t> index;
+            uint32_t    cachedOtherIndex;
+            char        paddingAfter[cacheLineSize];
+        };
+
+        // Written once in the constructor, shared read-only
         uint32_t    bufferSize;
-        volatile    uint32_t    writeIndex;
-        volatile    uint32_t    readIndex;
         uint32_t    bigMask;
         uint32_t    smallMask;
-        std::vector<char> buffer;
+        std::vector<elementtype> buffer;
+
+        IndexState  writer;
+        IndexState  reader;
+
+        template <class T>
+        RingBufferRegions<T> regionsAt(uint32_t index, uint32_t elementCount) {
+            RingBufferRegions<T> regions;
+            index &= smallMask;
+            regions.first.data = &buffer[index];
+            regions.second.data = &buffer[0];
+            if ((index + elementCount) > bufferSize) {
+                // Wraps around the end of the buffer
+                regions.first.size = bufferSize - index;
+                regions.second.size = elementCount - regions.first.size;
+            }
+            else {
+                regions.first.size = elementCount;
+            }
+            return regions;
+        }
 
     protected:
         void onDroppedData(int32_t droppedElements) {
@@ -152,23 +175,29 @@ class RingBuffer
                 elementCount = 2 * 16384;   /* default  */
 
             bufferSize  = elementCount;
-            buffer.resize(2 * bufferSize * sizeof (elementtype));
-            writeIndex  = 0;
-            readIndex   = 0;
+            buffer.resize(bufferSize);
+            writer.index.store(0, std::memory_order_relaxed);
+            writer.cachedOtherIndex = 0;
+            reader.index.store(0, std::memory_order_relaxed);
+            reader.cachedOtherIndex = 0;
             smallMask   = (elementCount)- 1;
             bigMask     = (elementCount * 2) - 1;
         }
 
+        RingBuffer(const RingBuffer&) = delete;
+        RingBuffer& operator=(const RingBuffer&) = delete;
+
         /*
          *  functions for checking available data for reading and space
-         *  for writing
+         *  for writing. These may be called from any thread.
          */
         int32_t GetBufferSize(void) {
             return bufferSize;
         }
 
         int32_t GetRingBufferReadAvailable (void) {
-            return (writeIndex - readIndex) & bigMask;
+            return (writer.index.load(std::memory_order_acquire) -
+                    reader.index.load(std::memory_order_acquire)) & bigMask;
         }
 
         int32_t ReadSpace   (void){
@@ -183,25 +212,87 @@ class RingBuffer
             return GetRingBufferWriteAvailable ();
         }
 
+        /*
+         *  Discard everything that has been written so far. This is a
+         *  read side operation: call it from the reader, or while the
+         *  reader is idle.
+         */
         void    FlushRingBuffer () {
-            writeIndex  = 0;
-            readIndex   = 0;
+            const uint32_t index = writer.index.load(std::memory_order_acquire);
+            reader.cachedOtherIndex = index;
+            reader.index.store(index, std::memory_order_release);
         }
-        /* ensure that previous writes are seen before we update the write index
-           (write after write)
-           */
-        int32_t AdvanceRingBufferWriteIndex (int32_t elementCount) {
-            PaUtil_WriteMemoryBarrier();
-            return writeIndex = (writeIndex + elementCount) & bigMask;
+
+        /*
+         *  Writer side: get up to elementCount elements of free space,
+         *  as one or two contiguous spans. Nothing becomes visible to
+         *  the reader until commitWrite() is called.
+         */
+        WriteRegions acquireWrite (uint32_t elementCount) {
+            const uint32_t index = writer.index.load(std::memory_order_relaxed);
+            uint32_t available =
+                bufferSize - ((index - writer.cachedOtherIndex) & bigMask);
+
+            if (available < elementCount) {
+                // Only look at the reader's index when the cached one
+                // does not give enough room
+                writer.cachedOtherIndex = reader.index.load(std::memory_order_acquire);
+                available = bufferSize - ((index - writer.cachedOtherIndex) & bigMask);
+            }
+
+            if (elementCount > available)
+                elementCount = available;
+
+            return regionsAt<elementtype>(index, elementCount);
         }
 
-        /* ensure that previous reads (copies out of the ring buffer) are
-         * always completed before updating (writing) the read index.
-         * (write-after-read) => full barrier
+        /*
+         *  Writer side: publish elementCount elements filled in the
+         *  spans returned by acquireWrite().
          */
+        void    commitWrite (uint32_t elementCount) {
+            const uint32_t index = writer.index.load(std::memory_order_relaxed);
+            writer.index.store((index + elementCount) & bigMask,
+                    std::memory_order_release);
+        }
+
+        /*
+         *  Reader side: get up to elementCount elements of data, as one
+         *  or two contiguous spans. The data stays valid until release()
+         *  is called.
+         */
+        ReadRegions acquireRead (uint32_t elementCount) {
+            const uint32_t index = reader.index.load(std::memory_order_relaxed);
+            uint32_t available = (reader.cachedOtherIndex - index) & bigMask;
+
+            if (available < elementCount) {
+                reader.cachedOtherIndex = writer.index.load(std::memory_order_acquire);
+                available = (reader.cachedOtherIndex - index) & bigMask;
+            }
+
+            if (elementCount > available)
+                elementCount = available;
+
+            return regionsAt<const elementtype>(index, elementCount);
+        }
+
+        /*
+         *  Reader side: hand elementCount elements back to the writer.
+         */
+        void    release (uint32_t elementCount) {
+            const uint32_t index = reader.index.load(std::memory_order_relaxed);
+            reader.index.store((index + elementCount) & bigMask,
+                    std::memory_order_release);
+        }
+
+        int32_t AdvanceRingBufferWriteIndex (int32_t elementCount) {
+            commitWrite (elementCount);
+            return writer.index.load(std::memory_order_relaxed);
+        }
+
         int32_t AdvanceRingBufferReadIndex (int32_t elementCount) {
-            PaUtil_FullMemoryBarrier();
-            return readIndex = (readIndex + elementCount) & bigMask;
+            release (elementCount);
+            return reader.index.load(std::memory_order_relaxed);
         }
 
         /***************************************************************************
@@ -213,33 +304,12 @@ class RingBuffer
         int32_t GetRingBufferWriteRegions (uint32_t elementCount,
                 void **dataPtr1, int32_t *sizePtr1,
                 void **dataPtr2, int32_t *sizePtr2 ) {
-            uint32_t   index;
-            uint32_t   available = GetRingBufferWriteAvailable ();
-
-            if (elementCount > available)
-                elementCount = available;
-
-            /* Check to see if write is not contiguous. */
-            index = writeIndex & smallMask;
-            if ((index + elementCount) > bufferSize ) {
-                /* Write data in two blocks that wrap the buffer. */
-                int32_t   firstHalf = bufferSize - index;
-                *dataPtr1    = &buffer[index * sizeof(elementtype)];
-                *sizePtr1    = firstHalf;
-                *dataPtr2    = &buffer[0];
-                *sizePtr2    = elementCount - firstHalf;
-            }
-            else {      // fits
-                *dataPtr1    = &buffer[index * sizeof(elementtype)];
-                *sizePtr1    = elementCount;
-                *dataPtr2    = NULL;
-                *sizePtr2    = 0;
-            }
-
-            if (available > 0)
-                PaUtil_FullMemoryBarrier(); /* (write-after-read) => full barrier */
-
-            return elementCount;
+            const auto regions = acquireWrite (elementCount);
+            *dataPtr1   = regions.first.data;
+            *sizePtr1   = regions.first.size;
+            *dataPtr2   = regions.second.size ? regions.second.data : nullptr;
+            *sizePtr2   = regions.second.size;
+            return regions.size();
         }
 
         /***************************************************************************
@@ -251,87 +321,51 @@ class RingBuffer
         int32_t GetRingBufferReadRegions (uint32_t elementCount,
                 void **dataPtr1, int32_t *sizePtr1,
                 void **dataPtr2, int32_t *sizePtr2) {
-            uint32_t   index;
-            uint32_t   available = GetRingBufferReadAvailable (); /* doesn't use memory barrier */
-
-            if (elementCount > available)
-                elementCount = available;
-
-            /* Check to see if read is not contiguous. */
-            index = readIndex & smallMask;
-            if ((index + elementCount) > bufferSize) {
-                /* Write data in two blocks that wrap the buffer. */
-                int32_t firstHalf = bufferSize - index;
-                *dataPtr1 = &buffer[index * sizeof(elementtype)];
-                *sizePtr1 = firstHalf;
-                *dataPtr2 = &buffer[0];
-                *sizePtr2 = elementCount - firstHalf;
-            }
-            else {
-                *dataPtr1 = &buffer[index * sizeof(elementtype)];
-                *sizePtr1 = elementCount;
-                *dataPtr2 = NULL;
-                *sizePtr2 = 0;
-            }
-
-            if (available)
-                PaUtil_ReadMemoryBarrier(); /* (read-after-read) => read barrier */
-
-            return elementCount;
+            const auto regions = acquireRead (elementCount);
+            *dataPtr1   = const_cast<elementtype*>(regions.first.data);
+            *sizePtr1   = regions.first.size;
+            *dataPtr2   = regions.second.size ?
+                const_cast<elementtype*>(regions.second.data) : nullptr;
+            *sizePtr2   = regions.second.size;
+            return regions.size();
         }
 
         int32_t putDataIntoBuffer (const void *data, int32_t elementCount) {
-            int32_t size1, size2, numWritten;
-            void    *data1;
-            void    *data2;
+            const auto regions = acquireWrite (elementCount);
 
-            int32_t freeSpace = GetRingBufferWriteAvailable();
-            int32_t droppedElements = elementCount - freeSpace;
+            int32_t droppedElements = elementCount - regions.size();
             if(droppedElements > 0)
                 onDroppedData(droppedElements);
 
-            numWritten = GetRingBufferWriteRegions (elementCount,
-                    &data1, &size1,
-                    &data2, &size2 );
-            if (size2 > 0) {
-                memcpy (data1, data, size1 * sizeof(elementtype));
-                data = ((char *)data) + size1 * sizeof(elementtype);
-                memcpy (data2, data, size2 * sizeof(elementtype));
-            }
-            else
-                memcpy (data1, data, size1 * sizeof(elementtype));
+            const elementtype *in = static_cast<const elementtype*>(data);
+            memcpy (regions.first.data, in,
+                    regions.first.size * sizeof(elementtype));
+            if (regions.second.size > 0)
+                memcpy (regions.second.data, in + regions.first.size,
+                        regions.second.size * sizeof(elementtype));
 
-            AdvanceRingBufferWriteIndex (numWritten );
-            return numWritten;
+            commitWrite (regions.size());
+            return regions.size();
         }
 
         int32_t getDataFromBuffer (void *data, int32_t elementCount ) {
-            int32_t size1, size2, numRead;
-            void    *data1;
-            void    *data2;
-
-            numRead = GetRingBufferReadRegions (elementCount,
-                    &data1, &size1,
-                    &data2, &size2 );
-            if (size2 > 0) {
-                memcpy (data, data1, size1 * sizeof(elementtype));
-                data = ((char *)data) + size1 *  sizeof(elementtype);
-                memcpy (data, data2, size2 * sizeof(elementtype));
-            }
-            else
-                memcpy (data, data1, size1 * sizeof(elementtype));
+            const auto regions = acquireRead (elementCount);
+
+            elementtype *out = static_cast<elementtype*>(data);
+            memcpy (out, regions.first.data,
+                    regions.first.size * sizeof(elementtype));
+            if (regions.second.size > 0)
+                memcpy (out + regions.first.size, regions.second.data,
+                        regions.second.size * sizeof(elementtype));
 
-            AdvanceRingBufferReadIndex (numRead );
-            return numRead;
+            release (regions.size());
+            return regions.size();
         }
 
         int32_t skipDataInBuffer (int32_t n_values) {
-            //  ensure that we have the correct read and write indices
-            PaUtil_FullMemoryBarrier ();
-            if (n_values > GetRingBufferReadAvailable ())
-                n_values = GetRingBufferReadAvailable ();
-            AdvanceRingBufferReadIndex (n_values);
-            return n_values;
+            const auto regions = acquireRead (n_values);
+            release (regions.size());
+            return regions.size();
         }
 
 };
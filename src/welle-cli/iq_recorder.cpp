@@ -0,0 +1,331 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "iq_recorder.h"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+
+// 64 MiB are more than 15 s at 2.048 MS/s in u8, enough to ride out
+// a stalled disk.
+static const int32_t ringBufferSize = 64 * 1024 * 1024;
+
+// Writes are this large and aligned to it, as O_DIRECT wants them.
+// The segment size is rounded to a multiple of it.
+static const size_t chunkSize = 1024 * 1024;
+static const size_t chunkAlignment = 4096;
+
+static size_t bytesPerSampleOf(const std::string& format)
+{
+    if (format == "s16le" or format == "s16be") {
+        return 4;
+    }
+    else if (format == "cf32") {
+        return 8;
+    }
+    return 2;
+}
+
+IQRecorder::IQRecorder(const std::string& prefix, const std::string& format,
+        size_t maxSegments, uint64_t segmentSize) :
+    prefix(prefix),
+    format(format),
+    maxSegments(maxSegments),
+    segmentSize(std::max<uint64_t>(chunkSize,
+                segmentSize / chunkSize * chunkSize)),
+    bytesPerSample(bytesPerSampleOf(format)),
+    buffer(ringBufferSize)
+{
+}
+
+IQRecorder::~IQRecorder()
+{
+    stop();
+}
+
+bool IQRecorder::start()
+{
+    if (thread.joinable()) {
+        return true;
+    }
+
+    void *p = nullptr;
+    if (posix_memalign(&p, chunkAlignment, chunkSize) != 0) {
+        std::clog << "IQRecorder: Cannot allocate the write buffer" << std::endl;
+        return false;
+    }
+    chunk = static_cast<uint8_t*>(p);
+
+    running = true;
+    thread = std::thread(&IQRecorder::run, this);
+    return true;
+}
+
+void IQRecorder::stop()
+{
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+
+        const auto stats = getStats();
+        std::clog << "IQRecorder: Wrote " << stats.bytesWritten <<
+            " bytes in " << stats.segments << " segments, " <<
+            stats.drops << " drops (" << stats.droppedBytes << " bytes)" <<
+            std::endl;
+    }
+    free(chunk);
+    chunk = nullptr;
+}
+
+void IQRecorder::push(const uint8_t *data, size_t length)
+{
+    if (not running) {
+        return;
+    }
+
+    const size_t skip = std::min(skipBytes, length);
+    data += skip;
+    length -= skip;
+    skipBytes -= skip;
+    if (length == 0) {
+        return;
+    }
+
+    if ((size_t)buffer.WriteSpace() < length) {
+        // Never wait for the disk here, this is the driver thread
+        drops++;
+        droppedBytes += length;
+        skipBytes = (bytesPerSample - length % bytesPerSample) % bytesPerSample;
+        return;
+    }
+
+    buffer.putDataIntoBuffer(data, (int32_t)length);
+}
+
+void IQRecorder::trigger()
+{
+    triggerRequested = true;
+}
+
+IQRecorder::Stats IQRecorder::getStats() const
+{
+    Stats stats;
+    stats.bytesWritten = bytesWritten;
+    stats.segments = segments;
+    stats.drops = drops;
+    stats.droppedBytes = droppedBytes;
+    return stats;
+}
+
+std::string IQRecorder::segmentName(uint64_t number) const
+{
+    char n[32];
+    snprintf(n, sizeof(n), "-%06llu.", (unsigned long long)number);
+    return prefix + n + format + ".iq";
+}
+
+void IQRecorder::run()
+{
+    using namespace std::chrono;
+    auto lastReport = steady_clock::now();
+    uint64_t reportedDrops = 0;
+
+    while (true) {
+        if (triggerRequested.exchange(false)) {
+            handleTrigger();
+        }
+
+        const bool stopping = not running;
+        const size_t available = buffer.ReadSpace();
+
+        const auto now = steady_clock::now();
+        if (now - lastReport > seconds(1)) {
+            const uint64_t d = drops;
+            if (d != reportedDrops) {
+                std::clog << "IQRecorder: Disk too slow, dropped " <<
+                    d - reportedDrops << " times" << std::endl;
+                reportedDrops = d;
+            }
+            lastReport = now;
+        }
+
+        if (available == 0 and stopping) {
+            break;
+        }
+        else if (available < chunkSize and not stopping) {
+            std::this_thread::sleep_for(milliseconds(10));
+            continue;
+        }
+
+        if (fd == -1 and not openSegment()) {
+            break;
+        }
+
+        const size_t length = std::min<uint64_t>(
+                std::min(available, chunkSize), segmentSize - segmentWritten);
+
+        auto spans = buffer.acquireRead((int32_t)length);
+        size_t copied = 0;
+        for (const auto& span : {spans.first, spans.second}) {
+            std::copy(span.data, span.data + span.size, chunk + copied);
+            copied += span.size;
+        }
+        buffer.release((int32_t)copied);
+
+        if (not writeChunk(copied)) {
+            break;
+        }
+
+        if (segmentWritten == segmentSize) {
+            closeSegment();
+        }
+    }
+
+    closeSegment();
+    // Let push() drop everything if the writer gave up
+    running = false;
+}
+
+void IQRecorder::handleTrigger()
+{
+    if (rotatingSegments.empty()) {
+        std::clog << "IQRecorder: Trigger, keeping the following segments" <<
+            std::endl;
+    }
+    else {
+        std::clog << "IQRecorder: Trigger, keeping " <<
+            segmentName(rotatingSegments.front()) << " and later" << std::endl;
+    }
+    rotatingSegments.clear();
+    keepNext = maxSegments;
+}
+
+bool IQRecorder::openSegment()
+{
+    const auto name = segmentName(segmentNumber);
+
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC;
+    directIO = false;
+#ifdef O_DIRECT
+    fd = ::open(name.c_str(), flags | O_DIRECT, 0644);
+    if (fd != -1) {
+        directIO = true;
+    }
+    else if (errno == EINVAL) {
+        // The file system does not support O_DIRECT, e.g. tmpfs
+        fd = ::open(name.c_str(), flags, 0644);
+    }
+#else
+    fd = ::open(name.c_str(), flags, 0644);
+#endif
+
+    if (fd == -1) {
+        std::clog << "IQRecorder: Cannot open " << name << ": " <<
+            strerror(errno) << std::endl;
+        return false;
+    }
+
+#if defined(__linux__)
+    // Allocate the whole segment now so that the file system does not
+    // have to find space for every write. Not all of them support it.
+    // The file size stays that of the samples written, so that segments
+    // are complete even if welle-cli is killed.
+    fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, (off_t)segmentSize);
+#endif
+
+    segmentWritten = 0;
+    segments++;
+
+    if (keepNext > 0) {
+        keepNext--;
+    }
+    else {
+        rotatingSegments.push_back(segmentNumber);
+        while (maxSegments > 0 and rotatingSegments.size() > maxSegments) {
+            const auto oldName = segmentName(rotatingSegments.front());
+            if (::unlink(oldName.c_str()) != 0) {
+                std::clog << "IQRecorder: Cannot delete " << oldName << ": " <<
+                    strerror(errno) << std::endl;
+            }
+            rotatingSegments.pop_front();
+        }
+    }
+
+    segmentNumber++;
+    return true;
+}
+
+void IQRecorder::closeSegment()
+{
+    if (fd == -1) {
+        return;
+    }
+
+    if (segmentWritten < segmentSize) {
+        // Give back what was preallocated but not written
+        if (::ftruncate(fd, (off_t)segmentWritten) != 0) {
+            std::clog << "IQRecorder: Cannot truncate segment: " <<
+                strerror(errno) << std::endl;
+        }
+    }
+    ::close(fd);
+    fd = -1;
+}
+
+bool IQRecorder::writeChunk(size_t length)
+{
+#ifdef O_DIRECT
+    if (directIO and length % chunkAlignment != 0) {
+        // Only the last write when stopping is not aligned
+        const int flags = fcntl(fd, F_GETFL);
+        fcntl(fd, F_SETFL, flags & ~O_DIRECT);
+        directIO = false;
+    }
+#endif
+
+    size_t written = 0;
+    while (written < length) {
+        const ssize_t ret = ::write(fd, chunk + written, length - written);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::clog << "IQRecorder: Write failed: " << strerror(errno) <<
+                std::endl;
+            return false;
+        }
+        written += (size_t)ret;
+    }
+
+    segmentWritten += length;
+    bytesWritten += length;
+    return true;
+}
@@ -0,0 +1,111 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#pragma once
+
+#include "input/virtual_input.h"
+#include "various/ringbuffer.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <thread>
+
+/* Records the raw samples of the input continuously to disk.
+ *
+ * The driver hands its samples to push(), which only copies them into a
+ * large ring buffer and drops them if it is full. A writer thread takes
+ * them out in large aligned chunks and writes them with O_DIRECT, where
+ * available, into preallocated segment files
+ * <prefix>-<number>.<format>.iq.
+ *
+ * With maxSegments > 0, only the last maxSegments segments are kept and
+ * older ones are deleted. These segments are the pre-trigger window:
+ * trigger() keeps them, and as many segments after them, for good.
+ */
+class IQRecorder : public IQRecordSink {
+    public:
+        static const uint64_t defaultSegmentSize = 256 * 1024 * 1024;
+
+        IQRecorder(const std::string& prefix, const std::string& format,
+                size_t maxSegments, uint64_t segmentSize = defaultSegmentSize);
+        ~IQRecorder();
+        IQRecorder(const IQRecorder& other) = delete;
+        IQRecorder& operator=(const IQRecorder& other) = delete;
+
+        bool start(void);
+        void stop(void);
+
+        // Called from the driver thread
+        virtual void push(const uint8_t *data, size_t length) override;
+
+        // Only sets a flag for the writer thread, this can be called from
+        // a signal handler.
+        void trigger(void);
+
+        struct Stats {
+            uint64_t bytesWritten = 0;
+            uint64_t segments = 0;
+            uint64_t drops = 0;
+            uint64_t droppedBytes = 0;
+        };
+        Stats getStats(void) const;
+
+    private:
+        void run(void);
+        void handleTrigger(void);
+        bool openSegment(void);
+        void closeSegment(void);
+        bool writeChunk(size_t length);
+        std::string segmentName(uint64_t number) const;
+
+        const std::string prefix;
+        const std::string format;
+        const size_t maxSegments;
+        const uint64_t segmentSize;
+        size_t bytesPerSample = 2;
+
+        RingBuffer<uint8_t> buffer;
+        // Bytes push() still has to drop so that the samples after a drop
+        // start on a sample boundary
+        size_t skipBytes = 0;
+
+        std::thread thread;
+        std::atomic<bool> running = ATOMIC_VAR_INIT(false);
+        std::atomic<bool> triggerRequested = ATOMIC_VAR_INIT(false);
+
+        // Writer thread state
+        uint8_t *chunk = nullptr;
+        int fd = -1;
+        bool directIO = false;
+        uint64_t segmentNumber = 0;
+        uint64_t segmentWritten = 0;
+        std::deque<uint64_t> rotatingSegments;
+        size_t keepNext = 0;
+
+        std::atomic<uint64_t> bytesWritten = ATOMIC_VAR_INIT(0);
+        std::atomic<uint64_t> segments = ATOMIC_VAR_INIT(0);
+        std::atomic<uint64_t> drops = ATOMIC_VAR_INIT(0);
+        std::atomic<uint64_t> droppedBytes = ATOMIC_VAR_INIT(0);
+};
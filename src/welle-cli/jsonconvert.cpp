@@ -60,10 +60,37 @@ static void to_json(nlohmann::json& j, const SoftwareJson& s) {
     };
 }
 
+static void to_json(nlohmann::json& j, const InputDropEvent& d) {
+    j = nlohmann::json{
+        {"sampleindex", d.sampleIndex},
+        {"count", d.count}
+    };
+}
+
+static void to_json(nlohmann::json& j, const InputStats& i) {
+    j = nlohmann::json{
+        {"samples", i.samples},
+        {"droppedsamples", i.dropped},
+        {"dropevents", i.dropEvents},
+        {"recentdrops", i.recentDrops}
+    };
+}
+
+static void to_json(nlohmann::json& j, const IQCorrectionStats& c) {
+    j = nlohmann::json{
+        {"enabled", c.enabled},
+        {"dcoffset", {{"i", c.dcOffsetI}, {"q", c.dcOffsetQ}}},
+        {"gainimbalance", c.gainImbalance},
+        {"phaseimbalance", c.phaseImbalance}
+    };
+}
+
 static void to_json(nlohmann::json& j, const HardwareJson& h) {
     j = nlohmann::json{
         {"name", h.name},
-        {"gain", h.gain}
+        {"gain", h.gain},
+        {"input", h.input},
+        {"iqcorrection", h.iqcorrection}
     };
 }
 
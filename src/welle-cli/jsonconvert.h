@@ -45,6 +45,8 @@ struct SoftwareJson {
 struct HardwareJson {
     std::string name;
     float gain = 0.0f;
+    InputStats input;
+    IQCorrectionStats iqcorrection;
 };
 
 struct ReceiverJson {
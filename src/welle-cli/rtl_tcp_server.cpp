@@ -0,0 +1,327 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "rtl_tcp_server.h"
+#include "input/rtl_tcp.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+// About 2 s at 2.048 MS/s. A client that lags by more than half of it
+// is disconnected.
+static const size_t ringSize = 8 * 1024 * 1024;
+static const uint64_t maxLag = ringSize / 2;
+
+static const size_t sendChunkSize = 64 * 1024;
+static const int sendTimeout_ms = 1000;
+
+// How often the threads look whether they have to stop
+static const int pollInterval_ms = 200;
+
+RtlTcpServer::RtlTcpServer(const std::string& format, uint32_t gainCount) :
+    format(format),
+    gainCount(gainCount),
+    ring(ringSize)
+{
+}
+
+RtlTcpServer::~RtlTcpServer()
+{
+    stop();
+}
+
+bool RtlTcpServer::supportsFormat(const std::string& format)
+{
+    return format == "u8" or format == "s8" or
+        format == "s16le" or format == "s16be";
+}
+
+bool RtlTcpServer::start(int port)
+{
+    if (acceptThread.joinable()) {
+        return true;
+    }
+
+    if (not supportsFormat(format)) {
+        std::clog << "RtlTcpServer: " << format << " samples are not supported" << std::endl;
+        return false;
+    }
+
+    if (not listenSocket.bind(port) or not listenSocket.listen()) {
+        std::clog << "RtlTcpServer: Could not listen on port " << port << std::endl;
+        return false;
+    }
+    listenSocket.setReceiveTimeout(pollInterval_ms);
+
+    std::clog << "RtlTcpServer: Listening on port " << port << std::endl;
+    running = true;
+    acceptThread = std::thread(&RtlTcpServer::acceptConnections, this);
+    return true;
+}
+
+void RtlTcpServer::stop()
+{
+    if (not acceptThread.joinable()) {
+        return;
+    }
+
+    running = false;
+    {
+        std::lock_guard<std::mutex> lock(dataMutex);
+    }
+    dataAvailable.notify_all();
+
+    acceptThread.join();
+    removeFinishedClients(true);
+    listenSocket.close();
+}
+
+void RtlTcpServer::push(const uint8_t *data, size_t length)
+{
+    // The position in the input decides which bytes of S16 are used
+    const uint64_t inputOffset = inputBytes;
+    inputBytes += length;
+
+    const size_t mask = ring.size() - 1;
+    uint64_t position = writePosition.load(std::memory_order_relaxed);
+
+    if (format == "u8") {
+        const size_t offset = position & mask;
+        const size_t first = std::min(length, ring.size() - offset);
+        std::memcpy(&ring[offset], data, first);
+        std::memcpy(&ring[0], data + first, length - first);
+        position += length;
+    }
+    else if (format == "s8") {
+        for (size_t i = 0; i < length; i++) {
+            ring[position++ & mask] = data[i] ^ 0x80;
+        }
+    }
+    else {
+        // The upper byte of every value
+        const uint64_t upper = format == "s16le" ? 1 : 0;
+        for (size_t i = 0; i < length; i++) {
+            if (((inputOffset + i) & 1) == upper) {
+                ring[position++ & mask] = data[i] ^ 0x80;
+            }
+        }
+    }
+
+    writePosition.store(position, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(dataMutex);
+    }
+    dataAvailable.notify_all();
+}
+
+RtlTcpServer::Stats RtlTcpServer::getStats() const
+{
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        for (const auto& client : clients) {
+            if (client->connected) {
+                stats.clients++;
+            }
+        }
+    }
+    stats.connections = connections;
+    stats.slowClientsDropped = slowClientsDropped;
+    stats.bytesSent = bytesSent;
+    return stats;
+}
+
+void RtlTcpServer::acceptConnections()
+{
+    while (running) {
+        Socket sock = listenSocket.accept();
+        removeFinishedClients(false);
+
+        if (not sock.valid()) {
+            // Timeout, look at running again
+            continue;
+        }
+
+        sock.setSendTimeout(sendTimeout_ms);
+        sock.setReceiveTimeout(pollInterval_ms);
+
+        auto client = std::make_unique<Client>();
+        client->sock = std::move(sock);
+        client->name = "client " + std::to_string(++connections);
+        std::clog << "RtlTcpServer: " << client->name << " connected" << std::endl;
+
+        Client& c = *client;
+        {
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            clients.push_back(std::move(client));
+        }
+        c.sender = std::thread(&RtlTcpServer::sendSamples, this, std::ref(c));
+        c.receiver = std::thread(&RtlTcpServer::receiveCommands, this, std::ref(c));
+    }
+}
+
+void RtlTcpServer::removeFinishedClients(bool all)
+{
+    std::list<std::unique_ptr<Client>> finished;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        for (auto it = clients.begin(); it != clients.end(); ) {
+            if (all) {
+                (*it)->connected = false;
+            }
+
+            if (not (*it)->connected) {
+                finished.push_back(std::move(*it));
+                it = clients.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(dataMutex);
+    }
+    dataAvailable.notify_all();
+
+    for (auto& client : finished) {
+        client->sender.join();
+        client->receiver.join();
+        std::clog << "RtlTcpServer: " << client->name << " disconnected" << std::endl;
+    }
+}
+
+void RtlTcpServer::sendSamples(Client& client)
+{
+    dongle_info_t info;
+    std::memcpy(info.magic, "RTL0", sizeof(info.magic));
+    info.tuner_type = htonl(0);     // Unknown, the tuner is not controlled
+    info.tuner_gain_count = htonl(gainCount);
+    if (client.sock.send(&info, sizeof(info), MSG_NOSIGNAL) != sizeof(info)) {
+        client.connected = false;
+        return;
+    }
+
+    // Start with the newest samples, on an I value
+    uint64_t position = writePosition.load(std::memory_order_acquire) & ~(uint64_t)1;
+    bool slow = false;
+
+    while (running and client.connected) {
+        {
+            std::unique_lock<std::mutex> lock(dataMutex);
+            dataAvailable.wait_for(lock, std::chrono::milliseconds(pollInterval_ms),
+                    [&]() { return writePosition > position or
+                                   not running or not client.connected; });
+        }
+
+        const uint64_t end = writePosition.load(std::memory_order_acquire);
+        if (end - position > maxLag) {
+            slow = true;
+            break;
+        }
+        if (end == position) {
+            continue;
+        }
+
+        const size_t offset = position & (ring.size() - 1);
+        const size_t length = std::min<uint64_t>({end - position,
+                ring.size() - offset, sendChunkSize});
+        const ssize_t sent = client.sock.send(&ring[offset], length, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            slow = sent < 0 and (errno == EAGAIN or errno == EWOULDBLOCK);
+            break;
+        }
+
+        // The samples may have been overwritten while they were sent
+        if (writePosition.load(std::memory_order_acquire) - position > ring.size()) {
+            slow = true;
+            break;
+        }
+
+        position += sent;
+        bytesSent += sent;
+    }
+
+    if (slow) {
+        slowClientsDropped++;
+        std::clog << "RtlTcpServer: " << client.name <<
+            " does not keep up, disconnecting it" << std::endl;
+    }
+    client.connected = false;
+}
+
+void RtlTcpServer::receiveCommands(Client& client)
+{
+    uint8_t command[5];
+    size_t received = 0;
+    std::vector<bool> reported(256, false);
+
+    while (running and client.connected) {
+        const ssize_t ret = client.sock.recv(command + received,
+                sizeof(command) - received, 0);
+        if (ret == 0) {
+            break;
+        }
+        else if (ret < 0) {
+            if (errno == EAGAIN or errno == EWOULDBLOCK or errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        received += ret;
+        if (received < sizeof(command)) {
+            continue;
+        }
+        received = 0;
+
+        const uint32_t param = (command[1] << 24) | (command[2] << 16) |
+            (command[3] << 8) | command[4];
+
+        // Tell once per command that it is not applied
+        if (not reported[command[0]]) {
+            reported[command[0]] = true;
+
+            std::ostringstream ss;
+            ss << "RtlTcpServer: " << client.name << " sent command " <<
+                (int)command[0] << " (" << param << "), ";
+            switch (static_cast<RtlTcpCommand>(command[0])) {
+                case RtlTcpCommand::SetSampleRate:
+                    ss << (param == INPUT_RATE ? "matches" : "does not match") <<
+                        " the sample rate";
+                    break;
+                default:
+                    ss << "ignoring it, the tuner is controlled by welle-cli";
+            }
+            std::clog << ss.str() << std::endl;
+        }
+    }
+
+    client.connected = false;
+}
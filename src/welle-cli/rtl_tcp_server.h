@@ -0,0 +1,114 @@
+/*
+ *    Copyright (C) 2026
+ *    welle.io contributors
+ *
+ *    This file is part of the welle.io.
+ *    Many of the ideas as implemented in welle.io are derived from
+ *    other work, made available through the GNU general Public License.
+ *    All copyrights of the original authors are recognized.
+ *
+ *    welle.io is free software; you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation; either version 2 of the License, or
+ *    (at your option) any later version.
+ *
+ *    welle.io is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with welle.io; if not, write to the Free Software
+ *    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#pragma once
+
+#include "input/virtual_input.h"
+#include "various/Socket.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Serves the raw samples of the input with the rtl_tcp protocol, so that
+ * other programs can use the tuner welle-cli has open.
+ *
+ * The driver hands its samples to push(), which converts them to
+ * unsigned 8-bit I/Q and writes them into one ring buffer for all
+ * clients. Every client has a thread that sends from its own position
+ * in the ring. A client that falls behind by more than half the ring,
+ * or whose socket does not take data for a second, is disconnected; the
+ * driver never waits for a client.
+ *
+ * The tuner stays under the control of welle-cli. The commands of the
+ * clients are read, but not applied.
+ */
+class RtlTcpServer : public IQRecordSink {
+    public:
+        // format is the record format of the input
+        RtlTcpServer(const std::string& format, uint32_t gainCount);
+        ~RtlTcpServer();
+        RtlTcpServer(const RtlTcpServer& other) = delete;
+        RtlTcpServer& operator=(const RtlTcpServer& other) = delete;
+
+        static bool supportsFormat(const std::string& format);
+
+        bool start(int port);
+        void stop(void);
+
+        // Called from the driver thread
+        virtual void push(const uint8_t *data, size_t length) override;
+
+        struct Stats {
+            size_t clients = 0;
+            uint64_t connections = 0;
+            uint64_t slowClientsDropped = 0;
+            uint64_t bytesSent = 0;
+        };
+        Stats getStats(void) const;
+
+    private:
+        struct Client {
+            Socket sock;
+            std::string name;
+            std::thread sender;
+            std::thread receiver;
+            std::atomic<bool> connected = ATOMIC_VAR_INIT(true);
+            std::atomic<bool> finished = ATOMIC_VAR_INIT(false);
+        };
+
+        void acceptConnections(void);
+        void sendSamples(Client& client);
+        void receiveCommands(Client& client);
+        void removeFinishedClients(bool all);
+
+        const std::string format;
+        const uint32_t gainCount;
+
+        // Converted samples. writePosition counts all bytes ever written,
+        // the ring holds the last ring.size() of them.
+        std::vector<uint8_t> ring;
+        std::atomic<uint64_t> writePosition = ATOMIC_VAR_INIT(0);
+        uint64_t inputBytes = 0;
+
+        std::mutex dataMutex;
+        std::condition_variable dataAvailable;
+
+        Socket listenSocket;
+        std::thread acceptThread;
+        std::atomic<bool> running = ATOMIC_VAR_INIT(false);
+
+        mutable std::mutex clientsMutex;
+        std::list<std::unique_ptr<Client>> clients;
+
+        std::atomic<uint64_t> connections = ATOMIC_VAR_INIT(0);
+        std::atomic<uint64_t> slowClientsDropped = ATOMIC_VAR_INIT(0);
+        std::atomic<uint64_t> bytesSent = ATOMIC_VAR_INIT(0);
+};
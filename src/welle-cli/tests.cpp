@@ -33,10 +33,10 @@
 #include "tests.h"
 #include "backend/radio-receiver.h"
 #include "raw_file.h"
+#include "impaired_input.h"
 #include "various/profiling.h"
 #include <algorithm>
 #include <numeric>
-#include <random>
 #include <condition_variable>
 #include <deque>
 #include <iostream>
@@ -45,78 +45,6 @@
 
 using namespace std;
 
-static random_device rd;
-static mt19937 random_generator(rd());
-
-class ChannelSimulator : public CVirtualInput
-{
-    private:
-        CVirtualInput* parentInput;
-        normal_distribution<> distr;
-
-    public:
-        size_t num_samps = 0;
-
-        ChannelSimulator(unique_ptr<CVirtualInput>& parent, double stddev) :
-            parentInput(parent.get()),
-            distr(0.0, stddev) {}
-
-        virtual ~ChannelSimulator() {}
-
-        virtual CDeviceID getID(void) { return parentInput->getID(); }
-        virtual void setFrequency(int frequency)
-            { parentInput->setFrequency(frequency); }
-
-        virtual int getFrequency(void) const
-            { return parentInput->getFrequency(); }
-
-        virtual bool restart(void)
-            { return parentInput->restart(); }
-        virtual bool is_ok(void)
-            { return parentInput->is_ok(); }
-        virtual void stop(void)
-            { return parentInput->stop(); }
-        virtual void reset(void)
-            { return parentInput->reset(); }
-
-        virtual int32_t getSamples(DSPCOMPLEX* buffer, int32_t size)
-        {
-            int32_t r = parentInput->getSamples(buffer, size);
-
-            num_samps += r;
-
-            // Add gaussian noise, with stddev on I and Q
-            // This is not equivalent to complex noise of the same stddev!
-            for (int32_t i = 0; i < size; i++) {
-                buffer[0] += distr(random_generator);
-                buffer[1] += distr(random_generator);
-            }
-
-            return r;
-        }
-
-        virtual vector<DSPCOMPLEX> getSpectrumSamples(int size)
-            { return parentInput->getSpectrumSamples(size); }
-
-        virtual int32_t getSamplesToRead(void)
-            { return parentInput->getSamplesToRead(); }
-
-        virtual float getGain() const
-            { return parentInput->getGain(); }
-
-        virtual float setGain(int gain)
-            { return parentInput->setGain(gain); }
-
-        virtual int getGainCount(void)
-            { return parentInput->getGainCount(); }
-
-        virtual void setAgc(bool agc)
-            { return parentInput->setAgc(agc); }
-
-        virtual std::string getDescription(void)
-            { return parentInput->getDescription() + " with ChannelSimulator"; }
-};
-
 class TestRadioInterface : public RadioControllerInterface {
     private:
         struct FILEDeleter{ void operator()(FILE* fd){ if (fd) fclose(fd); }};
@@ -238,16 +166,44 @@ class TestProgrammeHandler: public ProgrammeHandlerInterface {
         }
 };
 
-Tests::Tests(std::unique_ptr<CVirtualInput>& interface, RadioReceiverOptions rro) :
+Tests::Tests(std::unique_ptr<CVirtualInput>& interface, RadioReceiverOptions rro,
+        const ImpairmentSettings& impairments) :
     input_interface(interface),
-    rro(rro) {}
+    rro(rro),
+    impairments(impairments) {}
+
+// Recordings are played to their end, other inputs for a minute of signal
+static void wait_for_completion(CVirtualInput& input)
+{
+    auto in_file = dynamic_cast<CRAWFile*>(&input);
+    const uint64_t end = input.getInputStats().samples + 60 * INPUT_RATE;
+
+    while (in_file ? not in_file->endWasReached() :
+            input.getInputStats().samples < end) {
+        this_thread::sleep_for(chrono::milliseconds(120));
+    }
+}
+
+static string input_name(CVirtualInput& input)
+{
+    auto in_file = dynamic_cast<CRAWFile*>(&input);
+    return in_file ? in_file->getFileName() : "\"" + input.getDescription() + "\"";
+}
+
+static void rewind_input(CVirtualInput& input)
+{
+    auto in_file = dynamic_cast<CRAWFile*>(&input);
+    if (in_file) {
+        in_file->rewind();
+    }
+}
 
-void Tests::test_with_noise_iteration(double stddev)
+void Tests::test_with_impairments(const ImpairmentSettings& settings)
 {
     cerr << "Setup test0" << endl;
     TestProgrammeHandler tph;
 
-    ChannelSimulator s(input_interface, stddev);
+    CImpairedInput s(*input_interface, settings);
     TestRadioInterface ri;
     RadioReceiver rx(ri, s, rro);
 
@@ -272,13 +228,12 @@ void Tests::test_with_noise_iteration(double stddev)
     }
 
     cerr << "Wait for completion" << endl;
-    while (not dynamic_cast<CRAWFile&>(*input_interface).endWasReached()) {
-        this_thread::sleep_for(chrono::milliseconds(120));
-    }
+    wait_for_completion(*input_interface);
 
     cerr << endl;
-    cerr << "STDDEV " << stddev << endl;
-    cerr << "Num samps processed: " << s.num_samps << endl;
+    cerr << "Impairments: " << settings.describe() << endl;
+    cerr << "Num frames processed: " << rx.getReceiverStats().numFramesProcessed << endl;
+    cerr << "Num frames dropped: " << rx.getReceiverStats().numFramesDropped << endl;
     cerr << "Num syncs/desyncs: " << ri.num_syncs << "/" << ri.num_desyncs << endl;
     cerr << "frameErrorStats (" << tph.frameErrorStats.size() << ") : " <<
         std::accumulate(tph.frameErrorStats.begin(), tph.frameErrorStats.end(), 0)
@@ -294,11 +249,13 @@ void Tests::test_with_noise_iteration(double stddev)
 
 void Tests::test_with_noise()
 {
-    double stddevs[] = {0.001, 0.01, 0.1};
+    const float snrs[] = {20, 10, 7, 5, 3};
 
-    for (double stddev : stddevs) {
-        test_with_noise_iteration(stddev);
-        dynamic_cast<CRAWFile&>(*input_interface).rewind();
+    for (float snr : snrs) {
+        auto settings = impairments;
+        settings.snr = snr;
+        test_with_impairments(settings);
+        rewind_input(*input_interface);
     }
 }
 
@@ -319,7 +276,8 @@ void Tests::test_multipath(int test_id)
 
     rro.fftPlacementMethod = (test_id == 1 ? FFTPlacementMethod::StrongestPeak : FFTPlacementMethod::EarliestPeakWithBinning);
     const auto start_time = chrono::steady_clock::now();
-    RadioReceiver rx(ri, *input_interface.get(), rro);
+    CImpairedInput s(*input_interface, impairments);
+    RadioReceiver rx(ri, s, rro);
 
     cerr << "Restart rx" << endl;
     rx.restart(false);
@@ -342,10 +300,7 @@ void Tests::test_multipath(int test_id)
     }
 
     cerr << "Wait for completion" << endl;
-    auto& intf = dynamic_cast<CRAWFile&>(*input_interface);
-    while (not intf.endWasReached()) {
-        this_thread::sleep_for(chrono::milliseconds(120));
-    }
+    wait_for_completion(*input_interface);
 
     FILE *fd = fopen("test1.csv", "a");
     const int pos = ftell(fd);
@@ -358,7 +313,7 @@ void Tests::test_multipath(int test_id)
     }
 
     fprintf(fd, "%s,%s,%d,%zu,%zu,%lld,%d,%d,%d\n",
-            intf.getFileName().c_str(),
+            input_name(*input_interface).c_str(),
             fftPlacementMethodToString(rro.fftPlacementMethod),
             rro.disableCoarseCorrector ? 0 : 1,
             ri.num_syncs, ri.num_desyncs,
@@ -375,6 +330,6 @@ void Tests::run_test(int test_id)
 
     if (test_id == 0) test_with_noise();
     else if (test_id == 1 or test_id == 2) test_multipath(test_id);
-    else if (test_id == 3) test_with_noise_iteration(0);
+    else if (test_id == 3) test_with_impairments(impairments);
     else cerr << "Test " << test_id << " does not exist!" << endl;
 }
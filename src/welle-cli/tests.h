@@ -32,20 +32,25 @@
 
 #include "input/input_factory.h"
 #include "radio-receiver-options.h"
+#include "various/channel_impairments.h"
 #include <memory>
 
 class Tests {
     public:
+        // The impairments are applied in all tests, test 0 replaces
+        // their SNR
         Tests(std::unique_ptr<CVirtualInput>& input_interface,
-                RadioReceiverOptions rro);
+                RadioReceiverOptions rro,
+                const ImpairmentSettings& impairments = ImpairmentSettings());
 
         void run_test(int test_id);
 
     private:
         void test_with_noise();
-        void test_with_noise_iteration(double stddev);
+        void test_with_impairments(const ImpairmentSettings& settings);
         void test_multipath(int test_id);
 
         std::unique_ptr<CVirtualInput>& input_interface;
         RadioReceiverOptions rro;
+        ImpairmentSettings impairments;
 };
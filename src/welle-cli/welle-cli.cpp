@@ -31,6 +31,7 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>
 #include <deque>
 #include <iostream>
@@ -39,6 +40,7 @@
 #include <thread>
 #include <set>
 #include <utility>
+#include <csignal>
 #include <cstdio>
 #include <unistd.h>
 #ifdef HAVE_SOAPYSDR
@@ -50,8 +52,15 @@
 #endif
 #include "welle-cli/webradiointerface.h"
 #include "welle-cli/tests.h"
+#include "welle-cli/iq_recorder.h"
+#include "welle-cli/rtl_tcp_server.h"
 #include "backend/radio-receiver.h"
 #include "input/input_factory.h"
+#include "input/channelizer.h"
+#include "input/dab_generator.h"
+#include "input/impaired_input.h"
+#include "input/multicast_input.h"
+#include "input/multicast_publisher.h"
 #include "input/raw_file.h"
 #include "various/channels.h"
 #include "libs/json.hpp"
@@ -178,7 +187,11 @@ class RadioInterface : public RadioControllerInterface {
         virtual void onSNR(float /*snr*/) override { }
         virtual void onFrequencyCorrectorChange(int /*fine*/, int /*coarse*/) override { }
         virtual void onSyncChange(char isSync) override { synced = isSync; }
-        virtual void onSignalPresence(bool /*isSignal*/) override { }
+        virtual void onSignalPresence(bool isSignal) override
+        {
+            signal_present = isSignal;
+            signal_decided = true;
+        }
         virtual void onServiceDetected(uint32_t sId) override
         {
             cout << "New Service: 0x" << hex << sId << dec << endl;
@@ -269,6 +282,8 @@ class RadioInterface : public RadioControllerInterface {
 
         json last_date_time;
         bool synced = false;
+        atomic<bool> signal_decided{false};
+        atomic<bool> signal_present{false};
         FILE* fic_fd = nullptr;
 };
 
@@ -283,11 +298,23 @@ struct options_t {
     string frontend_args = "";
     bool dump_programme = false;
     bool decode_all_programmes = false;
+    bool offline = false;
     int num_decoders_in_carousel = 0;
     bool carousel_pad = false;
     int web_port = -1; // positive value means enable
     list<int> tests;
     string outputcodec = "";
+    string iqrecord_prefix = "";
+    size_t iqrecord_segments = 0;
+    list<string> wideband_channels;
+    uint32_t wideband_rate = 0;
+    bool impaired = false;
+    ImpairmentSettings impairments;
+    bool iq_correction = false;
+    int rtl_tcp_port = -1;
+    string multicast_address = "";
+    iqmulticast::Format multicast_format = iqmulticast::Format::CF32;
+    bool scan = false;
 
     RadioReceiverOptions rro;
 };
@@ -305,6 +332,8 @@ static void usage()
     "Tuning:" << endl <<
     "    -c channel    Tune to <channel> (eg. 10B, 5A, LD...)." << endl <<
     "    -p programme  Play <programme> with ALSA (text name of the radio: eg. GRIFF)." << endl <<
+    "    -L            Scan all channels and list the ensembles found on them." << endl <<
+    "                  Channels without a DAB signal are skipped after 200 ms." << endl <<
     endl <<
     "Dumping:" << endl <<
     "    -D            Dump FIC and all programmes to files (cannot be used with -C)." << endl <<
@@ -323,10 +352,22 @@ static void usage()
     "                  With the -P option, welle-cli will switch once DLS and a" << endl <<
     "                  slide were decoded, staying at most 80 seconds on a given" << endl <<
     "                  programme." << endl <<
+    "    -W channels   Receive several channels with one device, separated by" << endl <<
+    "                  commas (eg. 12A,12B,12C). The device is tuned between" << endl <<
+    "                  them and runs at the rate given with -R. Channel n is" << endl <<
+    "                  served on port <port> + n." << endl <<
+    "    -R rate       Sample rate of the device for -W, a multiple of 8000" << endl <<
+    "                  (eg. 8192000). Supported by the soapysdr driver and IQ" << endl <<
+    "                  files." << endl <<
     endl <<
     "Backend and input options:" << endl <<
     "    -f file       Read an IQ file <file> and play with ALSA." << endl <<
     "                  IQ file format is u8, unless the file ends with 'FORMAT.iq'." << endl <<
+    "                  Files ending with '.wiq' are compressed IQ containers." << endl <<
+    "    -b            Decode the IQ file given with -f as fast as possible instead" << endl <<
+    "                  of in real time, write the programmes to <programme_name.wav>" << endl <<
+    "                  files and report the decoding speed. Decodes all programmes" << endl <<
+    "                  with -D, otherwise the one selected with -p." << endl <<
     "    -u            Disable coarse corrector, for receivers who have a low " << endl <<
     "                  frequency offset." << endl <<
     "    -g gain       Set input gain to <gain> or -1 for auto gain." << endl <<
@@ -337,10 +378,42 @@ static void usage()
     "                  android_rtl_sdr, rtl_tcp, soapysdr." << endl <<
     "                  With \"rtl_tcp\", host IP and port can be specified as " << endl <<
     "                  \"rtl_tcp,<HOST_IP>:<PORT>\"." << endl <<
+    "                  \"generator,<N>\" synthesises an ensemble with N services" << endl <<
+    "                  (1 to 64) instead of receiving one." << endl <<
+    "                  \"multicast,<GROUP>:<PORT>[:<INTERFACE_IP>]\" receives the" << endl <<
+    "                  IQ samples another welle-cli publishes with -m." << endl <<
     "    -s args       SoapySDR Driver arguments." << endl <<
     "    -A antenna    Set input antenna to ANT (for SoapySDR input only)." << endl <<
     "    -T            Disable TII decoding to reduce CPU usage." << endl <<
+    "    -j threads    Compute the FFTs of the OFDM symbols on <threads> threads" << endl <<
+    "                  (default 1), for machines whose cores are too slow to" << endl <<
+    "                  demodulate a whole frame in time." << endl <<
     "    -O            Output Codec for web streaming : mp3 (default), flac (lossless)" << endl <<
+    "    -Q            Remove the DC offset and the IQ imbalance of the tuner." << endl <<
+    "                  Supported with the rtl_sdr and rtl_tcp drivers and with" << endl <<
+    "                  IQ files in an integer format." << endl <<
+    "    -I spec       Degrade the input signal to measure the sensitivity of the" << endl <<
+    "                  receiver. <spec> is a comma-separated list of snr=<dB>," << endl <<
+    "                  cfo=<Hz>, sco=<ppm>, iq=<dB>:<degrees>, seed=<n> and" << endl <<
+    "                  path=<delay>:<gain dB>[:<Doppler Hz>[:<phase degrees>]]," << endl <<
+    "                  with the delay in samples. path can be given several times." << endl <<
+    "                  The SNR sweep of test 0 uses the other settings." << endl <<
+    endl <<
+    "Recording:" << endl <<
+    "    -r prefix     Record the IQ samples continuously to files" << endl <<
+    "                  <prefix>-NNNNNN.FORMAT.iq of 256 MiB each. Supported with" << endl <<
+    "                  the rtl_sdr and rtl_tcp drivers and with IQ files." << endl <<
+    "    -k segments   Keep only the last <segments> files on disk. Send SIGUSR1" << endl <<
+    "                  to welle-cli to keep them and the next <segments> files," << endl <<
+    "                  e.g. when something interesting happened." << endl <<
+    "    -S port       Serve the IQ samples of the input with the rtl_tcp protocol" << endl <<
+    "                  on port <port>, so that other programs can share the tuner." << endl <<
+    "                  The clients cannot retune it. Supported with the rtl_sdr" << endl <<
+    "                  and rtl_tcp drivers and with IQ files." << endl <<
+    "    -m address    Publish the IQ samples the receiver reads to a multicast" << endl <<
+    "                  group, given as <group>:<port>[:<interface IP>][,<format>]" << endl <<
+    "                  with the format cf32 (default) or cs8. Receive them with" << endl <<
+    "                  -F multicast,<group>:<port>." << endl <<
     endl <<
     "Other options:" << endl <<
     "    -t test_id    Run test <test_id>." << endl <<
@@ -356,6 +429,9 @@ static void usage()
     "welle-cli -f ./ofdm.iq -p GRRIF" << endl <<
     "    Read IQ file './ofdm.iq' (in u8 format) and play programme 'GRIFF' with ALSA." << endl <<
     endl <<
+    "welle-cli -f ./ofdm.iq -b -D" << endl <<
+    "    Decode all programmes from IQ file './ofdm.iq' as fast as possible." << endl <<
+    endl <<
     "welle-cli -f ./ofdm.iq -t 1" << endl <<
     "    Read IQ file './ofdm.iq' (in u8 format), and run test 1." << endl <<
     endl <<
@@ -363,6 +439,29 @@ static void usage()
     "    Receive 'GRRIF' on channel '10B' using 'rtl_tcp' driver on localhost:1234," << endl <<
     "    and play with ALSA." << endl <<
     endl <<
+    "welle-cli -F generator,64 -t 1" << endl <<
+    "    Run test 1 on a synthetic ensemble with 64 services." << endl <<
+    endl <<
+    "welle-cli -f ./ofdm.iq -b -D -I snr=8,path=0:0,path=40:-3:20" << endl <<
+    "    Decode all programmes from IQ file './ofdm.iq' as fast as possible, after" << endl <<
+    "    adding a second path and noise to the signal." << endl <<
+    endl <<
+    "welle-cli -c 10B -p GRRIF -r capture -k 4" << endl <<
+    "    Receive 'GRRIF' on channel '10B' and keep the last 4 files of the IQ" << endl <<
+    "    samples on disk, until SIGUSR1 is received." << endl <<
+    endl <<
+    "welle-cli -c 10B -p GRRIF -S 1234" << endl <<
+    "    Receive 'GRRIF' on channel '10B' and serve the IQ samples on port 1234," << endl <<
+    "    e.g. to a second welle-cli started with -F rtl_tcp,localhost:1234." << endl <<
+    endl <<
+    "welle-cli -c 10B -w 8000 -m 239.255.0.1:5500,cs8" << endl <<
+    "    Enable the web server on channel 10B and publish the IQ samples to the" << endl <<
+    "    multicast group 239.255.0.1, where any number of hosts can receive them" << endl <<
+    "    with -F multicast,239.255.0.1:5500." << endl <<
+    endl <<
+    "welle-cli -L" << endl <<
+    "    List the ensembles that can be received with the 'auto' driver." << endl <<
+    endl <<
     "welle-cli -c 10B -D " << endl <<
     "    Dump FIC and all programmes of channel 10B to files." << endl <<
     endl <<
@@ -373,6 +472,10 @@ static void usage()
     "welle-cli -c 10B -Dw 8000" << endl <<
     "    Enable web server on port 8000, decode all programmes on channel 10B." << endl <<
     endl <<
+    "welle-cli -F soapysdr -W 12A,12B,12C,12D -R 8192000 -w 8000" << endl <<
+    "    Receive channels 12A to 12D with one device and serve them on ports" << endl <<
+    "    8000 to 8003." << endl <<
+    endl <<
     "welle-cli -c 10B -C 1 -w 8000" << endl <<
     "    Enable web server on port 8000, decode programmes one by one in a carousel" << endl <<
     "    on channel 10B; welle-cli will switch every 10 seconds." << endl <<
@@ -409,11 +512,14 @@ options_t parse_cmdline(int argc, char **argv)
     options.rro.decodeTII = true;
 
     int opt;
-    while ((opt = getopt(argc, argv, "A:c:C:dDf:F:g:hp:O:Ps:Tt:uvw:")) != -1) {
+    while ((opt = getopt(argc, argv, "A:bc:C:dDf:F:g:hI:j:k:Lm:p:O:PQr:R:s:S:Tt:uvw:W:")) != -1) {
         switch (opt) {
             case 'A':
                 options.antenna = optarg;
                 break;
+            case 'b':
+                options.offline = true;
+                break;
             case 'c':
                 options.channel = optarg;
                 break;
@@ -435,6 +541,37 @@ options_t parse_cmdline(int argc, char **argv)
             case 'g':
                 options.gain = std::atoi(optarg);
                 break;
+            case 'I':
+                try {
+                    options.impairments = ImpairmentSettings::parse(optarg);
+                    options.impaired = true;
+                }
+                catch (const invalid_argument& e) {
+                    cerr << e.what() << endl;
+                    exit(1);
+                }
+                break;
+            case 'j':
+                options.rro.decoderThreads = std::atoi(optarg);
+                break;
+            case 'k':
+                options.iqrecord_segments = std::atoi(optarg);
+                break;
+            case 'L':
+                options.scan = true;
+                break;
+            case 'm':
+                {
+                    const string arg = optarg;
+                    const size_t comma = arg.find(',');
+                    options.multicast_address = arg.substr(0, comma);
+                    if (comma != string::npos and not iqmulticast::parseFormat(
+                                arg.substr(comma + 1), options.multicast_format)) {
+                        cerr << "Unknown multicast format " << arg.substr(comma + 1) << endl;
+                        exit(1);
+                    }
+                }
+                break;
             case 'p':
                 options.programme = optarg;
                 break;
@@ -444,12 +581,24 @@ options_t parse_cmdline(int argc, char **argv)
             case 'P':
                 options.carousel_pad = true;
                 break;
+            case 'Q':
+                options.iq_correction = true;
+                break;
             case 'h':
                 usage();
                 exit(1);
+            case 'r':
+                options.iqrecord_prefix = optarg;
+                break;
+            case 'R':
+                options.wideband_rate = std::atoi(optarg);
+                break;
             case 's':
                 options.soapySDRDriverArgs = optarg;
                 break;
+            case 'S':
+                options.rtl_tcp_port = std::atoi(optarg);
+                break;
             case 't':
                 options.tests.push_back(std::atoi(optarg));
                 break;
@@ -467,6 +616,17 @@ options_t parse_cmdline(int argc, char **argv)
             case 'u':
                 options.rro.disableCoarseCorrector = true;
                 break;
+            case 'W':
+                {
+                    string channels = optarg;
+                    size_t start = 0;
+                    while (start <= channels.size()) {
+                        const size_t comma = min(channels.find(',', start), channels.size());
+                        options.wideband_channels.push_back(channels.substr(start, comma - start));
+                        start = comma + 1;
+                    }
+                }
+                break;
             default:
                 cerr << "Unknown option. Use -h for help" << endl;
                 exit(1);
@@ -486,10 +646,253 @@ options_t parse_cmdline(int argc, char **argv)
         cerr << "Cannot select both -C and -D" << endl;
         exit(1);
     }
+    if (not options.wideband_channels.empty() and (options.web_port == -1 or
+                options.wideband_rate % 8000 != 0 or options.wideband_rate < INPUT_RATE)) {
+        cerr << "-W requires -w and a rate given with -R" << endl;
+        exit(1);
+    }
+    if (not options.wideband_channels.empty() and options.impaired) {
+        cerr << "-I cannot be used with -W" << endl;
+        exit(1);
+    }
+    if (not options.wideband_channels.empty() and not options.multicast_address.empty()) {
+        cerr << "-m cannot be used with -W" << endl;
+        exit(1);
+    }
+    if (options.scan and (options.offline or options.web_port != -1 or
+                not options.tests.empty())) {
+        cerr << "-L cannot be used with -b, -w or -t" << endl;
+        exit(1);
+    }
+    if (options.offline and (options.iqsource.empty() or
+                options.web_port != -1 or not options.tests.empty())) {
+        cerr << "-b requires -f and cannot be used with -w or -t" << endl;
+        exit(1);
+    }
+
+    // Decoding as fast as possible must not lose frames, receiving in
+    // real time must not lose sync
+    if (options.tests.empty() and not options.offline) {
+        options.rro.frameDropPolicy = FrameDropPolicy::DropNewest;
+    }
 
     return options;
 }
 
+static IQRecorder *triggered_recorder = nullptr;
+
+// Hands the raw samples to the recorder and to the rtl_tcp server
+class IQRecordSinkPair : public IQRecordSink {
+    public:
+        IQRecordSinkPair(IQRecordSink& first, IQRecordSink& second) :
+            first(first), second(second) {}
+
+        virtual void push(const uint8_t *data, size_t length) override {
+            first.push(data, length);
+            second.push(data, length);
+        }
+
+    private:
+        IQRecordSink& first;
+        IQRecordSink& second;
+};
+
+#ifdef SIGUSR1
+static void trigger_recorder(int)
+{
+    if (triggered_recorder) {
+        triggered_recorder->trigger();
+    }
+}
+#endif
+
+// Decode an IQ file as fast as the machine allows. Every stage waits for
+// the next one instead of dropping data, so the output is the same as
+// with real-time playback.
+static int decode_offline(RadioInterface& ri, CRAWFile& in_file,
+        CVirtualInput& in, const options_t& options)
+{
+    using SId_t = uint32_t;
+    map<SId_t, WavProgrammeHandler> phs;
+
+    RadioReceiver rx(ri, in, options.rro);
+
+    const auto start = chrono::steady_clock::now();
+    rx.restart(false);
+
+    // Services are only known once the FIC has been decoded, so pick them
+    // up while the file is being processed.
+    while (not in_file.endWasReached()) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+
+        for (const auto& s : rx.getServiceList()) {
+            string label = s.serviceLabel.utf8_label();
+            if (phs.count(s.serviceId) or label.empty() or
+                    not rx.serviceHasAudioComponent(s)) {
+                continue;
+            }
+
+            if (not options.decode_all_programmes and
+                    label.find(options.programme) == string::npos) {
+                continue;
+            }
+
+            label.erase(std::find_if(label.rbegin(), label.rend(),
+                        [](int ch) { return !std::isspace(ch); }).base(), label.end());
+
+            string dumpFileName;
+            if (options.decode_all_programmes or options.dump_programme) {
+                dumpFileName = label + ".msc";
+            }
+
+            phs.emplace(std::make_pair(s.serviceId, WavProgrammeHandler(s.serviceId, label)));
+            if (rx.addServiceToDecode(phs.at(s.serviceId), dumpFileName, s)) {
+                cerr << "Decoding [0x" << std::hex << s.serviceId << std::dec << "] " <<
+                    label << endl;
+            }
+            else {
+                // Subchannel not known yet, try again later
+                phs.erase(s.serviceId);
+            }
+        }
+    }
+
+    // At the end of the file, the decoders are still busy with the last
+    // frames. Wait until the audio they carry has gone through, so that
+    // the tails of the outputs are written.
+    rx.waitForEndOfInput();
+
+    const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    const auto frames = rx.getReceiverStats().numFramesProcessed;
+    const double signal_duration = (double)frames * rx.getParams().T_F / INPUT_RATE;
+
+    cerr << "Decoded " << frames << " frames (" << signal_duration << " s of signal) in " <<
+        elapsed.count() << " s: " << frames / elapsed.count() << " frames/s, " <<
+        signal_duration / elapsed.count() << " times real time" << endl;
+
+    if (phs.empty()) {
+        cerr << "Could not find " <<
+            (options.decode_all_programmes ? string("any programme") : options.programme) <<
+            " in the file" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// Tune to every channel in turn and list its ensemble. The receiver
+// tells in about 200 ms if there is no signal on a channel.
+static int scan_channels(RadioInterface& ri, CVirtualInput& in,
+        const options_t& options)
+{
+    Channels channels;
+    RadioReceiver rx(ri, in, options.rro);
+    int numEnsembles = 0;
+
+    for (string channel = Channels::firstChannel; not channel.empty();
+            channel = channels.getNextChannel()) {
+        // The thread that decided the previous channel must be gone
+        // before the verdict on this one is reset
+        rx.stop();
+        in.setFrequency(channels.getFrequency(channel));
+        in.reset();
+
+        ri.signal_decided = false;
+        ri.signal_present = false;
+        rx.restart(true);
+
+        const auto start = chrono::steady_clock::now();
+        while (not ri.signal_decided and
+                chrono::steady_clock::now() - start < chrono::seconds(10)) {
+            this_thread::sleep_for(chrono::milliseconds(10));
+        }
+
+        if (not ri.signal_decided or not ri.signal_present) {
+            cerr << "Channel " << channel << ": no signal" << endl;
+            continue;
+        }
+
+        cerr << "Channel " << channel << ": signal, wait for service list" << endl;
+        while (rx.getServiceList().empty() and
+                chrono::steady_clock::now() - start < chrono::seconds(10)) {
+            this_thread::sleep_for(chrono::milliseconds(100));
+        }
+        if (rx.getServiceList().empty()) {
+            cerr << "Channel " << channel << ": no ensemble decoded" << endl;
+            continue;
+        }
+
+        // Wait an additional 3 seconds so that the receiver can complete the service list
+        this_thread::sleep_for(chrono::seconds(3));
+
+        numEnsembles++;
+        cout << "Channel " << channel << ": ensemble 0x" << hex <<
+            rx.getEnsembleId() << dec << " " <<
+            rx.getEnsembleLabel().utf8_label() << endl;
+        for (const auto& s : rx.getServiceList()) {
+            cout << "  [0x" << hex << s.serviceId << dec << "] " <<
+                s.serviceLabel.utf8_label() << endl;
+        }
+    }
+
+    rx.stop();
+    cerr << "Found " << numEnsembles << " ensembles" << endl;
+    return 0;
+}
+
+// Serve several ensembles received with one device, one web server each
+static int serve_channels(unique_ptr<CVirtualInput> in, const options_t& options,
+        const WebRadioInterface::DecodeSettings& ds)
+{
+    Channels channels;
+    vector<int> frequencies;
+    for (const auto& name : options.wideband_channels) {
+        const int frequency = channels.getFrequency(name);
+        if (frequency == 0) {
+            cerr << "Unknown channel " << name << endl;
+            return 1;
+        }
+        frequencies.push_back(frequency);
+    }
+
+    const auto range = minmax_element(frequencies.begin(), frequencies.end());
+    const int centre = (*range.first + *range.second) / 2;
+
+    if (not in->setDeviceParam(DeviceParam::SampleRate, (int)options.wideband_rate)) {
+        cerr << "The input driver cannot run at " << options.wideband_rate <<
+            " samples/s" << endl;
+        return 1;
+    }
+    in->setFrequency(centre);
+
+    CChannelizer channelizer(move(in), options.wideband_rate);
+
+    vector<unique_ptr<WebRadioInterface> > wris;
+    auto name = options.wideband_channels.begin();
+    for (size_t i = 0; i < frequencies.size(); i++, ++name) {
+        auto channel = channelizer.addChannel(frequencies[i]);
+        if (not channel) {
+            cerr << "Channel " << *name << " does not fit in " <<
+                options.wideband_rate << " samples/s" << endl;
+            return 1;
+        }
+
+        cerr << "Serving channel " << *name << " on port " <<
+            options.web_port + i << endl;
+        wris.emplace_back(new WebRadioInterface(*channel,
+                    options.web_port + i, ds, options.rro));
+    }
+
+    vector<thread> servers;
+    for (auto& wri : wris) {
+        servers.emplace_back(&WebRadioInterface::serve, wri.get());
+    }
+    for (auto& server : servers) {
+        server.join();
+    }
+    return 0;
+}
+
 int main(int argc, char **argv)
 {
     auto options = parse_cmdline(argc, argv);
@@ -499,9 +902,28 @@ int main(int argc, char **argv)
 
     Channels channels;
 
+    // Declared before the input so that they outlive the driver threads
+    unique_ptr<IQRecorder> recorder;
+    unique_ptr<RtlTcpServer> rtl_tcp_server;
+    unique_ptr<IQRecordSinkPair> record_sinks;
     unique_ptr<CVirtualInput> in = nullptr;
+    CRAWFile *in_file_ptr = nullptr;
 
-    if (options.iqsource.empty()) {
+    if (options.iqsource.empty() and options.frontend == "generator") {
+        // Tests run as fast as the receiver decodes
+        const bool throttle = options.tests.empty();
+        try {
+            const size_t numServices = options.frontend_args.empty() ?
+                1 : stoul(options.frontend_args);
+            in = make_unique<CDabGenerator>(
+                    DabGeneratorConfig::loadTest(numServices), throttle);
+        }
+        catch (const invalid_argument& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+    }
+    else if (options.iqsource.empty()) {
         in.reset(CInputFactory::GetDevice(ri, options.frontend));
 
         if (not in) {
@@ -510,9 +932,9 @@ int main(int argc, char **argv)
         }
     }
     else {
-        // Run the tests without input throttling for max speed
-        const bool throttle = options.tests.empty();
-        const bool rewind = options.tests.empty();
+        // Run the tests and offline decoding without input throttling for max speed
+        const bool throttle = options.tests.empty() and not options.offline;
+        const bool rewind = options.tests.empty() and not options.offline;
         auto in_file = make_unique<CRAWFile>(ri, throttle, rewind);
         if (not in_file) {
             cerr << "Could not prepare CRAWFile" << endl;
@@ -520,6 +942,7 @@ int main(int argc, char **argv)
         }
 
         in_file->setFileName(options.iqsource, "auto");
+        in_file_ptr = in_file.get();
         in = move(in_file);
     }
 
@@ -531,6 +954,11 @@ int main(int argc, char **argv)
         in->setGain(options.gain);
     }
 
+    if (options.iq_correction and
+            not in->setDeviceParam(DeviceParam::IQCorrection, 1)) {
+        cerr << "-Q is not supported with this input driver" << endl;
+        return 1;
+    }
 
 #ifdef HAVE_SOAPYSDR
     if (not options.antenna.empty() and in->getID() == CDeviceID::SOAPYSDR) {
@@ -560,12 +988,112 @@ int main(int argc, char **argv)
             // cout << "setting rtl_tcp host to '" << host << "', port to '" << atoi(port.c_str()) << "'" << endl;
         }
     }
+    if (options.frontend == "multicast" and in->getID() == CDeviceID::MULTICAST) {
+        string group, interfaceAddress;
+        int port = 0;
+        if (not iqmulticast::parseAddress(options.frontend_args, group, port, interfaceAddress)) {
+            cerr << "I need <group>:<port>[:<interface IP>] to receive multicast!" << endl;
+            return 1;
+        }
+        dynamic_cast<CMulticastInput*>(in.get())->setGroup(group, port, interfaceAddress);
+    }
     auto freq = channels.getFrequency(options.channel);
     in->setFrequency(freq);
+
+    if (not options.iqrecord_prefix.empty()) {
+        const auto id = in->getID();
+        if (id != CDeviceID::RTL_SDR and id != CDeviceID::RTL_TCP and
+                id != CDeviceID::RAWFILE) {
+            cerr << "-r is not supported with this input driver" << endl;
+            return 1;
+        }
+
+        recorder = make_unique<IQRecorder>(options.iqrecord_prefix,
+                in->getRecordFormat(), options.iqrecord_segments);
+        if (not recorder->start()) {
+            return 1;
+        }
+        in->setRecordSink(recorder.get());
+        triggered_recorder = recorder.get();
+#ifdef SIGUSR1
+        signal(SIGUSR1, trigger_recorder);
+#endif
+    }
+
+    if (options.rtl_tcp_port != -1) {
+        const auto id = in->getID();
+        if ((id != CDeviceID::RTL_SDR and id != CDeviceID::RTL_TCP and
+                id != CDeviceID::RAWFILE) or
+                not RtlTcpServer::supportsFormat(in->getRecordFormat())) {
+            cerr << "-S is not supported with this input driver" << endl;
+            return 1;
+        }
+
+        rtl_tcp_server = make_unique<RtlTcpServer>(in->getRecordFormat(),
+                in->getGainCount());
+        if (not rtl_tcp_server->start(options.rtl_tcp_port)) {
+            return 1;
+        }
+
+        if (recorder) {
+            record_sinks = make_unique<IQRecordSinkPair>(*recorder, *rtl_tcp_server);
+            in->setRecordSink(record_sinks.get());
+        }
+        else {
+            in->setRecordSink(rtl_tcp_server.get());
+        }
+    }
+
+    // The receiver reads the published and impaired signal, the device
+    // settings above and the recording still apply to the input itself.
+    // The impairments are not published.
+    unique_ptr<CMulticastPublisher> publisher;
+    unique_ptr<CImpairedInput> impaired;
+    CVirtualInput *rx_in = in.get();
+    if (not options.multicast_address.empty() and options.tests.empty()) {
+        string group, interfaceAddress;
+        int port = 0;
+        if (not iqmulticast::parseAddress(options.multicast_address, group, port, interfaceAddress)) {
+            cerr << "I need <group>:<port>[:<interface IP>] to publish multicast!" << endl;
+            return 1;
+        }
+
+        try {
+            publisher = make_unique<CMulticastPublisher>(*in, group, port,
+                    interfaceAddress, options.multicast_format);
+        }
+        catch (const runtime_error& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        rx_in = publisher.get();
+    }
+    if (options.impaired and options.tests.empty()) {
+        impaired = make_unique<CImpairedInput>(*rx_in, options.impairments);
+        rx_in = impaired.get();
+        cerr << "Input: " << rx_in->getDescription() << endl;
+    }
+
     string service_to_tune = options.programme;
 
-    if (not options.tests.empty()) {
-        Tests tests(in, options.rro);
+    if (options.offline) {
+        if (options.decode_all_programmes) {
+            ri.fic_fd = fopen("dump.fic", "w");
+        }
+
+        const int ret = decode_offline(ri, *in_file_ptr, *rx_in, options);
+
+        if (ri.fic_fd) {
+            fclose(ri.fic_fd);
+            ri.fic_fd = nullptr;
+        }
+        return ret;
+    }
+    else if (options.scan) {
+        return scan_channels(ri, *rx_in, options);
+    }
+    else if (not options.tests.empty()) {
+        Tests tests(in, options.rro, options.impairments);
         for (int test : options.tests) {
             tests.run_test(test);
         }
@@ -605,11 +1133,15 @@ int main(int argc, char **argv)
             return 1;
         }
 
-        WebRadioInterface wri(*in, options.web_port, ds, options.rro);
+        if (not options.wideband_channels.empty()) {
+            return serve_channels(move(in), options, ds);
+        }
+
+        WebRadioInterface wri(*rx_in, options.web_port, ds, options.rro);
         wri.serve();
     }
     else {
-        RadioReceiver rx(ri, *in, options.rro);
+        RadioReceiver rx(ri, *rx_in, options.rro);
         if (options.decode_all_programmes) {
             FILE* fic_fd = fopen("dump.fic", "w");
 
@@ -728,6 +1260,10 @@ int main(int argc, char **argv)
         }
     }
 
+    const auto stats = in->getInputStats();
+    cerr << "Input: " << stats.samples << " samples, " << stats.dropped <<
+        " dropped in " << stats.dropEvents << " events" << endl;
+
     if (ri.fic_fd) {
         FILE* fd = ri.fic_fd;
         ri.fic_fd = nullptr;
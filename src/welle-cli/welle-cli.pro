@@ -6,12 +6,16 @@ CONFIG += console
 
 HEADERS += \
     alsa-output.h  \
+    iq_recorder.h \
+    rtl_tcp_server.h \
     webprogrammehandler.h \
     webradiointerface.h \
     jsonconvert.h
 
 SOURCES += \
     alsa-output.cpp \
+    iq_recorder.cpp \
+    rtl_tcp_server.cpp \
     tests.cpp \
     webprogrammehandler.cpp \
     webradiointerface.cpp \
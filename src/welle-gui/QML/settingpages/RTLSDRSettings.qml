@@ -38,6 +38,7 @@ SettingSection {
 
     Settings {
         property alias rtlSdrEnableBiasTeeState: enableBiasTee.checked
+        property alias rtlSdrEnableIQCorrectionState: enableIQCorrection.checked
     }
 
     WSwitch {
@@ -49,10 +50,20 @@ SettingSection {
         }
     }
 
+    WSwitch {
+        id: enableIQCorrection
+        Layout.fillWidth: true
+        text: qsTr("Correct DC offset and IQ imbalance")
+        onClicked: {
+            guiHelper.setIQCorrection(checked)
+        }
+    }
+
     function initDevice(isAutoDevice) {
         if(!isAutoDevice)
             guiHelper.openRtlSdr()
 
         guiHelper.setBiasTeeRtlSdr(enableBiasTee.checked)
+        guiHelper.setIQCorrection(enableIQCorrection.checked)
     }
 }
@@ -49,6 +49,7 @@ SettingSection {
 
         property alias ipPort: hostPort.text
         property alias rtlTcpHostName: hostName.text
+        property alias rtlTcpEnableIQCorrectionState: enableIQCorrection.checked
     }
 
     RowLayout {
@@ -78,6 +79,15 @@ SettingSection {
         }
     }
 
+    WSwitch {
+        id: enableIQCorrection
+        Layout.fillWidth: true
+        text: qsTr("Correct DC offset and IQ imbalance")
+        onClicked: {
+            guiHelper.setIQCorrection(checked)
+        }
+    }
+
     onVisibleChanged: {
         if(!visible && isLoaded)
             __openDevice()
@@ -110,6 +120,7 @@ SettingSection {
         }
 
         guiHelper.openRtlTcp(hostName.text, hostPort.text, true)
+        guiHelper.setIQCorrection(enableIQCorrection.checked)
     }
 }
 
@@ -197,9 +197,14 @@ qint64 CAudioIODevice::readData(char* data, qint64 len)
     if(len == 0)
         return 0;
 
+    // We have int16 samples, copy them straight out of the ring buffer
+    const auto regions = buffer.acquireRead(len / 2);
     qint64 total = 0;
-
-    total = buffer.getDataFromBuffer(data, len / 2); // we have int16 samples
+    for (const auto& span : {regions.first, regions.second}) {
+        memcpy(data + total * 2, span.data, span.size * 2);
+        total += span.size;
+    }
+    buffer.release(regions.size());
 
     // If the buffer is empty return zeros.
     if (total == 0) {
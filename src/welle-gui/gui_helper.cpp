@@ -582,6 +582,11 @@ void CGUIHelper::setBiasTeeRtlSdr(bool isOn)
     radioController->setDeviceParam("biastee", isOn ? 1 : 0);
 }
 
+void CGUIHelper::setIQCorrection(bool isOn)
+{
+    radioController->setDeviceParam("iqcorrection", isOn ? 1 : 0);
+}
+
 void CGUIHelper::openSoapySdr()
 {
     radioController->openDevice(CDeviceID::SOAPYSDR);
@@ -96,6 +96,7 @@ public:
     Q_INVOKABLE void setBiasTeeAirspy(bool isOn);
     Q_INVOKABLE void openRtlSdr();
     Q_INVOKABLE void setBiasTeeRtlSdr(bool isOn);
+    Q_INVOKABLE void setIQCorrection(bool isOn);
     Q_INVOKABLE void openSoapySdr();
     Q_INVOKABLE void setAntennaSoapySdr(QString text);
     Q_INVOKABLE void setDriverArgsSoapySdr(QString text);
@@ -84,6 +84,9 @@ CRadioController::CRadioController(QVariantMap& commandLineOptions, QObject *par
     // Init the technical data
     resetTechnicalData();
 
+    // Rather lose a frame than the sync if the decoder falls behind
+    rro.frameDropPolicy = FrameDropPolicy::DropNewest;
+
     // Init timers
     connect(&labelTimer, &QTimer::timeout, this, &CRadioController::labelTimerTimeout);
     connect(&stationTimer, &QTimer::timeout, this, &CRadioController::stationTimerTimeout);
@@ -180,15 +183,23 @@ CDeviceID CRadioController::openDevice()
 
 void CRadioController::setDeviceParam(QString param, int value)
 {
+    DeviceParam dp;
+
     if (param == "biastee") {
-        deviceParametersInt[DeviceParam::BiasTee] = value;
+        dp = DeviceParam::BiasTee;
+    }
+    else if (param == "iqcorrection") {
+        dp = DeviceParam::IQCorrection;
     }
     else {
         qDebug() << "Invalid device parameter setting: " << param;
+        return;
     }
 
+    deviceParametersInt[dp] = value;
+
     if (device) {
-        device->setDeviceParam(DeviceParam::BiasTee, value);
+        device->setDeviceParam(dp, value);
     }
 }
 